@@ -1,6 +1,58 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MyCPlusPlusProject.h"
+#include "SGameplaySettings.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/UObjectGlobals.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, MyCPlusPlusProject, "MyCPlusPlusProject" );
+IMPLEMENT_PRIMARY_GAME_MODULE( FMyCPlusPlusProjectModule, MyCPlusPlusProject, "MyCPlusPlusProject" );
+
+double FMyCPlusPlusProjectModule::LoadedSeconds = 0.0;
+double FMyCPlusPlusProjectModule::EngineInitSeconds = 0.0;
+double FMyCPlusPlusProjectModule::FirstMapSeconds = 0.0;
+
+void FMyCPlusPlusProjectModule::StartupModule()
+{
+	LoadedSeconds = FPlatformTime::Seconds() - GStartTime;
+
+	PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FMyCPlusPlusProjectModule::OnPostEngineInit);
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddRaw(this, &FMyCPlusPlusProjectModule::OnPostLoadMap);
+}
+
+void FMyCPlusPlusProjectModule::ShutdownModule()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	if (UObjectInitialized())
+	{
+		GetMutableDefault<USGameplaySettings>()->StopWatching();
+	}
+}
+
+void FMyCPlusPlusProjectModule::OnPostEngineInit()
+{
+	EngineInitSeconds = FPlatformTime::Seconds() - GStartTime;
+	UE_LOG(LogTemp, Display, TEXT("Startup (%s): module loaded at %.2f s, engine initialized at %.2f s"),
+		GIsEditor ? TEXT("editor") : TEXT("game"), LoadedSeconds, EngineInitSeconds);
+
+	// Gameplay tuning follows Config/DefaultGame.ini while running
+	GetMutableDefault<USGameplaySettings>()->StartWatching();
+}
+
+void FMyCPlusPlusProjectModule::OnPostLoadMap(UWorld* World)
+{
+	if (FirstMapSeconds > 0.0)
+	{
+		return;
+	}
+
+	FirstMapSeconds = FPlatformTime::Seconds() - GStartTime;
+	UE_LOG(LogTemp, Display, TEXT("Startup (%s): first map loaded at %.2f s"), GIsEditor ? TEXT("editor") : TEXT("game"), FirstMapSeconds);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("SStartupExit")))
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
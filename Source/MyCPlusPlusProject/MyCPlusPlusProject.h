@@ -3,4 +3,28 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
 
+/*
+ * Records when the module loaded, when the engine finished initializing and when the first map was loaded, in
+ * seconds since the process started, and logs them. That is the game boot time with -game and the editor boot time
+ * in the editor; USStartupProfileCommandlet reports both. -SStartupExit quits once the first map is loaded.
+ */
+class FMyCPlusPlusProjectModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+	// 0 until it happened
+	static double LoadedSeconds;
+	static double EngineInitSeconds;
+	static double FirstMapSeconds;
+
+private:
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle PostLoadMapHandle;
+
+	void OnPostEngineInit();
+	void OnPostLoadMap(UWorld* World);
+};
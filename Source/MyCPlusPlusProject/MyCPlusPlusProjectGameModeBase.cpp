@@ -3,3 +3,56 @@
 
 #include "MyCPlusPlusProjectGameModeBase.h"
 
+#include "SGameplayRandomSubsystem.h"
+#include "Kismet/GameplayStatics.h"
+
+void AMyCPlusPlusProjectGameModeBase::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	GameplaySeed = FixedSeed != 0 ? FixedSeed : (int32)FPlatformTime::Cycles();
+	FParse::Value(FCommandLine::Get(), TEXT("GameplaySeed="), GameplaySeed);
+	GameplaySeed = UGameplayStatics::GetIntOption(Options, TEXT("Seed"), GameplaySeed);
+
+	if (USGameplayRandomSubsystem* Random = GetWorld()->GetSubsystem<USGameplayRandomSubsystem>())
+	{
+		Random->SetSeed(GameplaySeed);
+	}
+	UE_LOG(LogTemp, Log, TEXT("Gameplay seed %d"), GameplaySeed);
+
+	ApplyGarbageCollectionSettings();
+}
+
+void AMyCPlusPlusProjectGameModeBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (const TPair<IConsoleVariable*, FString>& Setting : OverriddenGCSettings)
+	{
+		Setting.Key->Set(*Setting.Value, ECVF_SetByCode);
+	}
+	OverriddenGCSettings.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AMyCPlusPlusProjectGameModeBase::ApplyGarbageCollectionSettings()
+{
+	if (TimeBetweenGarbageCollections > 0.0f)
+	{
+		SetGCSetting(TEXT("gc.TimeBetweenPurgingPendingKillObjects"), FString::SanitizeFloat(TimeBetweenGarbageCollections));
+	}
+	SetGCSetting(TEXT("gc.IncrementalBeginDestroyEnabled"), bIncrementalBeginDestroy ? TEXT("1") : TEXT("0"));
+	SetGCSetting(TEXT("gc.MultithreadedDestructionEnabled"), bMultithreadedDestruction ? TEXT("1") : TEXT("0"));
+}
+
+void AMyCPlusPlusProjectGameModeBase::SetGCSetting(const TCHAR* Name, const FString& Value)
+{
+	IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+	if (!Variable)
+	{
+		return;
+	}
+
+	OverriddenGCSettings.Emplace(Variable, Variable->GetString());
+	Variable->Set(*Value, ECVF_SetByCode);
+	UE_LOG(LogTemp, Log, TEXT("%s = %s for this map"), Name, *Value);
+}
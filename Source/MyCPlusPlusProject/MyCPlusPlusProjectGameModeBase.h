@@ -7,11 +7,48 @@
 #include "MyCPlusPlusProjectGameModeBase.generated.h"
 
 /**
- * 
+ * Seeds the world's gameplay randomness (USGameplayRandomSubsystem). The seed is picked in this order:
+ * the ?Seed= URL option, -GameplaySeed= on the command line, FixedSeed if set, otherwise a new one every session.
+ *
+ * Also tunes garbage collection for the maps it runs: a map with long fights can collect more often so each pass has
+ * less to purge, a small map can collect rarely. The project settings come back when the game mode ends play.
  */
 UCLASS()
 class MYCPLUSPLUSPROJECT_API AMyCPlusPlusProjectGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+public:
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	int32 GetGameplaySeed() const { return GameplaySeed; }
+
+protected:
+	// Zero picks a new seed every session
+	UPROPERTY(EditDefaultsOnly, Category = "Random")
+	int32 FixedSeed = 0;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "Random")
+	int32 GameplaySeed = 0;
+
+	// Seconds between collections (gc.TimeBetweenPurgingPendingKillObjects), zero or less keeps the project setting
+	UPROPERTY(EditDefaultsOnly, Category = "Garbage Collection")
+	float TimeBetweenGarbageCollections = 0.0f;
+
+	// Spreads BeginDestroy of unreachable objects over frames instead of running it all in the collecting frame
+	UPROPERTY(EditDefaultsOnly, Category = "Garbage Collection")
+	bool bIncrementalBeginDestroy = true;
+
+	// Runs destructors of purged objects on worker threads
+	UPROPERTY(EditDefaultsOnly, Category = "Garbage Collection")
+	bool bMultithreadedDestruction = true;
+
+	// Console variables changed by ApplyGarbageCollectionSettings and their previous values
+	TArray<TPair<IConsoleVariable*, FString>> OverriddenGCSettings;
+
+	void ApplyGarbageCollectionSettings();
+
+	void SetGCSetting(const TCHAR* Name, const FString& Value);
 };
@@ -7,8 +7,12 @@
 #include "PhysicsEngine/RadialForceComponent.h"
 #include "GameFramework/Actor.h"
 #include "DrawDebugHelpers.h"
-#include "Engine/StaticMeshActor.h"
-#include "Kismet/GameplayStatics.h"
+#include "SGameplayEventSubsystem.h"
+#include "SGameplayRandomSubsystem.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SGameplaySettings.h"
+#include "SGravityWellSubsystem.h"
+#include "SPropInstanceManager.h"
 
 
 // Sets default values
@@ -19,9 +23,11 @@ ABlackholeProjectile::ABlackholeProjectile()
 
 	// Match with VFX
 	InitialLifeSpan = 4.8f;
-	MinRadius = 5000.0f;
-	MaxRadius = 10000.0f;  // Initially you have 2000.0f, so this maintains compatibility
-	AnimationSpeed = 2.0f;
+	const FSGameplayConstants& Defaults = USGameplaySettings::GetStartupConstants();
+	MinRadius = Defaults.BlackholeMinRadius;
+	MaxRadius = Defaults.BlackholeMaxRadius;
+	AnimationSpeed = Defaults.BlackholePulseSpeed;
+	ForceStrength = Defaults.BlackholeForceStrength;
 	
 	// Create and setup the sphere collision component
 	SphereComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
@@ -55,50 +61,52 @@ ABlackholeProjectile::ABlackholeProjectile()
 	// Configure the projectile to never stop on impact
 	MovementComp->bShouldBounce = true; // Enable bouncing
 	MovementComp->Bounciness = 1.0f; // Full bounce (no velocity loss)
-	MovementComp->bSweepCollision = false;
+	// Bounces come from sweep hits, and fixed substeps keep the bounce path the same at any frame rate
+	MovementComp->bSweepCollision = true;
+	MovementComp->bForceSubStepping = true;
+	MovementComp->MaxSimulationTimeStep = 1.0f / 60.0f;
+	MovementComp->MaxSimulationIterations = 8;
 
 	RadialForceComp = CreateDefaultSubobject<URadialForceComponent>(TEXT("RadialForceComp"));
 	RadialForceComp->SetupAttachment(SphereComp);
 	RadialForceComp->bImpulseVelChange = true;
 	RadialForceComp->bAutoActivate = true;
-	RadialForceComp->ForceStrength = -500000.0f; // Negative for pull effect
+	RadialForceComp->ForceStrength = ForceStrength; // Negative for pull effect
 	RadialForceComp->RemoveObjectTypeToAffect(UEngineTypes::ConvertToObjectType(ECC_Pawn));
 	RadialForceComp->bIgnoreOwningActor = true;
 }
 
+float ABlackholeProjectile::GetMinRadius() const
+{
+	return USGameplaySettings::Resolve(bOverride_MinRadius, MinRadius, &FSGameplayConstants::BlackholeMinRadius);
+}
+
+float ABlackholeProjectile::GetMaxRadius() const
+{
+	return USGameplaySettings::Resolve(bOverride_MaxRadius, MaxRadius, &FSGameplayConstants::BlackholeMaxRadius);
+}
+
+float ABlackholeProjectile::GetForceStrength() const
+{
+	return USGameplaySettings::Resolve(bOverride_ForceStrength, ForceStrength, &FSGameplayConstants::BlackholeForceStrength);
+}
+
 // Called when the game starts or when spawned
 void ABlackholeProjectile::BeginPlay()
 {
 	Super::BeginPlay();
-	RadialForceComp->Activate();
-
-	// Add to your BeginPlay() or in a developer console command
-	// Shows collision of all objects
-	GetWorld()->DebugDrawTraceTag = TEXT("CollisionDebug");
+	RadialForceComp->SetActive(!USGravityWellSubsystem::IsEnabled());
 
 	// Initialize animation with a value between min and max radius
-	RadialForceComp->Radius = (MinRadius + MaxRadius) * 0.5f;
+	RadialForceComp->ForceStrength = GetForceStrength();
+	RadialForceComp->Radius = (GetMinRadius() + GetMaxRadius()) * 0.5f;
     
-	// Start with a random animation time to make multiple blackholes look different
-	AnimationTime = FMath::RandRange(0.0f, PI);
+	// Start with a random animation time to make multiple blackholes look different.
+	// Drawn from the world's seeded gameplay stream so benchmark runs and input replays pulse the same way.
+	AnimationTime = GetWorld()->GetSubsystem<USGameplayRandomSubsystem>()->GetStream(TEXT("Blackhole")).FRandRange(0.0f, PI);
 
-	// Find all static mesh actors in the scene
-	TArray<AActor*> StaticMeshActors;
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AStaticMeshActor::StaticClass(), StaticMeshActors);
-    
-	// Update their collision settings to generate overlaps with the blackhole
-	for (AActor* Actor : StaticMeshActors)
-	{
-		UE_LOG(LogTemp, Log, TEXT("Found static mesh actor: %s"), *Actor->GetName());
-		UStaticMeshComponent* MeshComp = Cast<UStaticMeshComponent>(
-			Actor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
-            
-		if (MeshComp && MeshComp->GetCollisionProfileName() == FName("PhysicsActor"))
-		{
-			// Make these objects generate overlaps as well
-			MeshComp->SetGenerateOverlapEvents(true);
-		}
-	}
+	// Physics props generating overlaps with the blackhole is set up by USGameplayRegistrySubsystem when their
+	// level loads, instead of going through every static mesh actor of the map for each blackhole
 }
 
 // Called every frame
@@ -107,17 +115,48 @@ void ABlackholeProjectile::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 	
 	// Animation to grow and shrink the influence of radial force over time
-	AnimationTime += DeltaTime * AnimationSpeed;
+	AnimationTime += DeltaTime * USGameplaySettings::Resolve(bOverride_AnimationSpeed, AnimationSpeed, &FSGameplayConstants::BlackholePulseSpeed);
     
 	// Calculate the current radius using a sine wave to create a smooth pulsating effect
 	// Sin returns values between -1 and 1, so we adjust it to get values between 0 and 1
 	float PulseFactor = (FMath::Sin(AnimationTime) + 1.0f) * 0.5f;
     
 	// Interpolate between min and max radius
-	float CurrentRadius = FMath::Lerp(MinRadius, MaxRadius, PulseFactor);
+	float CurrentRadius = FMath::Lerp(GetMinRadius(), GetMaxRadius(), PulseFactor);
     
-	// Apply the new radius to the radial force component
+	// Apply the new radius to the radial force component, or hand it to the physics thread as a gravity well
 	RadialForceComp->Radius = CurrentRadius;
+	RadialForceComp->ForceStrength = GetForceStrength();
+
+	USGravityWellSubsystem* GravityWells = GetWorld()->GetSubsystem<USGravityWellSubsystem>();
+	const bool bAsyncWell = GravityWells && USGravityWellSubsystem::IsEnabled();
+	RadialForceComp->SetActive(!bAsyncWell);
+	if (bAsyncWell)
+	{
+		FSGravityWell Well;
+		Well.Center = GetActorLocation();
+		Well.Radius = CurrentRadius;
+		Well.Strength = RadialForceComp->ForceStrength;
+		GravityWells->SetWell(this, Well);
+	}
+	else if (GravityWells)
+	{
+		GravityWells->RemoveWell(this);
+	}
+
+	// Wake up instanced barrels close to the blackhole so the pull has physics bodies to move, in the loaded cells
+	// only. Not the whole pulse radius: that would turn every dormant barrel around into an actor every frame
+	PromotionTimeRemaining -= DeltaTime;
+	const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>();
+	if (Registry && PromotionTimeRemaining <= 0.0f)
+	{
+		PromotionTimeRemaining = PromotionInterval;
+		const float Radius = FMath::Min(PromotionRadius, CurrentRadius);
+		Registry->ForEach<ASPropInstanceManager>(ESRegistryKind::PropManager, [this, Radius](ASPropInstanceManager* PropManager)
+		{
+			PropManager->PromoteBarrelsInRadius(GetActorLocation(), Radius);
+		});
+	}
 		
 	// Visualize the force radius with a debug sphere
 	// DrawDebugSphere(
@@ -133,6 +172,16 @@ void ABlackholeProjectile::Tick(float DeltaTime)
 	// );
 }
 
+void ABlackholeProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USGravityWellSubsystem* GravityWells = GetWorld()->GetSubsystem<USGravityWellSubsystem>())
+	{
+		GravityWells->RemoveWell(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ABlackholeProjectile::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
@@ -153,9 +202,23 @@ void ABlackholeProjectile::OnOverlappedPhysicsActor(UPrimitiveComponent* Overlap
 			FString::Printf(TEXT("Blackhole hit: %s"), *GetNameSafe(OtherActor)));
 	}
 
-	if (OtherComp->IsSimulatingPhysics())
+	// Every machine simulates its own blackhole, only the server's copy removes things from the world
+	if (OtherComp->IsSimulatingPhysics() && GetNetMode() != NM_Client)
 	{
-		OtherActor->Destroy();
+		// Destroyed by the event bus after the overlap callback, not while physics is still dispatching
+		if (USGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<USGameplayEventSubsystem>())
+		{
+			FSGameplayEvent Event;
+			Event.Type = ESGameplayEventType::Absorbed;
+			Event.Source = this;
+			Event.Target = OtherActor;
+			Event.Location = GetActorLocation();
+			Events->Post(Event);
+		}
+		else
+		{
+			OtherActor->Destroy();
+		}
 	}
 }
 
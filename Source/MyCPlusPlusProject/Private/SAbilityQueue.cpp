@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SAbilityQueue.h"
+
+void FSAbilityQueue::SetSpec(ESAbility Ability, float CastTime, float Cooldown)
+{
+	FSpec& Spec = Specs[(int32)Ability];
+	Spec.CastTime = FMath::Max(CastTime, 0.0f);
+	Spec.Cooldown = FMath::Max(Cooldown, 0.0f);
+}
+
+bool FSAbilityQueue::Push(ESAbility Ability)
+{
+	if (NumPending == Capacity)
+	{
+		return false;
+	}
+
+	const int32 Slot = (Head + NumPending) % Capacity;
+	Pending[Slot] = Ability;
+	PendingTime[Slot] = Clock;
+	NumPending++;
+	return true;
+}
+
+void FSAbilityQueue::Pop()
+{
+	Head = (Head + 1) % Capacity;
+	NumPending--;
+}
+
+void FSAbilityQueue::AdvanceCooldowns(float Seconds)
+{
+	for (float& Cooldown : CooldownRemaining)
+	{
+		Cooldown = FMath::Max(Cooldown - Seconds, 0.0f);
+	}
+	Clock += Seconds;
+}
+
+void FSAbilityQueue::Advance(float DeltaTime, TFunctionRef<void(ESAbility)> OnCastStart, TFunctionRef<void(ESAbility)> OnCastRelease)
+{
+	float Remaining = DeltaTime;
+
+	// Several casts can complete in one long frame, each at the exact time it would have happened
+	while (true)
+	{
+		if (IsCasting())
+		{
+			if (CastRemaining > Remaining)
+			{
+				CastRemaining -= Remaining;
+				AdvanceCooldowns(Remaining);
+				return;
+			}
+
+			Remaining -= CastRemaining;
+			AdvanceCooldowns(CastRemaining);
+			CastRemaining = 0.0f;
+
+			const ESAbility Released = Casting;
+			Casting = ESAbility::Count;
+			OnCastRelease(Released);
+		}
+
+		// Drop presses that waited too long, a late shot feels worse than a missed one
+		while (NumPending > 0 && Clock - PendingTime[Head] > BufferWindow)
+		{
+			Pop();
+		}
+
+		if (NumPending == 0)
+		{
+			AdvanceCooldowns(Remaining);
+			return;
+		}
+
+		const ESAbility Next = Pending[Head];
+		const float Wait = CooldownRemaining[(int32)Next];
+		if (Wait > Remaining)
+		{
+			AdvanceCooldowns(Remaining);
+			return;
+		}
+
+		Remaining -= Wait;
+		AdvanceCooldowns(Wait);
+		Pop();
+
+		const FSpec& Spec = Specs[(int32)Next];
+		Casting = Next;
+		CastRemaining = Spec.CastTime;
+		CooldownRemaining[(int32)Next] = Spec.Cooldown;
+		OnCastStart(Next);
+	}
+}
+
+bool FSAbilityQueue::ReleaseCast(TFunctionRef<void(ESAbility)> OnCastRelease)
+{
+	if (!IsCasting())
+	{
+		return false;
+	}
+
+	const ESAbility Released = Casting;
+	Casting = ESAbility::Count;
+	CastRemaining = 0.0f;
+	OnCastRelease(Released);
+	return true;
+}
+
+void FSAbilityQueue::Reset()
+{
+	Head = 0;
+	NumPending = 0;
+	Casting = ESAbility::Count;
+	CastRemaining = 0.0f;
+	for (float& Cooldown : CooldownRemaining)
+	{
+		Cooldown = 0.0f;
+	}
+}
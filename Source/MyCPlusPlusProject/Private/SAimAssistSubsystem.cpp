@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SAimAssistSubsystem.h"
+
+#include "SAttributeComponent.h"
+#include "SFrameCost.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarAimAssist(
+	TEXT("s.AimAssist"),
+	1,
+	TEXT("Aim at the best target in a cone around the crosshair instead of straight through it."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistConeAngle(
+	TEXT("s.AimAssist.ConeAngle"),
+	6.0f,
+	TEXT("Half angle of the aim assist cone, in degrees."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistMaxDistance(
+	TEXT("s.AimAssist.MaxDistance"),
+	5000.0f,
+	TEXT("Targets farther than this are not assisted."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistDistanceWeight(
+	TEXT("s.AimAssist.DistanceWeight"),
+	0.25f,
+	TEXT("How much distance counts against angle when ranking targets, 0 ranks by angle only, 1 by distance only."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAimAssistMaxTraces(
+	TEXT("s.AimAssist.MaxTraces"),
+	2,
+	TEXT("Line of sight traces per query, to the best ranked targets. Cached results don't count."),
+	ECVF_Default);
+
+// Few enough per leaf that testing them beats descending further
+static constexpr int32 AimBVHLeafSize = 4;
+
+// Refit boxes may grow to this multiple of their built area before the tree is rebuilt
+static constexpr float AimBVHRebuildGrowth = 2.0f;
+
+void FSAimBVH::Build(TConstArrayView<FSphere> Spheres)
+{
+	Nodes.Reset();
+	Items.Reset();
+	if (Spheres.Num() == 0)
+	{
+		return;
+	}
+
+	Items.SetNumUninitialized(Spheres.Num());
+	for (int32 i = 0; i < Items.Num(); i++)
+	{
+		Items[i] = i;
+	}
+
+	Nodes.Reserve(Spheres.Num() * 2);
+	Nodes.AddDefaulted();
+	BuildNode(0, 0, Spheres.Num(), Spheres);
+}
+
+void FSAimBVH::BuildNode(int32 NodeIndex, int32 First, int32 Count, TConstArrayView<FSphere> Spheres)
+{
+	FBox Bounds(ForceInit);
+	FBox Centers(ForceInit);
+	for (int32 i = First; i < First + Count; i++)
+	{
+		const FSphere& Sphere = Spheres[Items[i]];
+		Bounds += FBox(Sphere.Center - FVector(Sphere.W), Sphere.Center + FVector(Sphere.W));
+		Centers += Sphere.Center;
+	}
+	Nodes[NodeIndex].Bounds = Bounds;
+
+	if (Count <= AimBVHLeafSize)
+	{
+		Nodes[NodeIndex].First = First;
+		Nodes[NodeIndex].Count = Count;
+		return;
+	}
+
+	// Median split along the axis the centers spread the most
+	const FVector Size = Centers.GetSize();
+	const int32 Axis = Size.X >= Size.Y && Size.X >= Size.Z ? 0 : (Size.Y >= Size.Z ? 1 : 2);
+	TArrayView<int32>(Items).Slice(First, Count).Sort([&Spheres, Axis](int32 A, int32 B)
+	{
+		return Spheres[A].Center[Axis] < Spheres[B].Center[Axis];
+	});
+
+	const int32 Left = Nodes.Num();
+	Nodes.AddDefaulted(2);
+	Nodes[NodeIndex].First = Left;
+	Nodes[NodeIndex].Count = 0;
+
+	const int32 Half = Count / 2;
+	BuildNode(Left, First, Half, Spheres);
+	BuildNode(Left + 1, First + Half, Count - Half, Spheres);
+}
+
+void FSAimBVH::Refit(TConstArrayView<FSphere> Spheres)
+{
+	for (int32 NodeIndex = Nodes.Num() - 1; NodeIndex >= 0; NodeIndex--)
+	{
+		FNode& Node = Nodes[NodeIndex];
+		if (Node.Count > 0)
+		{
+			Node.Bounds.Init();
+			for (int32 i = Node.First; i < Node.First + Node.Count; i++)
+			{
+				const FSphere& Sphere = Spheres[Items[i]];
+				Node.Bounds += FBox(Sphere.Center - FVector(Sphere.W), Sphere.Center + FVector(Sphere.W));
+			}
+		}
+		else
+		{
+			Node.Bounds = Nodes[Node.First].Bounds + Nodes[Node.First + 1].Bounds;
+		}
+	}
+}
+
+float FSAimBVH::GetLeafArea() const
+{
+	float Area = 0.0f;
+	for (const FNode& Node : Nodes)
+	{
+		if (Node.Count > 0)
+		{
+			const FVector Size = Node.Bounds.GetSize();
+			Area += 2.0f * (Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X);
+		}
+	}
+	return Area;
+}
+
+bool FSAimBVH::SphereInCone(const FVector& Center, float Radius, const FVector& Origin, const FVector& Direction,
+	float HalfAngle, float MaxDistance)
+{
+	const FVector ToCenter = Center - Origin;
+	const float Distance = ToCenter.Size();
+	if (Distance <= Radius)
+	{
+		return true;
+	}
+	if (Distance - Radius > MaxDistance)
+	{
+		return false;
+	}
+
+	// In the cone when the sphere's angular extent reaches inside the cone's half angle
+	const float Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(ToCenter, Direction) / Distance, -1.0f, 1.0f));
+	const float SphereAngle = FMath::Asin(FMath::Min(Radius / Distance, 1.0f));
+	return Angle - SphereAngle <= HalfAngle;
+}
+
+bool USAimAssistSubsystem::IsEnabled()
+{
+	return CVarAimAssist.GetValueOnGameThread() != 0;
+}
+
+void USAimAssistSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("AimAssist");
+
+	ViewCaches.Reset();
+	LineOfSight.Reset();
+
+	if (IsEnabled())
+	{
+		UpdateCandidates();
+	}
+}
+
+TStatId USAimAssistSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USAimAssistSubsystem, STATGROUP_Tickables);
+}
+
+void USAimAssistSubsystem::UpdateCandidates()
+{
+	const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>();
+	if (!Registry)
+	{
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AActor>> Current;
+	Current.Reserve(Candidates.Num());
+	Registry->ForEach<AActor>(ESRegistryKind::Pawn, [&Current](AActor* Actor)
+	{
+		if (Actor->GetRootComponent())
+		{
+			Current.Add(Actor);
+		}
+	});
+
+	const bool bChanged = Current != Candidates;
+	if (bChanged)
+	{
+		Candidates = MoveTemp(Current);
+	}
+
+	Spheres.SetNumUninitialized(Candidates.Num());
+	for (int32 i = 0; i < Candidates.Num(); i++)
+	{
+		const FBoxSphereBounds& Bounds = Candidates[i]->GetRootComponent()->Bounds;
+		Spheres[i] = FSphere(Bounds.Origin, Bounds.SphereRadius);
+	}
+
+	// Moving candidates only stretch the boxes, the tree is rebuilt when that costs the queries too much
+	if (!bChanged)
+	{
+		BVH.Refit(Spheres);
+	}
+	if (bChanged || BVH.GetLeafArea() > BuiltLeafArea * AimBVHRebuildGrowth)
+	{
+		BVH.Build(Spheres);
+		BuiltLeafArea = BVH.GetLeafArea();
+	}
+}
+
+void USAimAssistSubsystem::GatherSorted(const FSAimQuery& Query, TArray<FScoredCandidate>& OutSorted) const
+{
+	const float HalfAngle = FMath::DegreesToRadians(CVarAimAssistConeAngle.GetValueOnGameThread());
+	const float MaxDistance = CVarAimAssistMaxDistance.GetValueOnGameThread();
+	const float DistanceWeight = FMath::Clamp(CVarAimAssistDistanceWeight.GetValueOnGameThread(), 0.0f, 1.0f);
+
+	OutSorted.Reset();
+
+	// A zero cone or range assists nothing, and the scores below divide by both
+	if (HalfAngle <= 0.0f || MaxDistance <= 0.0f)
+	{
+		return;
+	}
+
+	BVH.QueryCone(Query.Origin, Query.Direction, HalfAngle, MaxDistance, [&](int32 Index)
+	{
+		const AActor* Actor = Candidates[Index].Get();
+		const FSphere& Sphere = Spheres[Index];
+		if (!Actor || Actor == Query.Viewer || !FSAimBVH::SphereInCone(Sphere.Center, Sphere.W, Query.Origin, Query.Direction, HalfAngle, MaxDistance))
+		{
+			return;
+		}
+
+		const USAttributeComponent* Attributes = Actor->FindComponentByClass<USAttributeComponent>();
+		if (Attributes && !Attributes->IsAlive())
+		{
+			return;
+		}
+
+		const FVector ToCenter = Sphere.Center - Query.Origin;
+		const float Distance = ToCenter.Size();
+		const float Angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(ToCenter, Query.Direction) / FMath::Max(Distance, 1.0f), -1.0f, 1.0f));
+
+		const float Score = FMath::Min(Angle / HalfAngle, 1.0f) * (1.0f - DistanceWeight) + Distance / MaxDistance * DistanceWeight;
+		OutSorted.Add({ Index, Score });
+	});
+
+	OutSorted.Sort([](const FScoredCandidate& A, const FScoredCandidate& B) { return A.Score < B.Score; });
+}
+
+bool USAimAssistSubsystem::HasLineOfSight(const FSAimQuery& Query, int32 Index)
+{
+	const TPair<const AActor*, int32> Key(Query.Viewer, Index);
+	if (const bool* Cached = LineOfSight.Find(Key))
+	{
+		return *Cached;
+	}
+
+	const AActor* Target = Candidates[Index].Get();
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SAimAssist), false, Query.Viewer);
+	FHitResult Hit;
+	const bool bBlocked = GetWorld()->LineTraceSingleByChannel(Hit, Query.Origin, Spheres[Index].Center, ECC_Visibility, QueryParams);
+	const bool bVisible = !bBlocked || Hit.GetActor() == Target;
+
+	LineOfSight.Add(Key, bVisible);
+	return bVisible;
+}
+
+bool USAimAssistSubsystem::FindTarget(const FSAimQuery& Query, FSAimTarget& OutTarget)
+{
+	if (!IsEnabled() || Candidates.Num() == 0)
+	{
+		return false;
+	}
+
+	// Same viewer looking the same way this frame, the sorted candidates still hold
+	FViewCache& View = ViewCaches.FindOrAdd(Query.Viewer);
+	if (View.Sorted.Num() == 0 || !View.Origin.Equals(Query.Origin, 1.0f) || FVector::DotProduct(View.Direction, Query.Direction) < 0.99999f)
+	{
+		View.Origin = Query.Origin;
+		View.Direction = Query.Direction;
+		GatherSorted(Query, View.Sorted);
+	}
+
+	int32 TracesLeft = CVarAimAssistMaxTraces.GetValueOnGameThread();
+	for (const FScoredCandidate& Candidate : View.Sorted)
+	{
+		const bool bCached = LineOfSight.Contains(TPair<const AActor*, int32>(Query.Viewer, Candidate.Index));
+		if (!bCached && TracesLeft-- <= 0)
+		{
+			break;
+		}
+
+		if (HasLineOfSight(Query, Candidate.Index))
+		{
+			OutTarget.Actor = Candidates[Candidate.Index].Get();
+			OutTarget.AimPoint = Spheres[Candidate.Index].Center;
+			return true;
+		}
+	}
+	return false;
+}
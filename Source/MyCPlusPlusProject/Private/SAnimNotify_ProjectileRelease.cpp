@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SAnimNotify_ProjectileRelease.h"
+
+#include "SCharacter.h"
+
+void USAnimNotify_ProjectileRelease::Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference)
+{
+	Super::Notify(MeshComp, Animation, EventReference);
+
+	// Also fires in the animation editor preview, where the owner is not a character
+	if (ASCharacter* Character = MeshComp ? Cast<ASCharacter>(MeshComp->GetOwner()) : nullptr)
+	{
+		Character->OnProjectileReleaseNotify();
+	}
+}
+
+FString USAnimNotify_ProjectileRelease::GetNotifyName_Implementation() const
+{
+	return TEXT("Projectile Release");
+}
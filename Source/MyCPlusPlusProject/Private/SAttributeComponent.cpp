@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SAttributeComponent.h"
+
+#include "SDamageSubsystem.h"
+#include "Net/UnrealNetwork.h"
+
+USAttributeComponent::USAttributeComponent()
+{
+	// Nothing to tick, damage is resolved by USDamageSubsystem
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void USAttributeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Health = MaxHealth;
+
+	if (USDamageSubsystem* Damage = GetWorld()->GetSubsystem<USDamageSubsystem>())
+	{
+		Damage->RegisterTarget(this);
+	}
+}
+
+void USAttributeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USDamageSubsystem* Damage = GetWorld()->GetSubsystem<USDamageSubsystem>())
+	{
+		Damage->UnregisterTarget(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool USAttributeComponent::ApplyHealthChange(AActor* InstigatorActor, float Delta)
+{
+	const float OldHealth = Health;
+	Health = FMath::Clamp(Health + Delta, 0.0f, MaxHealth);
+	if (Health == OldHealth)
+	{
+		return false;
+	}
+
+	OnHealthChanged.Broadcast(InstigatorActor, this, Health, Health - OldHealth);
+	return true;
+}
+
+float USAttributeComponent::GetResistance(ESDamageType Type) const
+{
+	const float* Resistance = Resistances.Find(Type);
+	return Resistance ? FMath::Clamp(*Resistance, 0.0f, 1.0f) : 0.0f;
+}
+
+void USAttributeComponent::OnRep_Health(float OldHealth)
+{
+	// The instigator isn't replicated, clients only need the new value for UI and effects
+	OnHealthChanged.Broadcast(nullptr, this, Health, Health - OldHealth);
+}
+
+void USAttributeComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(USAttributeComponent, Health);
+}
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SBotController.h"
+
+#include "SCharacter.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+ASBotController::ASBotController()
+{
+	PrimaryActorTick.bCanEverTick = true;
+}
+
+void ASBotController::SetRandomSeed(int32 Seed)
+{
+	Random.Initialize(Seed);
+	ActionTimeRemaining = Random.FRandRange(ActionInterval.X, ActionInterval.Y);
+}
+
+void ASBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ASCharacter* Bot = Cast<ASCharacter>(GetPawn());
+	if (!Bot)
+	{
+		return;
+	}
+
+	MoveTimeRemaining -= DeltaTime;
+	if (MoveTimeRemaining <= 0.0f)
+	{
+		PickMoveDirection();
+	}
+	Bot->AddMovementInput(MoveDirection, 1.0f);
+
+	ActionTimeRemaining -= DeltaTime;
+	if (ActionTimeRemaining <= 0.0f)
+	{
+		PickTarget(Bot);
+		PerformRandomAction(Bot);
+		ActionTimeRemaining = Random.FRandRange(ActionInterval.X, ActionInterval.Y);
+	}
+}
+
+void ASBotController::PickMoveDirection()
+{
+	MoveDirection = FRotator(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f).Vector();
+	MoveTimeRemaining = MoveChangeInterval * Random.FRandRange(0.5f, 1.5f);
+}
+
+void ASBotController::PickTarget(const ASCharacter* Bot)
+{
+	FCollisionObjectQueryParams ObjectQueryParams;
+	ObjectQueryParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ObjectQueryParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SBotTarget), false, Bot);
+
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Bot->GetActorLocation(), FQuat::Identity, ObjectQueryParams,
+		FCollisionShape::MakeSphere(TargetSearchRadius), QueryParams);
+
+	if (Overlaps.Num() == 0)
+	{
+		// Nothing around, shoot somewhere ahead
+		SetFocalPoint(Bot->GetActorLocation() + MoveDirection * 1000.0f);
+		return;
+	}
+
+	const FOverlapResult& Overlap = Overlaps[Random.RandHelper(Overlaps.Num())];
+
+	// Dormant barrels and chests are instances of the prop manager, aim at the instance rather than the manager
+	const UInstancedStaticMeshComponent* Instances = Cast<UInstancedStaticMeshComponent>(Overlap.GetComponent());
+	FTransform InstanceTransform;
+	if (Instances && Instances->GetInstanceTransform(Overlap.ItemIndex, InstanceTransform, true))
+	{
+		SetFocalPoint(InstanceTransform.GetLocation());
+	}
+	else if (Overlap.GetComponent())
+	{
+		SetFocalPoint(Overlap.GetComponent()->Bounds.Origin);
+	}
+}
+
+void ASBotController::PerformRandomAction(ASCharacter* Bot)
+{
+	const float TotalWeight = ActionWeights.X + ActionWeights.Y + ActionWeights.Z + ActionWeights.W;
+	float Pick = Random.FRandRange(0.0f, TotalWeight);
+
+	if ((Pick -= ActionWeights.X) < 0.0f)
+	{
+		Bot->PrimaryAttack();
+	}
+	else if ((Pick -= ActionWeights.Y) < 0.0f)
+	{
+		Bot->SpecialAttack();
+	}
+	else if ((Pick -= ActionWeights.Z) < 0.0f)
+	{
+		Bot->Dash();
+	}
+	else
+	{
+		Bot->PrimaryInteract();
+	}
+}
@@ -4,12 +4,32 @@
 #include "SCharacter.h"
 
 #include "SInteractionComponent.h"
+#include "SAimAssistSubsystem.h"
+#include "SAttributeComponent.h"
+#include "SAnimNotify_ProjectileRelease.h"
+#include "AIController.h"
+#include "SCharacterMovementComponent.h"
+#include "Animation/AnimMontage.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "SExplosiveBarrel.h"
+#include "SGameplayEventSubsystem.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SGameplaySettings.h"
+#include "SMagicProjectile.h"
+#include "SMemoryBudget.h"
+#include "SProjectileSubsystem.h"
+#include "SQueryBatchSubsystem.h"
+#include "Engine/LocalPlayer.h"
+#include "SceneView.h"
 
 // Sets default values
-ASCharacter::ASCharacter()
+ASCharacter::ASCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -18,7 +38,14 @@ ASCharacter::ASCharacter()
 	SpringArmComp->SocketOffset = FVector(0.0f, 0.0f, 30.0f); // Raise camera position
 	
 	InteractionComp = CreateDefaultSubobject<USInteractionComponent>(TEXT("InteractionComp"));
-	AttackAnim = CreateDefaultSubobject<UAnimMontage>(TEXT("UAnimMontage"));
+
+	AttributeComp = CreateDefaultSubobject<USAttributeComponent>(TEXT("AttributeComp"));
+
+	const FSGameplayConstants& Defaults = USGameplaySettings::GetStartupConstants();
+	PrimaryAttackCastTime = Defaults.PrimaryAttackCastTime;
+	PrimaryAttackCooldown = Defaults.PrimaryAttackCooldown;
+	SpecialAttackCastTime = Defaults.SpecialAttackCastTime;
+	SpecialAttackCooldown = Defaults.SpecialAttackCooldown;
  	
 	/* Camera control setup:
 	* bUsePawnControlRotation = true: Allows the spring arm (camera boom) to rotate with mouse/controller input
@@ -41,13 +68,86 @@ ASCharacter::ASCharacter()
 	* This allows the character to turn to face the direction it is moving in instead of the direction it is facing
 	*/
 	GetCharacterMovement()->bOrientRotationToMovement = true; // Rotate character to movement direction
+
+	/* Animation cost:
+	* Update rate optimization (URO) evaluates far away characters every few frames and interpolates in between.
+	* Characters nobody sees only advance their montages, which keeps projectile release notifies firing
+	* (also on dedicated servers) without evaluating any pose.
+	*/
+	GetMesh()->bEnableUpdateRateOptimizations = true;
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+	GetMesh()->OnAnimUpdateRateParamsCreated.BindUObject(this, &ASCharacter::OnAnimUpdateRateParamsCreated);
+}
+
+void ASCharacter::OnAnimUpdateRateParamsCreated(FAnimUpdateRateParameters* Params)
+{
+	// Frames skipped per mesh LOD, the Paragon meshes have four LODs. LOD0 always updates.
+	Params->bShouldUseLodMap = true;
+	Params->LODToFrameSkipMap.Add(1, 1);
+	Params->LODToFrameSkipMap.Add(2, 2);
+	Params->LODToFrameSkipMap.Add(3, 4);
+	Params->BaseNonRenderedUpdateRate = 8;
+}
+
+void ASCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	AttributeComp->OnHealthChanged.AddDynamic(this, &ASCharacter::OnHealthChanged);
+}
+
+void ASCharacter::OnHealthChanged(AActor* InstigatorActor, USAttributeComponent* OwningComp, float NewHealth, float Delta)
+{
+	// Fired once per frame with everything the character took, not once per hit
+	UE_LOG(LogTemp, Log, TEXT("%s health %.1f (%+.1f) from %s"), *GetName(), NewHealth, Delta, *GetNameSafe(InstigatorActor));
+
+	if (NewHealth <= 0.0f && Delta < 0.0f)
+	{
+		if (APlayerController* PC = Cast<APlayerController>(GetController()))
+		{
+			DisableInput(PC);
+		}
+		AbilityQueue.Reset();
+	}
 }
 
 // Called when the game starts or when spawned
 void ASCharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	ApplyAbilitySpecs();
+	ConstantsChangedHandle = USGameplaySettings::OnConstantsChanged.AddUObject(this, &ASCharacter::ApplyAbilitySpecs);
+
+	GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>()->Register(this, ESRegistryKind::Pawn);
+}
+
+void ASCharacter::ApplyAbilitySpecs()
+{
+	// With a release notify the cast lasts until the notify, the montage length is only a fallback in case the
+	// montage gets interrupted before reaching it
+	const bool bNotifyRelease = HasProjectileReleaseNotify();
+	const float MontageLength = bNotifyRelease ? AttackAnim->GetPlayLength() : 0.0f;
+	const float PrimaryCastTime = USGameplaySettings::Resolve(bOverride_PrimaryAttackCastTime, PrimaryAttackCastTime,
+		&FSGameplayConstants::PrimaryAttackCastTime);
+	const float SpecialCastTime = USGameplaySettings::Resolve(bOverride_SpecialAttackCastTime, SpecialAttackCastTime,
+		&FSGameplayConstants::SpecialAttackCastTime);
+	AbilityQueue.SetSpec(ESAbility::PrimaryAttack, bNotifyRelease ? MontageLength : PrimaryCastTime,
+		USGameplaySettings::Resolve(bOverride_PrimaryAttackCooldown, PrimaryAttackCooldown, &FSGameplayConstants::PrimaryAttackCooldown));
+	AbilityQueue.SetSpec(ESAbility::SpecialAttack, bNotifyRelease ? MontageLength : SpecialCastTime,
+		USGameplaySettings::Resolve(bOverride_SpecialAttackCooldown, SpecialAttackCooldown, &FSGameplayConstants::SpecialAttackCooldown));
+}
+
+void ASCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	USGameplaySettings::OnConstantsChanged.Remove(ConstantsChangedHandle);
+
+	if (USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>())
+	{
+		Registry->Unregister(this, ESRegistryKind::Pawn);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void ASCharacter::MoveForward(float Value)
@@ -79,67 +179,134 @@ void ASCharacter::MoveRigth(float X)
 	AddMovementInput(RightVector, X);
 }
 
-void ASCharacter::PrimaryAttack_TimeElapsed()
+bool ASCharacter::GetAimRay(FVector& OutOrigin, FVector& OutDirection) const
 {
 	// Get the player's controller, which handles input and viewport information
 	// Cast is needed to convert from base Controller to PlayerController type
-	auto* PC = Cast<APlayerController>(GetController());
-	if (!PC) return;
+	if (const APlayerController* PC = Cast<APlayerController>(GetController()))
+	{
+		// Split screen gives every local player its own part of the viewport, the crosshair is at the center of that
+		// part. Deprojecting uses the same projection data, so it maps back to this player's view.
+		const ULocalPlayer* LocalPlayer = PC->GetLocalPlayer();
+		FSceneViewProjectionData ProjectionData;
+		if (LocalPlayer && LocalPlayer->ViewportClient &&
+			LocalPlayer->GetProjectionData(LocalPlayer->ViewportClient->Viewport, ProjectionData))
+		{
+			const FIntRect ViewRect = ProjectionData.GetConstrainedViewRect();
+			const FVector2D Center(ViewRect.Min.X + ViewRect.Width() * 0.5f, ViewRect.Min.Y + ViewRect.Height() * 0.5f);
+			if (PC->DeprojectScreenPositionToWorld(Center.X, Center.Y, OutOrigin, OutDirection))
+			{
+				return true;
+			}
+		}
+	}
 
-	// Get the viewport (screen) dimensions to find the center point
-	int32 VX, VY;
-	PC->GetViewportSize(VX, VY);
+	if (GetController())
+	{
+		// Any other controller, or a player without a viewport, aims along its view from the pawn's eyes
+		FRotator ViewRot;
+		GetController()->GetPlayerViewPoint(OutOrigin, ViewRot);
+		OutDirection = ViewRot.Vector();
+		return true;
+	}
+	return false;
+}
+
+void ASCharacter::RequestAimPoint(TFunction<void(const FVector&)> OnAimPoint)
+{
+	// AI controllers look at something specific, aim straight at it
+	if (const AAIController* AI = Cast<AAIController>(GetController()))
+	{
+		const FVector FocalPoint = AI->GetFocalPoint();
+		if (FAISystem::IsValidLocation(FocalPoint))
+		{
+			OnAimPoint(FocalPoint);
+			return;
+		}
+	}
 
-	// Convert the 2D screen center point into a 3D world location and direction
-	// CamWorldLoc = Camera position in world space
-	// CamWorldDir = Direction camera is looking in world space 
 	FVector CamWorldLoc, CamWorldDir;
-	PC->DeprojectScreenPositionToWorld(VX * 0.5f, VY * 0.5f, CamWorldLoc, CamWorldDir);
+	if (!GetAimRay(CamWorldLoc, CamWorldDir))
+	{
+		return;
+	}
 
-	// Create a line trace (raycast) from camera position to find what player is aiming at
-	// TraceEnd is 10000 units in camera's forward direction
-	FVector TraceEnd	= CamWorldLoc + CamWorldDir * 10000.0f;
-	FHitResult Hit; // Stores information about what the trace hits
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this); // Don't detect collisions with self
+	// Aim assist picks the best target in a cone around the crosshair, from its cached candidates
+	if (USAimAssistSubsystem* AimAssist = GetWorld()->GetSubsystem<USAimAssistSubsystem>())
+	{
+		FSAimQuery Query;
+		Query.Origin = CamWorldLoc;
+		Query.Direction = CamWorldDir;
+		Query.Viewer = this;
+
+		FSAimTarget Target;
+		if (AimAssist->FindTarget(Query, Target))
+		{
+			OnAimPoint(Target.AimPoint);
+			return;
+		}
+	}
+
+	// Nothing assisted, trace straight through the crosshair
+	// TraceEnd is AimTraceLength units in camera's forward direction
+	const FVector TraceEnd = CamWorldLoc + CamWorldDir * USGameplaySettings::GetConstants().AimTraceLength;
 
-	// Default aim point is far along camera direction
-	// If trace hits something, use that hit location instead
-	FVector AimPoint = TraceEnd;
-	if (GetWorld()->LineTraceSingleByChannel(Hit, CamWorldLoc, TraceEnd, ECC_Visibility, QueryParams))
+	// A player's own shot can't wait for the batch, it would leave a frame after the click
+	USQueryBatchSubsystem* QueryBatch = GetWorld()->GetSubsystem<USQueryBatchSubsystem>();
+	if (!QueryBatch || (IsLocallyControlled() && IsPlayerControlled()))
 	{
-		AimPoint = Hit.Location;
+		FHitResult Hit; // Stores information about what the trace hits
+		FCollisionQueryParams QueryParams;
+		QueryParams.AddIgnoredActor(this); // Don't detect collisions with self
+
+		// Default aim point is far along camera direction
+		// If trace hits something, use that hit location instead
+		const bool bHit = GetWorld()->LineTraceSingleByChannel(Hit, CamWorldLoc, TraceEnd, ECC_Visibility, QueryParams);
+		OnAimPoint(bHit ? Hit.Location : TraceEnd);
+		return;
 	}
 
+	// Bots are batched with each other, the answer comes next frame
+	FSBatchedQuery Query;
+	Query.Start = CamWorldLoc;
+	Query.End = TraceEnd;
+	Query.Channel = ECC_Visibility;
+	Query.Ignore = this; // Don't detect collisions with self
+
+	TWeakObjectPtr<ASCharacter> WeakThis(this);
+	QueryBatch->Request(Query, [WeakThis, TraceEnd, OnAimPoint = MoveTemp(OnAimPoint)](TConstArrayView<FHitResult> Hits)
+	{
+		// Default aim point is far along camera direction
+		// If trace hits something, use that hit location instead
+		if (WeakThis.IsValid())
+		{
+			OnAimPoint(Hits.Num() > 0 ? Hits[0].Location : TraceEnd);
+		}
+	});
+}
+
+void ASCharacter::GetFireOriginAndDirection(const FVector& AimPoint, FVector& OutOrigin, FVector& OutDirection) const
+{
 	// Get the location where projectile should spawn (character's muzzle socket)
 	// Calculate direction from muzzle to aim point for projectile trajectory
-	FVector MuzzleLoc = GetMesh()->GetSocketLocation("Muzzle_01"); // muzzle is where the hand is
-	FVector FireDir   = (AimPoint - MuzzleLoc).GetSafeNormal(); // Normalized direction vector
-	FRotator FireRot  = FireDir.Rotation(); // Convert direction to rotation angles “which way something is pointing"
+	OutOrigin = GetMesh()->GetSocketLocation("Muzzle_01"); // muzzle is where the hand is
+	OutDirection = (AimPoint - OutOrigin).GetSafeNormal(); // Normalized direction vector
+}
 
-	// Setup spawn parameters for creating the projectile
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnParams.Instigator = this; // Set this character as the projectile's owner 
+void ASCharacter::FireProjectileAt(ESProjectileSlot Slot, const FVector& AimPoint)
+{
+	FVector MuzzleLoc, FireDir;
+	GetFireOriginAndDirection(AimPoint, MuzzleLoc, FireDir);
 
-	// Spawn the projectile actor at muzzle location, pointing toward aim point
-	GetWorld()->SpawnActor<AActor>(
-		ProjectileClass,
-		MuzzleLoc,
-		FireRot,
-		SpawnParams
-	);
+	// Spawn the projectile at muzzle location, pointing toward aim point (replicated as a single spawn event)
+	FireProjectile(Slot, MuzzleLoc, FireDir);
+
+	if (Slot != ESProjectileSlot::Primary)
+	{
+		return;
+	}
 
 	// Debug visualization helpers
-	// Green line would show camera to aim point
-	// DrawDebugLine(
-	//	 GetWorld(),
-	//	 CamWorldLoc,
-	//	 AimPoint,
-	//	 FColor::Green,
-	//	 false, 2.0f, 0, 1.0f
-	// );
-	
 	// Red line shows firing direction from muzzle
 	DrawDebugLine(
 		GetWorld(),
@@ -159,131 +326,275 @@ void ASCharacter::PrimaryAttack_TimeElapsed()
 	);
 }
 
-void ASCharacter::PrimaryAttack()
+void ASCharacter::PrimaryAttack_TimeElapsed()
 {
-	PlayAnimMontage(AttackAnim);
-	GetWorldTimerManager().SetTimer(TimerHandle_PrimaryAttack, this, &ASCharacter::PrimaryAttack_TimeElapsed, 0.2f);
+	// Players aim through the screen center, bots through their focus
+	RequestAimPoint([this](const FVector& AimPoint) { FireProjectileAt(ESProjectileSlot::Primary, AimPoint); });
 }
 
-void ASCharacter::SpecialAttack()
+TSubclassOf<AActor> ASCharacter::GetProjectileClass(ESProjectileSlot Slot) const
 {
-	PlayAnimMontage(AttackAnim);
-	GetWorldTimerManager().SetTimer(TimerHandle_PrimaryAttack, this, &ASCharacter::SpecialAttack_TimeElapsed, 0.2f);
+	switch (Slot)
+	{
+	case ESProjectileSlot::Primary: return ProjectileClass;
+	case ESProjectileSlot::Special: return SpecialAttackClass;
+	case ESProjectileSlot::Dash: return DashClass;
+	default: return nullptr;
+	}
 }
 
-void ASCharacter::SpecialAttack_TimeElapsed()
+void ASCharacter::FireProjectile(ESProjectileSlot Slot, const FVector& MuzzleLoc, const FVector& FireDir)
 {
-	// check if class was set
-	if (!SpecialAttackClass) return;
-	
-	// Get the player's controller, which handles input and viewport information
-	// Cast is needed to convert from base Controller to PlayerController type
-	auto* PC = Cast<APlayerController>(GetController());
-	if (!PC) return;
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
 
-	// Get the viewport (screen) dimensions to find the center point
-	int32 VX, VY;
-	PC->GetViewportSize(VX, VY);
+	FSProjectileSpawnEvent Event;
+	Event.Origin = MuzzleLoc;
+	Event.Direction = FireDir;
+	Event.Slot = Slot;
+	Event.ServerTime = GameState ? GameState->GetServerWorldTimeSeconds() : GetWorld()->GetTimeSeconds();
 
-	// Convert the 2D screen center point into a 3D world location and direction
-	// CamWorldLoc = Camera position in world space
-	// CamWorldDir = Direction camera is looking in world space 
-	FVector CamWorldLoc, CamWorldDir;
-	PC->DeprojectScreenPositionToWorld(VX * 0.5f, VY * 0.5f, CamWorldLoc, CamWorldDir);
-
-	// Create a line trace (raycast) from camera position to find what player is aiming at
-	// TraceEnd is 10000 units in camera's forward direction
-	FVector TraceEnd	= CamWorldLoc + CamWorldDir * 10000.0f;
-	FHitResult Hit; // Stores information about what the trace hits
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this); // Don't detect collisions with self
+	// The shooter always sees the projectile right away, on a client this copy is only a prediction
+	SpawnProjectileLocal(Event, 0.0f);
 
-	// Default aim point is far along camera direction
-	// If trace hits something, use that hit location instead
-	FVector AimPoint = TraceEnd;
-	if (GetWorld()->LineTraceSingleByChannel(Hit, CamWorldLoc, TraceEnd, ECC_Visibility, QueryParams))
+	if (HasAuthority())
 	{
-		AimPoint = Hit.Location;
+		MulticastProjectileSpawned(Event);
 	}
+	else if (Slot == ESProjectileSlot::Dash && Cast<USCharacterMovementComponent>(GetCharacterMovement()))
+	{
+		ServerFireCosmeticProjectile(Event);
+	}
+	else
+	{
+		ServerFireProjectile(Event);
+	}
+}
 
-	// Get the location where projectile should spawn (character's muzzle socket)
-	// Calculate direction from muzzle to aim point for projectile trajectory
-	FVector MuzzleLoc = GetMesh()->GetSocketLocation("Muzzle_01"); // muzzle is where the hand is
-	FVector FireDir   = (AimPoint - MuzzleLoc).GetSafeNormal(); // Normalized direction vector
-	FRotator FireRot  = FireDir.Rotation(); // Convert direction to rotation angles “which way something is pointing"
+AActor* ASCharacter::SpawnProjectileLocal(const FSProjectileSpawnEvent& Event, float CatchUpSeconds)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Projectiles);
+	const TSubclassOf<AActor> Class = GetProjectileClass(Event.Slot);
+	if (!Class)
+	{
+		return nullptr;
+	}
 
 	// Setup spawn parameters for creating the projectile
 	FActorSpawnParameters SpawnParams;
 	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 	SpawnParams.Instigator = this; // Set this character as the projectile's owner 
 
-	// Spawn the projectile actor at muzzle location, pointing toward aim point
-	GetWorld()->SpawnActor<AActor>(
-		SpecialAttackClass,
-		MuzzleLoc,
-		FireRot,
-		SpawnParams
-	);
+	// Projectiles don't replicate, every machine spawns and simulates its own copy. Magic projectiles come out of
+	// the pool and go back into it when they hit or expire.
+	AActor* Projectile = nullptr;
+	USProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<USProjectileSubsystem>();
+	if (Projectiles && Class->IsChildOf<ASMagicProjectile>())
+	{
+		Projectile = Projectiles->Launch(*Class, Event.Origin, FVector(Event.Direction).Rotation(), this);
+	}
+	else
+	{
+		Projectile = GetWorld()->SpawnActor<AActor>(Class, Event.Origin, FVector(Event.Direction).Rotation(), SpawnParams);
+	}
+
+	// Remote clients hear about the shot late, move the projectile to where the server's copy is by now
+	if (Projectile && CatchUpSeconds > 0.0f)
+	{
+		if (const UProjectileMovementComponent* Movement = Projectile->FindComponentByClass<UProjectileMovementComponent>())
+		{
+			Projectile->SetActorLocation(Event.Origin + FVector(Event.Direction) * Movement->InitialSpeed * CatchUpSeconds, true);
+		}
+	}
+	return Projectile;
 }
 
-void ASCharacter::Dash()
+float ASCharacter::GetMinFireInterval(ESProjectileSlot Slot) const
 {
-	if (!DashClass) return;
+	switch (Slot)
+	{
+	case ESProjectileSlot::Primary: return AbilityQueue.GetSpec(ESAbility::PrimaryAttack).Cooldown;
+	case ESProjectileSlot::Special: return AbilityQueue.GetSpec(ESAbility::SpecialAttack).Cooldown;
+	case ESProjectileSlot::Dash:
+		if (const USCharacterMovementComponent* Movement = Cast<USCharacterMovementComponent>(GetCharacterMovement()))
+		{
+			return Movement->DetonateDelay + Movement->TeleportDelay;
+		}
+		return 0.0f;
+	default: return 0.0f;
+	}
+}
 
-	// Get the player's controller, which handles input and viewport information
-	// Cast is needed to convert from base Controller to PlayerController type
-	auto* PC = Cast<APlayerController>(GetController());
-	if (!PC) return;
+bool ASCharacter::AcceptServerFire(const FSProjectileSpawnEvent& Event)
+{
+	// Clients pick the origin, only accept it if it is actually near us
+	if (FVector::DistSquared(Event.Origin, GetActorLocation()) > FMath::Square(MaxProjectileOriginDistance))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Rejected projectile from %s, origin too far from the character"), *GetNameSafe(this));
+		return false;
+	}
 
-	// Get the viewport (screen) dimensions to find the center point
-	int32 VX, VY;
-	PC->GetViewportSize(VX, VY);
+	// Presses are buffered on the client, the server only sees the shots. Each accepted shot pushes the next allowed
+	// time out by the full interval, so jitter can bunch two shots but never raise the sustained rate
+	const int32 SlotIndex = static_cast<int32>(Event.Slot);
+	if (SlotIndex >= UE_ARRAY_COUNT(ServerNextFireTime))
+	{
+		return false;
+	}
 
-	// Convert the 2D screen center point into a 3D world location and direction
-	// CamWorldLoc = Camera position in world space
-	// CamWorldDir = Direction camera is looking in world space 
-	FVector CamWorldLoc, CamWorldDir;
-	PC->DeprojectScreenPositionToWorld(VX * 0.5f, VY * 0.5f, CamWorldLoc, CamWorldDir);
+	const float Now = GetWorld()->GetTimeSeconds();
+	float& NextFireTime = ServerNextFireTime[SlotIndex];
+	if (Now < NextFireTime - MaxFireJitter)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Rejected projectile from %s, fired %.2f s too early"), *GetNameSafe(this), NextFireTime - Now);
+		return false;
+	}
 
-	// Create a line trace (raycast) from camera position to find what player is aiming at
-	// TraceEnd is 10000 units in camera's forward direction
-	FVector TraceEnd	= CamWorldLoc + CamWorldDir * 10000.0f;
-	FHitResult Hit; // Stores information about what the trace hits
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this); // Don't detect collisions with self
+	NextFireTime = FMath::Max(Now, NextFireTime) + GetMinFireInterval(Event.Slot);
+	return true;
+}
 
-	// Default aim point is far along camera direction
-	// If trace hits something, use that hit location instead
-	FVector AimPoint = TraceEnd;
-	if (GetWorld()->LineTraceSingleByChannel(Hit, CamWorldLoc, TraceEnd, ECC_Visibility, QueryParams))
+void ASCharacter::ServerFireProjectile_Implementation(const FSProjectileSpawnEvent& Event)
+{
+	if (AcceptServerFire(Event))
 	{
-		AimPoint = Hit.Location;
+		SpawnProjectileLocal(Event, 0.0f);
+		MulticastProjectileSpawned(Event);
 	}
+}
 
-	// Get the location where projectile should spawn (character's muzzle socket)
-	// Calculate direction from muzzle to aim point for projectile trajectory
-	FVector MuzzleLoc = GetMesh()->GetSocketLocation("Muzzle_01"); // muzzle is where the hand is
-	FVector FireDir   = (AimPoint - MuzzleLoc).GetSafeNormal(); // Normalized direction vector
-	FRotator FireRot  = FireDir.Rotation(); // Convert direction to rotation angles “which way something is pointing"
+void ASCharacter::ServerFireCosmeticProjectile_Implementation(const FSProjectileSpawnEvent& Event)
+{
+	ServerFireProjectile_Implementation(Event);
+}
 
-	// Setup spawn parameters for creating the projectile
-	FActorSpawnParameters SpawnParams;
-	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnParams.Instigator = this; // Set this character as the projectile's owner 
+void ASCharacter::MulticastProjectileSpawned_Implementation(const FSProjectileSpawnEvent& Event)
+{
+	// The server spawned the real one and the shooter already has its prediction
+	if (HasAuthority() || IsLocallyControlled())
+	{
+		return;
+	}
 
-	// Spawn the projectile actor at muzzle location, pointing toward aim point
-	GetWorld()->SpawnActor<AActor>(
-		DashClass,
-		MuzzleLoc,
-		FireRot,
-		SpawnParams
-	);
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const float Delay = GameState ? GameState->GetServerWorldTimeSeconds() - Event.ServerTime : 0.0f;
+	SpawnProjectileLocal(Event, FMath::Clamp(Delay, 0.0f, 0.5f));
+}
+
+void ASCharacter::ClientReceiveWorldEvents_Implementation(const TArray<FSNetWorldEvent>& Events)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Effects);
+	USGameplayEventSubsystem* EventBus = GetWorld()->GetSubsystem<USGameplayEventSubsystem>();
+
+	for (const FSNetWorldEvent& NetEvent : Events)
+	{
+		if (NetEvent.Type == ESNetWorldEventType::Explosion)
+		{
+			const ASExplosiveBarrel* Barrel = NetEvent.SourceClass ? Cast<ASExplosiveBarrel>(NetEvent.SourceClass->GetDefaultObject()) : nullptr;
+			if (Barrel && Barrel->GetExplosionEffect())
+			{
+				UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Barrel->GetExplosionEffect(), NetEvent.Location, FRotator::ZeroRotator, FVector(20.0f),
+					true, EPSCPoolMethod::AutoRelease);
+			}
+		}
+
+		// Local listeners (audio, UI) get server events through the same bus as in single player.
+		// No source or target is set, so the bus' own gameplay handlers ignore them.
+		if (EventBus)
+		{
+			FSGameplayEvent Event;
+			Event.Type = NetEvent.Type == ESNetWorldEventType::Explosion ? ESGameplayEventType::Explosion : ESGameplayEventType::Absorbed;
+			Event.Location = NetEvent.Location;
+			EventBus->Post(Event);
+		}
+	}
+}
+
+void ASCharacter::PrimaryAttack()
+{
+	AbilityQueue.Push(ESAbility::PrimaryAttack);
+}
+
+void ASCharacter::SpecialAttack()
+{
+	AbilityQueue.Push(ESAbility::SpecialAttack);
+}
+
+void ASCharacter::OnAbilityCastStart(ESAbility Ability)
+{
+	// Once per cast, not once per press
+	PlayAnimMontage(AttackAnim);
+}
+
+void ASCharacter::OnProjectileReleaseNotify()
+{
+	LLM_SCOPE_BYTAG(SGameplay_Abilities);
+	AbilityQueue.ReleaseCast([this](ESAbility Ability) { OnAbilityCastRelease(Ability); });
+}
+
+bool ASCharacter::HasProjectileReleaseNotify() const
+{
+	if (!AttackAnim)
+	{
+		return false;
+	}
+
+	for (const FAnimNotifyEvent& NotifyEvent : AttackAnim->Notifies)
+	{
+		if (Cast<USAnimNotify_ProjectileRelease>(NotifyEvent.Notify))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ASCharacter::OnAbilityCastRelease(ESAbility Ability)
+{
+	switch (Ability)
+	{
+	case ESAbility::PrimaryAttack: PrimaryAttack_TimeElapsed(); break;
+	case ESAbility::SpecialAttack: SpecialAttack_TimeElapsed(); break;
+	default: break;
+	}
+}
+
+void ASCharacter::SpecialAttack_TimeElapsed()
+{
+	// check if class was set
+	if (!SpecialAttackClass) return;
+	
+	// Players aim through the screen center, bots through their focus
+	RequestAimPoint([this](const FVector& AimPoint) { FireProjectileAt(ESProjectileSlot::Special, AimPoint); });
+}
+
+void ASCharacter::Dash()
+{
+	if (!DashClass) return;
+
+	// Players aim through the screen center, bots through their focus. The aim can arrive a frame later from the
+	// batched trace, the dash waits for it so the movement and the projectile start together
+	RequestAimPoint([this](const FVector& AimPoint)
+	{
+		// The movement component predicts the actual dash along the projectile's path, the projectile only shows it
+		if (USCharacterMovementComponent* Movement = Cast<USCharacterMovementComponent>(GetCharacterMovement()))
+		{
+			FVector Origin, Direction;
+			GetFireOriginAndDirection(AimPoint, Origin, Direction);
+			Movement->RequestDash(Origin, Direction);
+		}
+		FireProjectileAt(ESProjectileSlot::Dash, AimPoint);
+	});
 }
 
 // Called every frame
 void ASCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+
+	LLM_SCOPE_BYTAG(SGameplay_Abilities);
+	AbilityQueue.Advance(DeltaTime,
+		[this](ESAbility Ability) { OnAbilityCastStart(Ability); },
+		[this](ESAbility Ability) { OnAbilityCastRelease(Ability); });
 }
 
 void ASCharacter::PrimaryInteract()
@@ -298,12 +609,18 @@ void ASCharacter::PrimaryInteract()
 void ASCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
+
+	// Every binding carries its axis or action so input can be recorded and replayed in one place
+	const auto BindInputAxis = [this, PlayerInputComponent](FName AxisName, ESInputAxis Axis)
+	{
+		PlayerInputComponent->BindAxis(AxisName).AxisDelegate.GetDelegateForManualSet().BindUObject(this, &ASCharacter::OnInputAxis, Axis);
+	};
 	
-	PlayerInputComponent->BindAxis("MoveForward", this, &ASCharacter::MoveForward);
-	PlayerInputComponent->BindAxis("MoveRight", this, &ASCharacter::MoveRigth);
+	BindInputAxis("MoveForward", ESInputAxis::MoveForward);
+	BindInputAxis("MoveRight", ESInputAxis::MoveRight);
 	
-	PlayerInputComponent->BindAxis("Turn", this, &ASCharacter::AddControllerYawInput);
-	PlayerInputComponent->BindAxis("LookUp", this, &ASCharacter::AddControllerPitchInput);
+	BindInputAxis("Turn", ESInputAxis::Turn);
+	BindInputAxis("LookUp", ESInputAxis::LookUp);
 	// PlayerInputComponent->BindAction("Jump", IE_Released, this, &ACharacter::StopJumping);
 	// PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &ACharacter::Crouch);
 	// PlayerInputComponent->BindAction("Crouch", IE_Released, this, &ACharacter::UnCrouch);
@@ -312,10 +629,82 @@ void ASCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponen
 	// PlayerInputComponent->BindAction("ToggleGravity", IE_Released, this, &ACharacter::ToggleGravity);
 	// PlayerInputComponent->BindAction("StartSprint", IE_Pressed, this, &ACharacter::StartSprint);
 
-	PlayerInputComponent->BindAction("PrimaryAttack", IE_Pressed, this, &ASCharacter::PrimaryAttack);
-	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
-	PlayerInputComponent->BindAction("PrimaryInteract", IE_Pressed, this, &ASCharacter::PrimaryInteract);
-	PlayerInputComponent->BindAction("Dash", IE_Pressed, this, &ASCharacter::Dash);
-	PlayerInputComponent->BindAction("Blackhole", IE_Pressed, this, &ASCharacter::SpecialAttack);
+	PlayerInputComponent->BindAction<FSInputActionDelegate>("PrimaryAttack", IE_Pressed, this, &ASCharacter::OnInputAction, ESInputAction::PrimaryAttack);
+	PlayerInputComponent->BindAction<FSInputActionDelegate>("Jump", IE_Pressed, this, &ASCharacter::OnInputAction, ESInputAction::Jump);
+	PlayerInputComponent->BindAction<FSInputActionDelegate>("PrimaryInteract", IE_Pressed, this, &ASCharacter::OnInputAction, ESInputAction::PrimaryInteract);
+	PlayerInputComponent->BindAction<FSInputActionDelegate>("Dash", IE_Pressed, this, &ASCharacter::OnInputAction, ESInputAction::Dash);
+	PlayerInputComponent->BindAction<FSInputActionDelegate>("Blackhole", IE_Pressed, this, &ASCharacter::OnInputAction, ESInputAction::SpecialAttack);
 	
 }
+
+void ASCharacter::OnInputAxis(float Value, ESInputAxis Axis)
+{
+	if (USInputReplaySubsystem* Replay = GetWorld()->GetSubsystem<USInputReplaySubsystem>())
+	{
+		if (Replay->IsReplaying())
+		{
+			return;
+		}
+		if (Replay->IsRecording())
+		{
+			Replay->RecordAxis(this, Axis, Value);
+		}
+	}
+	ApplyInputAxis(Axis, Value);
+}
+
+void ASCharacter::OnInputAction(ESInputAction Action)
+{
+	if (USInputReplaySubsystem* Replay = GetWorld()->GetSubsystem<USInputReplaySubsystem>())
+	{
+		if (Replay->IsReplaying())
+		{
+			return;
+		}
+		if (Replay->IsRecording())
+		{
+			Replay->RecordAction(this, Action);
+		}
+	}
+	ApplyInputAction(Action);
+}
+
+void ASCharacter::ApplyInputAxis(ESInputAxis Axis, float Value)
+{
+	switch (Axis)
+	{
+	case ESInputAxis::MoveForward: MoveForward(Value); break;
+	case ESInputAxis::MoveRight: MoveRigth(Value); break;
+	case ESInputAxis::Turn: AddControllerYawInput(Value); break;
+	case ESInputAxis::LookUp: AddControllerPitchInput(Value); break;
+	default: break;
+	}
+}
+
+void ASCharacter::ApplyInputAction(ESInputAction Action)
+{
+	switch (Action)
+	{
+	case ESInputAction::PrimaryAttack: PrimaryAttack(); break;
+	case ESInputAction::SpecialAttack: SpecialAttack(); break;
+	case ESInputAction::Dash: Dash(); break;
+	case ESInputAction::PrimaryInteract: PrimaryInteract(); break;
+	case ESInputAction::Jump: Jump(); break;
+	default: break;
+	}
+}
+
+void ASCharacter::ApplyInputFrame(const FSInputFrame& Frame)
+{
+	for (int32 Axis = 0; Axis < (int32)ESInputAxis::Count; Axis++)
+	{
+		ApplyInputAxis((ESInputAxis)Axis, Frame.Axes[Axis]);
+	}
+	for (int32 Action = 0; Action < (int32)ESInputAction::Count; Action++)
+	{
+		if (Frame.Actions & (1 << Action))
+		{
+			ApplyInputAction((ESInputAction)Action);
+		}
+	}
+}
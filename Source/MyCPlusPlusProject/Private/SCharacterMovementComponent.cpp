@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SCharacterMovementComponent.h"
+
+#include "SGameplaySettings.h"
+#include "GameFramework/Character.h"
+
+USCharacterMovementComponent::USCharacterMovementComponent()
+{
+	SetNetworkMoveDataContainer(NetworkMoveDataContainer);
+
+	DashSpeed = USGameplaySettings::GetStartupConstants().DashSpeed;
+}
+
+void USCharacterMovementComponent::RequestDash(const FVector& Origin, const FVector& Direction)
+{
+	// One dash at a time, like the projectile version which only teleports once it detonates
+	if (!IsDashing())
+	{
+		bWantsToDash = true;
+		DashOrigin = Origin;
+		DashDirection = Direction;
+	}
+}
+
+void USCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToDash = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+void USCharacterMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	// On the server the dash path comes with the move, replayed moves on the client restore it in PrepMoveFor
+	if (const FSCharacterNetworkMoveData* MoveData = static_cast<const FSCharacterNetworkMoveData*>(GetCurrentNetworkMoveData()))
+	{
+		DashOrigin = MoveData->DashOrigin;
+		DashDirection = MoveData->DashDirection;
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+void USCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	if (bWantsToDash && !IsDashing())
+	{
+		StartDash();
+	}
+	bWantsToDash = false;
+
+	if (IsDashing())
+	{
+		DashTimeRemaining -= DeltaSeconds;
+		if (DashTimeRemaining <= 0.0f)
+		{
+			FinishDash();
+		}
+	}
+}
+
+void USCharacterMovementComponent::StartDash()
+{
+	// Same path the projectile flies: from the muzzle towards the aim point at the same speed until it hits something
+	// or detonates. The client picks the origin, it has to be near the character
+	const FVector CharacterLocation = UpdatedComponent->GetComponentLocation();
+	const bool bValidOrigin = FVector::DistSquared(DashOrigin, CharacterLocation) <= FMath::Square(MaxDashOriginDistance);
+	const FVector Start = bValidOrigin ? DashOrigin : CharacterLocation;
+	const FVector Direction = DashDirection.IsNearlyZero() ? CharacterOwner->GetControlRotation().Vector() : DashDirection.GetSafeNormal();
+	const FVector End = Start + Direction * USGameplaySettings::Resolve(bOverride_DashSpeed, DashSpeed, &FSGameplayConstants::DashSpeed) * DetonateDelay;
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SDash), false, CharacterOwner);
+	FHitResult Hit;
+	const bool bHit = GetWorld()->SweepSingleByChannel(Hit, Start, End, FQuat::Identity, ECC_WorldDynamic,
+		FCollisionShape::MakeSphere(20.0f), QueryParams);
+
+	DashTarget = (bHit ? Hit.Location : End) + FVector(0.0f, 0.0f, TeleportHeightOffset);
+	DashTimeRemaining = DetonateDelay + TeleportDelay;
+}
+
+void USCharacterMovementComponent::FinishDash()
+{
+	DashTimeRemaining = 0.0f;
+
+	// TeleportTo checks for encroachment and nudges the landing out of geometry, which is also the server's
+	// validation. If the client landed somewhere else it gets a regular movement correction.
+	CharacterOwner->TeleportTo(DashTarget, CharacterOwner->GetActorRotation(), false, false);
+}
+
+FNetworkPredictionData_Client* USCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		USCharacterMovementComponent* MutableThis = const_cast<USCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FSNetworkPredictionData_Client_SCharacter(*this);
+	}
+	return ClientPredictionData;
+}
+
+void FSSavedMove_SCharacter::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToDash = false;
+	SavedDashTimeRemaining = 0.0f;
+	SavedDashTarget = FVector::ZeroVector;
+	SavedDashOrigin = FVector::ZeroVector;
+	SavedDashDirection = FVector::ForwardVector;
+}
+
+uint8 FSSavedMove_SCharacter::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+	if (bSavedWantsToDash)
+	{
+		Result |= FLAG_Custom_0;
+	}
+	return Result;
+}
+
+bool FSSavedMove_SCharacter::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	// A dash request must reach the server on its own move, and dash timing must not be merged across moves
+	const FSSavedMove_SCharacter* Other = static_cast<const FSSavedMove_SCharacter*>(NewMove.Get());
+	if (bSavedWantsToDash != Other->bSavedWantsToDash || SavedDashTimeRemaining > 0.0f || Other->SavedDashTimeRemaining > 0.0f)
+	{
+		return false;
+	}
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSSavedMove_SCharacter::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	// State before the move runs, restored by PrepMoveFor when the move is replayed
+	if (const USCharacterMovementComponent* Movement = Cast<USCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToDash = Movement->bWantsToDash;
+		SavedDashTimeRemaining = Movement->DashTimeRemaining;
+		SavedDashTarget = Movement->DashTarget;
+		SavedDashOrigin = Movement->DashOrigin;
+		SavedDashDirection = Movement->DashDirection;
+	}
+}
+
+void FSSavedMove_SCharacter::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	if (USCharacterMovementComponent* Movement = Cast<USCharacterMovementComponent>(C->GetCharacterMovement()))
+	{
+		Movement->DashTimeRemaining = SavedDashTimeRemaining;
+		Movement->DashTarget = SavedDashTarget;
+		Movement->DashOrigin = SavedDashOrigin;
+		Movement->DashDirection = SavedDashDirection;
+	}
+}
+
+void FSCharacterNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	const FSSavedMove_SCharacter& Move = static_cast<const FSSavedMove_SCharacter&>(ClientMove);
+	DashOrigin = Move.SavedDashOrigin;
+	DashDirection = Move.SavedDashDirection;
+}
+
+bool FSCharacterNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	// Only moves that request the dash pay for its path, the flags are already read by the base class
+	if (CompressedMoveFlags & FSavedMove_Character::FLAG_Custom_0)
+	{
+		bool bLocalSuccess = true;
+		DashOrigin.NetSerialize(Ar, PackageMap, bLocalSuccess);
+		DashDirection.NetSerialize(Ar, PackageMap, bLocalSuccess);
+	}
+	return !Ar.IsError();
+}
+
+FSCharacterNetworkMoveDataContainer::FSCharacterNetworkMoveDataContainer()
+{
+	NewMoveData = &MoveData[0];
+	PendingMoveData = &MoveData[1];
+	OldMoveData = &MoveData[2];
+}
+
+FSNetworkPredictionData_Client_SCharacter::FSNetworkPredictionData_Client_SCharacter(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FSNetworkPredictionData_Client_SCharacter::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSSavedMove_SCharacter());
+}
@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SDamageSubsystem.h"
+
+#include "SFrameCost.h"
+
+bool USDamageSubsystem::CanApplyDamage() const
+{
+	return GetWorld()->GetNetMode() != NM_Client;
+}
+
+void USDamageSubsystem::ApplyDamage(USAttributeComponent* Target, float Amount, ESDamageType Type, AActor* Instigator)
+{
+	if (Target && Amount > 0.0f && CanApplyDamage())
+	{
+		PendingDamage.Add({ Target, Instigator, Amount, Type });
+	}
+}
+
+void USDamageSubsystem::ApplyDamage(AActor* TargetActor, float Amount, ESDamageType Type, AActor* Instigator)
+{
+	if (TargetActor)
+	{
+		ApplyDamage(TargetActor->FindComponentByClass<USAttributeComponent>(), Amount, Type, Instigator);
+	}
+}
+
+void USDamageSubsystem::ApplyRadialDamage(const FVector& Origin, float Radius, float Amount, ESDamageType Type, AActor* Instigator)
+{
+	if (Radius > 0.0f && Amount > 0.0f && CanApplyDamage())
+	{
+		PendingRadialDamage.Add({ Origin, Radius, Amount, Type, Instigator });
+	}
+}
+
+void USDamageSubsystem::RegisterTarget(USAttributeComponent* Target)
+{
+	Target->DamageSlot = Targets.Add(Target);
+}
+
+void USDamageSubsystem::UnregisterTarget(USAttributeComponent* Target)
+{
+	const int32 Slot = Target->DamageSlot;
+	if (!Targets.IsValidIndex(Slot) || Targets[Slot] != Target)
+	{
+		return;
+	}
+
+	// Swap the last target into the hole, only its slot changes
+	Targets.RemoveAtSwap(Slot);
+	if (Targets.IsValidIndex(Slot))
+	{
+		Targets[Slot]->DamageSlot = Slot;
+	}
+	Target->DamageSlot = INDEX_NONE;
+}
+
+void USDamageSubsystem::AccumulatePointDamage()
+{
+	for (const FSDamageRecord& Record : PendingDamage)
+	{
+		const USAttributeComponent* Target = Record.Target.Get();
+		if (!Target || !Targets.IsValidIndex(Target->DamageSlot))
+		{
+			continue;
+		}
+
+		FSAccumulatedDamage& Damage = Accumulated[Target->DamageSlot];
+		Damage.Amount[(int32)Record.Type] += Record.Amount;
+		Damage.Instigator = Record.Instigator.Get();
+		Damage.bDamaged = true;
+	}
+}
+
+void USDamageSubsystem::AccumulateRadialDamage()
+{
+	for (int32 Slot = 0; Slot < Targets.Num(); Slot++)
+	{
+		const FVector Location = Targets[Slot]->GetOwner()->GetActorLocation();
+		FSAccumulatedDamage& Damage = Accumulated[Slot];
+
+		for (const FSRadialDamageRecord& Record : PendingRadialDamage)
+		{
+			const float DistanceSq = FVector::DistSquared(Location, Record.Origin);
+			if (DistanceSq >= FMath::Square(Record.Radius))
+			{
+				continue;
+			}
+
+			const float Falloff = 1.0f - FMath::Sqrt(DistanceSq) / Record.Radius;
+			Damage.Amount[(int32)Record.Type] += Record.Amount * Falloff;
+			Damage.Instigator = Record.Instigator.Get();
+			Damage.bDamaged = true;
+		}
+	}
+}
+
+void USDamageSubsystem::ApplyAccumulatedDamage()
+{
+	// Copy, a target dying can destroy actors and unregister targets
+	const TArray<USAttributeComponent*> DamagedTargets = Targets;
+	const TArray<FSAccumulatedDamage> Damages = MoveTemp(Accumulated);
+
+	for (int32 Slot = 0; Slot < DamagedTargets.Num(); Slot++)
+	{
+		const FSAccumulatedDamage& Damage = Damages[Slot];
+		USAttributeComponent* Target = DamagedTargets[Slot];
+		if (!Damage.bDamaged || !IsValid(Target))
+		{
+			continue;
+		}
+
+		float Total = 0.0f;
+		for (int32 Type = 0; Type < (int32)ESDamageType::Count; Type++)
+		{
+			Total += Damage.Amount[Type] * (1.0f - Target->GetResistance((ESDamageType)Type));
+		}
+
+		if (Total > 0.0f)
+		{
+			Target->ApplyHealthChange(Damage.Instigator, -Total);
+		}
+	}
+}
+
+void USDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("Damage");
+
+	Accumulated.Reset();
+	Accumulated.SetNum(Targets.Num());
+
+	AccumulatePointDamage();
+	AccumulateRadialDamage();
+	PendingDamage.Reset();
+	PendingRadialDamage.Reset();
+
+	ApplyAccumulatedDamage();
+}
+
+TStatId USDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USDamageSubsystem, STATGROUP_Tickables);
+}
@@ -0,0 +1,244 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SExplosionOcclusionSubsystem.h"
+
+#include "SAttributeComponent.h"
+#include "SDamageSubsystem.h"
+#include "SExplosiveBarrel.h"
+#include "SFrameCost.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SMemoryBudget.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarExplosionOcclusion(
+	TEXT("s.Explosion.Occlusion"),
+	1,
+	TEXT("Explosion flames, impulse and damage only reach targets in line of sight of the blast."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarExplosionOcclusionCellSize(
+	TEXT("s.Explosion.OcclusionCellSize"),
+	200.0f,
+	TEXT("Explosions within the same cell of this size share cached line of sight results."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarExplosionOcclusionCacheTime(
+	TEXT("s.Explosion.OcclusionCacheTime"),
+	0.5f,
+	TEXT("Seconds a line of sight result between an explosion cell and a target is reused."),
+	ECVF_Default);
+
+bool USExplosionOcclusionSubsystem::IsEnabled()
+{
+	return CVarExplosionOcclusion.GetValueOnGameThread() != 0;
+}
+
+TStatId USExplosionOcclusionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USExplosionOcclusionSubsystem, STATGROUP_Tickables);
+}
+
+void USExplosionOcclusionSubsystem::QueueExplosion(const FSOccludedExplosion& Explosion)
+{
+	FSExplosionRequest& Request = QueuedExplosions.AddDefaulted_GetRef();
+	Request.Explosion = Explosion;
+	Request.Cell = GetCell(Explosion.Origin);
+}
+
+FIntVector USExplosionOcclusionSubsystem::GetCell(const FVector& Location) const
+{
+	const float CellSize = FMath::Max(CVarExplosionOcclusionCellSize.GetValueOnGameThread(), 1.0f);
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void USExplosionOcclusionSubsystem::CollectTraceResults(float Now)
+{
+	for (auto It = PendingTraces.CreateIterator(); It; ++It)
+	{
+		FTraceDatum Datum;
+		if (!GetWorld()->QueryTraceData(It.Value(), Datum))
+		{
+			// Still running, otherwise the result is lost and the target counts as visible
+			if (GetWorld()->IsTraceHandleValid(It.Value(), false))
+			{
+				continue;
+			}
+		}
+
+		bool bVisible = true;
+		for (const FHitResult& Hit : Datum.OutHits)
+		{
+			if (Hit.bBlockingHit && Hit.GetActor() != It.Key().Target.Get())
+			{
+				bVisible = false;
+				break;
+			}
+		}
+
+		Cache.Add(It.Key(), { bVisible, Now });
+		It.RemoveCurrent();
+	}
+}
+
+void USExplosionOcclusionSubsystem::GatherCandidates(FSExplosionRequest& Request) const
+{
+	const FSOccludedExplosion& Explosion = Request.Explosion;
+
+	TArray<FOverlapResult> Overlaps;
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(ExplosionOverlap), false, Explosion.Source.Get());
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Explosion.Origin, FQuat::Identity,
+		FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects), FCollisionShape::MakeSphere(Explosion.Radius), Params);
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		// Dormant instanced props are hit by the prop simulation, not here
+		UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (Component && Component->GetOwner() && !Component->IsA<UInstancedStaticMeshComponent>())
+		{
+			Request.Candidates.AddUnique(Component);
+		}
+	}
+}
+
+bool USExplosionOcclusionSubsystem::RequestVisibility(const FSExplosionRequest& Request, float Now)
+{
+	const float CacheTime = CVarExplosionOcclusionCacheTime.GetValueOnGameThread();
+
+	bool bReady = true;
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Candidate : Request.Candidates)
+	{
+		const UPrimitiveComponent* Component = Candidate.Get();
+		if (!Component)
+		{
+			continue;
+		}
+
+		const FSOcclusionKey Key{ Request.Cell, Component->GetOwner() };
+		const FSOcclusionEntry* Entry = Cache.Find(Key);
+		if (Entry && Now - Entry->Time <= CacheTime)
+		{
+			continue;
+		}
+
+		bReady = false;
+		if (PendingTraces.Contains(Key))
+		{
+			continue;
+		}
+
+		// Traced from the first explosion of the cell, the ones after it reuse the result
+		const FCollisionQueryParams Params(SCENE_QUERY_STAT(ExplosionOcclusion), false, Request.Explosion.Source.Get());
+		PendingTraces.Add(Key, GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Request.Explosion.Origin,
+			Component->Bounds.Origin, ECC_Visibility, Params));
+	}
+	return bReady;
+}
+
+bool USExplosionOcclusionSubsystem::IsVisible(const FSOcclusionKey& Key) const
+{
+	const FSOcclusionEntry* Entry = Cache.Find(Key);
+	return !Entry || Entry->bVisible;
+}
+
+void USExplosionOcclusionSubsystem::ApplyExplosion(const FSExplosionRequest& Request)
+{
+	const FSOccludedExplosion& Explosion = Request.Explosion;
+	UParticleSystem* FlameEffect = Explosion.FlameEffect.Get();
+	USDamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<USDamageSubsystem>();
+
+	// The same props an unoccluded barrel sets fire to
+	TArray<AActor*> FlameTargets;
+	const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>();
+	if (FlameEffect && Registry)
+	{
+		Registry->GetActorsInRadius(Explosion.Origin, Explosion.Radius, FlameTargets,
+			{ ESRegistryKind::Barrel, ESRegistryKind::Chest, ESRegistryKind::PhysicsProp });
+	}
+
+	TSet<AActor*> VisitedActors;
+	for (const TWeakObjectPtr<UPrimitiveComponent>& Candidate : Request.Candidates)
+	{
+		UPrimitiveComponent* Component = Candidate.Get();
+		AActor* Actor = Component ? Component->GetOwner() : nullptr;
+		if (!Actor || !IsVisible({ Request.Cell, Actor }))
+		{
+			continue;
+		}
+
+		// What RadialForceComp->FireImpulse does, minus the bodies behind walls
+		if (Explosion.Impulse > 0.0f)
+		{
+			ASExplosiveBarrel::ApplyImpulse(Component, Explosion.Origin, Explosion.Radius, Explosion.Impulse, Explosion.Falloff,
+				Explosion.bImpulseVelChange);
+		}
+
+		// Flames and damage once per actor
+		bool bAlreadyVisited = false;
+		VisitedActors.Add(Actor, &bAlreadyVisited);
+		if (bAlreadyVisited)
+		{
+			continue;
+		}
+
+		if (FlameTargets.Contains(Actor))
+		{
+			if (UStaticMeshComponent* Mesh = Actor->FindComponentByClass<UStaticMeshComponent>())
+			{
+				ASExplosiveBarrel::AttachFlame(FlameEffect, Mesh);
+			}
+		}
+
+		USAttributeComponent* Attributes = Actor->FindComponentByClass<USAttributeComponent>();
+		if (DamageSubsystem && Attributes && Explosion.Damage > 0.0f)
+		{
+			const float Falloff = 1.0f - FMath::Min(FVector::Dist(Actor->GetActorLocation(), Explosion.Origin) / Explosion.Radius, 1.0f);
+			DamageSubsystem->ApplyDamage(Attributes, Explosion.Damage * Falloff, ESDamageType::Explosion, Explosion.Source.Get());
+		}
+	}
+}
+
+void USExplosionOcclusionSubsystem::Tick(float DeltaTime)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Effects);
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("ExplosionOcclusion");
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	CollectTraceResults(Now);
+
+	for (int32 i = WaitingExplosions.Num() - 1; i >= 0; --i)
+	{
+		if (RequestVisibility(WaitingExplosions[i], Now))
+		{
+			ApplyExplosion(WaitingExplosions[i]);
+			WaitingExplosions.RemoveAtSwap(i);
+		}
+	}
+
+	// Every trace of this frame's explosions goes out in the same batch, cached targets need none
+	TArray<FSExplosionRequest> NewExplosions = MoveTemp(QueuedExplosions);
+	for (FSExplosionRequest& Request : NewExplosions)
+	{
+		GatherCandidates(Request);
+		if (RequestVisibility(Request, Now))
+		{
+			ApplyExplosion(Request);
+		}
+		else
+		{
+			WaitingExplosions.Add(MoveTemp(Request));
+		}
+	}
+
+	const float CacheTime = CVarExplosionOcclusionCacheTime.GetValueOnGameThread();
+	for (auto It = Cache.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().Time > CacheTime || !It.Key().Target.IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
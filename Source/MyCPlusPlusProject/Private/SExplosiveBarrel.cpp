@@ -4,6 +4,15 @@
 #include "SExplosiveBarrel.h"
 
 #include "SCharacter.h"
+#include "SDamageSubsystem.h"
+#include "SExplosionOcclusionSubsystem.h"
+#include "SFireSubsystem.h"
+#include "SGameplayEventSubsystem.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SMemoryBudget.h"
+#include "SPropSimulationSubsystem.h"
+#include "SSaveGameSubsystem.h"
+#include "GameFramework/MovementComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "PhysicsEngine/RadialForceComponent.h"
 
@@ -24,8 +33,6 @@ ASExplosiveBarrel::ASExplosiveBarrel()
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
-	
-	UE_LOG(LogTemp, Log, TEXT("Explosive Barrel Created"));
 
 	MeshComp = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("MeshComp"));
 	SetRootComponent(MeshComp);
@@ -35,41 +42,84 @@ ASExplosiveBarrel::ASExplosiveBarrel()
 	MeshComp->OnComponentHit.AddDynamic(this, &ASExplosiveBarrel::OnHit);
 
 	// Valores padrão para os parâmetros da explosão
-	ExplosionRadius = 1000.0f;
-	ExplosionImpulse = 2000.0f;
+	const FSGameplayConstants& Defaults = USGameplaySettings::GetStartupConstants();
+	ExplosionRadius = Defaults.BarrelExplosionRadius;
+	ExplosionImpulse = Defaults.BarrelExplosionImpulse;
 
+	// Never registered, Explode fires the impulse itself. Kept for the falloff and velocity change set on it
 	RadialForceComp = CreateDefaultSubobject<URadialForceComponent>(TEXT("RadialForceComp"));
 	RadialForceComp->SetupAttachment(MeshComp);
+	RadialForceComp->bAutoRegister = false;
 	RadialForceComp->bImpulseVelChange = true;
 	RadialForceComp->bAutoActivate = false;
-	RadialForceComp->Radius = ExplosionRadius;
-	RadialForceComp->ForceStrength = ExplosionImpulse;
 
 	bExploded = false;
+
+	// Explosions only happen on the server, clients get the destroy through replication and the effects
+	// through the batched world events. Physics barrels rarely move, so a low update rate is enough.
+	bReplicates = true;
+	SetReplicateMovement(true);
+	NetUpdateFrequency = 10.0f;
 }
 
 void ASExplosiveBarrel::OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
 	FVector NormalImpulse, const FHitResult& Hit)
 {
-	UE_LOG(LogTemp, Log, TEXT("Barrel hit by: %s"), *GetNameSafe(OtherActor));
+	if (HasAuthority())
+	{
+		RequestExplode();
+	}
+}
+
+void ASExplosiveBarrel::RequestExplode()
+{
+	// Exploding spawns effects and fires impulses, which must not happen inside the physics callback that hit us
+	if (USGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<USGameplayEventSubsystem>())
+	{
+		FSGameplayEvent Event;
+		Event.Type = ESGameplayEventType::Explosion;
+		Event.Source = this;
+		Event.Location = GetActorLocation();
+		Events->Post(Event);
+		return;
+	}
+
 	Explode();
 	Destroy();
 }
 
 void ASExplosiveBarrel::Explode()
 {
+    LLM_SCOPE_BYTAG(SGameplay_Effects);
+    if (bExploded)
+    {
+        return;
+    }
+    bExploded = true;
+
+    // Read when going off, so a reload of the gameplay settings applies to the next explosion
+    const float Radius = GetExplosionRadius();
+    const float Impulse = GetExplosionImpulse();
+
+    if (USSaveGameSubsystem* Save = GetWorld()->GetSubsystem<USSaveGameSubsystem>())
+    {
+        Save->MarkChanged(this, ESSaveFlags::Exploded | ESSaveFlags::Destroyed);
+    }
+
     UE_LOG(LogTemp, Warning, TEXT("Barrel exploding at location: %s"), *GetActorLocation().ToString());
     // Spawnar efeito de partículas de explosão
     if (ExplosionEffect)
     {
-        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionEffect, GetActorLocation(), FRotator::ZeroRotator, FVector(20.0f));
+        // Pooled by the world, a chain of explosions doesn't create and collect a component per barrel
+        UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionEffect, GetActorLocation(), FRotator::ZeroRotator, FVector(20.0f),
+            true, EPSCPoolMethod::AutoRelease);
     }
 
 	// Draw debug sphere to visualize explosion radius
 	DrawDebugSphere(
 		GetWorld(),
 		GetActorLocation(),
-		ExplosionRadius,
+		Radius,
 		32,              // Number of segments
 		FColor::Red,     // Color
 		false,           // Persistent lines
@@ -79,9 +129,30 @@ void ASExplosiveBarrel::Explode()
 	);
 
 
-    // Get all overlapping actors in radius
+    // With occlusion flames, damage and impulse are applied a frame later to what the blast can see
+    USExplosionOcclusionSubsystem* Occlusion = USExplosionOcclusionSubsystem::IsEnabled() ? GetWorld()->GetSubsystem<USExplosionOcclusionSubsystem>() : nullptr;
+    if (Occlusion)
+    {
+        FSOccludedExplosion Explosion;
+        Explosion.Origin = GetActorLocation();
+        Explosion.Radius = Radius;
+        Explosion.Impulse = Impulse;
+        Explosion.Falloff = GetImpulseFalloff();
+        Explosion.bImpulseVelChange = GetImpulseVelChange();
+        Explosion.Damage = ExplosionDamage;
+        Explosion.FlameEffect = FlameEffect;
+        Explosion.Source = this;
+        Occlusion->QueueExplosion(Explosion);
+    }
+
+    // Props in radius, only the ones in loaded cells are registered
     TArray<AActor*> OverlappingActors;
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActor::StaticClass(), OverlappingActors);
+    const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>();
+    if (!Occlusion && Registry)
+    {
+        Registry->GetActorsInRadius(GetActorLocation(), Radius, OverlappingActors,
+            { ESRegistryKind::Barrel, ESRegistryKind::Chest, ESRegistryKind::PhysicsProp });
+    }
 
     // Apply burning effect to each actor's components
     for(auto* Actor : OverlappingActors)
@@ -92,35 +163,112 @@ void ASExplosiveBarrel::Explode()
         	// Calculate distance to actor
         	float Distance = FVector::Distance(GetActorLocation(), Actor->GetActorLocation());
 
-        	if (Distance <= ExplosionRadius)
+        	if (Distance <= Radius)
         	{
-        		// Log the distance for debugging
-        		UE_LOG(LogTemp, Log, TEXT("Actor: %s at distance: %f"), *GetNameSafe(Actor), Distance);
-        	
         		UStaticMeshComponent* FindMeshComp = Cast<UStaticMeshComponent>(Actor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
         		if(FindMeshComp)
         		{
         			// Ignore SCharacter class
         			if (Actor->IsA(ASCharacter::StaticClass()))
         			{
-        				UE_LOG(LogTemp, Log, TEXT("Ignoring SCharacter class"));
         				continue;
         			}
 				
-        			UE_LOG(LogTemp, Log, TEXT("Applying flame effect to: %s"), *GetNameSafe(Actor));
-        			UGameplayStatics::SpawnEmitterAttached(FlameEffect, FindMeshComp, NAME_None, 
-						FVector::ZeroVector, FRotator::ZeroRotator, EAttachLocation::SnapToTarget, true);
-        		}
-        		else
-        		{
-        			UE_LOG(LogTemp, Log, TEXT("Actor: %s at distance: %f outside radius"), *GetNameSafe(Actor), Distance);
+        			AttachFlame(FlameEffect, FindMeshComp);
         		}
         	}
         }
     }
 
+    // Characters in range take damage with everything else that hit them this frame
+    USDamageSubsystem* Damage = GetWorld()->GetSubsystem<USDamageSubsystem>();
+    if (!Occlusion && Damage)
+    {
+        Damage->ApplyRadialDamage(GetActorLocation(), Radius, ExplosionDamage, ESDamageType::Explosion, this);
+    }
+
+    // Dormant barrels around us live in the prop simulation, let it burn and chain-detonate them
+    if (USPropSimulationSubsystem* PropSimulation = GetWorld()->GetSubsystem<USPropSimulationSubsystem>())
+    {
+        PropSimulation->AddExplosion(GetActorLocation(), Radius);
+    }
+
+    // Spilled fuel keeps burning and spreads on the fire grid after the blast
+    if (USFireSubsystem* Fire = GetWorld()->GetSubsystem<USFireSubsystem>())
+    {
+        Fire->SetFlameTemplate(FlameEffect);
+        Fire->AddFuel(GetActorLocation(), Radius * 0.25f, 2.0f);
+        Fire->AddHeat(GetActorLocation(), Radius * 0.25f, 20.0f);
+    }
+
     // Aplicar força radial aos objetos próximos  
-    RadialForceComp->FireImpulse();
+    // What RadialForceComp->FireImpulse does, without registering the component
+    if (!Occlusion)
+    {
+        FireImpulse(GetWorld(), GetActorLocation(), Radius, Impulse, GetImpulseFalloff(), GetImpulseVelChange(), this);
+    }
+}
+
+void ASExplosiveBarrel::ApplyImpulse(UPrimitiveComponent* Component, const FVector& Origin, float Radius, float Strength,
+    ERadialImpulseFalloff Falloff, bool bVelChange)
+{
+    // Does nothing unless the component simulates
+    Component->AddRadialImpulse(Origin, Radius, Strength, Falloff, bVelChange);
+
+    if (AActor* Owner = Component->GetOwner())
+    {
+        TInlineComponentArray<UMovementComponent*> MovementComponents(Owner);
+        for (UMovementComponent* MovementComponent : MovementComponents)
+        {
+            if (MovementComponent->UpdatedComponent == Component)
+            {
+                MovementComponent->AddRadialImpulse(Origin, Radius, Strength, Falloff, bVelChange);
+                break;
+            }
+        }
+    }
+}
+
+void ASExplosiveBarrel::FireImpulse(UWorld* World, const FVector& Origin, float Radius, float Strength, ERadialImpulseFalloff Falloff,
+    bool bVelChange, const AActor* IgnoreActor)
+{
+    TArray<FOverlapResult> Overlaps;
+    const FCollisionQueryParams Params(SCENE_QUERY_STAT(BarrelExplosionImpulse), false, IgnoreActor);
+    World->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity,
+        FCollisionObjectQueryParams(FCollisionObjectQueryParams::AllDynamicObjects), FCollisionShape::MakeSphere(Radius), Params);
+
+    // Once per component, a ragdoll overlaps with every body
+    TSet<UPrimitiveComponent*> Pushed;
+    for (const FOverlapResult& Overlap : Overlaps)
+    {
+        UPrimitiveComponent* Component = Overlap.GetComponent();
+        bool bAlreadyPushed = true;
+        if (Component)
+        {
+            Pushed.Add(Component, &bAlreadyPushed);
+        }
+        if (!bAlreadyPushed)
+        {
+            ApplyImpulse(Component, Origin, Radius, Strength, Falloff, bVelChange);
+        }
+    }
+}
+
+ERadialImpulseFalloff ASExplosiveBarrel::GetImpulseFalloff() const
+{
+    return RadialForceComp->Falloff;
+}
+
+bool ASExplosiveBarrel::GetImpulseVelChange() const
+{
+    return RadialForceComp->bImpulseVelChange;
+}
+
+void ASExplosiveBarrel::AttachFlame(UParticleSystem* FlameEffect, UStaticMeshComponent* Mesh)
+{
+    LLM_SCOPE_BYTAG(SGameplay_Effects);
+    UGameplayStatics::SpawnEmitterAttached(FlameEffect, Mesh, NAME_None,
+        FVector::ZeroVector, FRotator::ZeroRotator, EAttachLocation::SnapToTarget, true);
 }
 
 // Called when the game starts or when spawned
@@ -129,6 +277,19 @@ void ASExplosiveBarrel::BeginPlay()
 	Super::BeginPlay();
 	// Inicializar variáveis
 	bExploded = false;
+
+	GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>()->Register(this, ESRegistryKind::Barrel);
+}
+
+void ASExplosiveBarrel::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Also called when the barrel's streaming cell unloads
+	if (USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>())
+	{
+		Registry->Unregister(this, ESRegistryKind::Barrel);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame 
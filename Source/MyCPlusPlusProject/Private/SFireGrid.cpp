@@ -0,0 +1,243 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SFireGrid.h"
+
+// Below this the whole fire is considered out and the active region is cleared
+static constexpr float FireGridDeadHeat = 0.01f;
+
+void FSFireGrid::Init(int32 InWidth, int32 InHeight, float InCellSize, const FVector2D& InOrigin)
+{
+	Width = FMath::Max(InWidth, 3);
+	Height = FMath::Max(InHeight, 3);
+	CellSize = InCellSize;
+	Origin = InOrigin;
+
+	Fuel.SetNumZeroed(Width * Height);
+	Heat.SetNumZeroed(Width * Height);
+	HeatNext.SetNumZeroed(Width * Height);
+	PendingHeat.Reset();
+
+	bActive = false;
+}
+
+bool FSFireGrid::WorldToCell(const FVector& Location, int32& OutX, int32& OutY) const
+{
+	OutX = FMath::FloorToInt((Location.X - Origin.X) / CellSize);
+	OutY = FMath::FloorToInt((Location.Y - Origin.Y) / CellSize);
+	return IsValidCell(OutX, OutY);
+}
+
+FVector FSFireGrid::CellToWorld(int32 X, int32 Y) const
+{
+	return FVector(Origin.X + (X + 0.5f) * CellSize, Origin.Y + (Y + 0.5f) * CellSize, 0.0f);
+}
+
+void FSFireGrid::AddFuel(int32 X, int32 Y, float Amount)
+{
+	if (IsValidCell(X, Y))
+	{
+		Fuel[Index(X, Y)] += Amount;
+	}
+}
+
+void FSFireGrid::AddHeat(int32 X, int32 Y, float Amount)
+{
+	// Applied at the start of the next step so a step in progress never sees half of a deposit
+	if (IsValidCell(X, Y))
+	{
+		PendingHeat.Emplace(Index(X, Y), Amount);
+		ExpandActiveRegion(X, Y);
+	}
+}
+
+void FSFireGrid::AddFuelInRadius(const FVector& Location, float Radius, float Amount)
+{
+	int32 CenterX, CenterY;
+	WorldToCell(Location, CenterX, CenterY);
+	const int32 CellRadius = FMath::CeilToInt(Radius / CellSize);
+
+	// Always fuel the centre cell, a single barrel is a point and rarely sits exactly on a cell centre
+	AddFuel(CenterX, CenterY, Amount);
+
+	for (int32 Y = CenterY - CellRadius; Y <= CenterY + CellRadius; Y++)
+	{
+		for (int32 X = CenterX - CellRadius; X <= CenterX + CellRadius; X++)
+		{
+			if ((X != CenterX || Y != CenterY) && FVector::DistSquared2D(CellToWorld(X, Y), Location) <= FMath::Square(Radius))
+			{
+				AddFuel(X, Y, Amount);
+			}
+		}
+	}
+}
+
+void FSFireGrid::AddHeatInRadius(const FVector& Location, float Radius, float Amount)
+{
+	int32 CenterX, CenterY;
+	WorldToCell(Location, CenterX, CenterY);
+	const int32 CellRadius = FMath::CeilToInt(Radius / CellSize);
+
+	// Always heat the centre cell, explosions smaller than a cell would otherwise do nothing
+	AddHeat(CenterX, CenterY, Amount);
+
+	for (int32 Y = CenterY - CellRadius; Y <= CenterY + CellRadius; Y++)
+	{
+		for (int32 X = CenterX - CellRadius; X <= CenterX + CellRadius; X++)
+		{
+			if ((X != CenterX || Y != CenterY) && FVector::DistSquared2D(CellToWorld(X, Y), Location) <= FMath::Square(Radius))
+			{
+				AddHeat(X, Y, Amount);
+			}
+		}
+	}
+}
+
+void FSFireGrid::ExpandActiveRegion(int32 X, int32 Y)
+{
+	if (!bActive)
+	{
+		ActiveMin = ActiveMax = FIntPoint(X, Y);
+		bActive = true;
+		return;
+	}
+	ActiveMin = FIntPoint(FMath::Min(ActiveMin.X, X), FMath::Min(ActiveMin.Y, Y));
+	ActiveMax = FIntPoint(FMath::Max(ActiveMax.X, X), FMath::Max(ActiveMax.Y, Y));
+}
+
+void FSFireGrid::BeginStep(float StepDeltaTime)
+{
+	for (const TPair<int32, float>& Deposit : PendingHeat)
+	{
+		Heat[Deposit.Key] += Deposit.Value;
+	}
+	PendingHeat.Reset();
+
+	if (!bActive)
+	{
+		return;
+	}
+
+	// Heat can travel one cell per step, so the region grows by one in every direction (borders stay cold)
+	ActiveMin = StepMin = FIntPoint(FMath::Max(ActiveMin.X - 1, 1), FMath::Max(ActiveMin.Y - 1, 1));
+	ActiveMax = StepMax = FIntPoint(FMath::Min(ActiveMax.X + 1, Width - 2), FMath::Min(ActiveMax.Y + 1, Height - 2));
+
+	// Explicit diffusion is only stable below 0.25 per step
+	StepDiffusion = FMath::Min(Params.Diffusion * StepDeltaTime, 0.24f);
+	StepKeep = FMath::Max(1.0f - Params.Cooling * StepDeltaTime, 0.0f);
+	StepBurn = Params.BurnRate * StepDeltaTime;
+	StepMaxHeat = 0.0f;
+}
+
+void FSFireGrid::StepRows(int32 FirstRow, int32 NumRows)
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	const int32 RowBegin = StepMin.Y + FirstRow;
+	const int32 RowEnd = FMath::Min(RowBegin + NumRows - 1, StepMax.Y);
+
+	const VectorRegister4Float Diffusion = VectorSetFloat1(StepDiffusion);
+	const VectorRegister4Float Keep = VectorSetFloat1(StepKeep);
+	const VectorRegister4Float Four = VectorSetFloat1(4.0f);
+
+	const float* RESTRICT Src = Heat.GetData();
+	float* RESTRICT Dst = HeatNext.GetData();
+	float* RESTRICT FuelData = Fuel.GetData();
+
+	for (int32 Y = RowBegin; Y <= RowEnd; Y++)
+	{
+		const int32 Row = Y * Width;
+		int32 X = StepMin.X;
+
+		// Next = (H + D * (L + R + U + D - 4H)) * Keep, four cells per iteration
+		for (; X + 3 <= StepMax.X; X += 4)
+		{
+			const int32 i = Row + X;
+			const VectorRegister4Float Center = VectorLoad(Src + i);
+			const VectorRegister4Float Left = VectorLoad(Src + i - 1);
+			const VectorRegister4Float Right = VectorLoad(Src + i + 1);
+			const VectorRegister4Float Up = VectorLoad(Src + i - Width);
+			const VectorRegister4Float Down = VectorLoad(Src + i + Width);
+
+			const VectorRegister4Float Sum = VectorAdd(VectorAdd(Left, Right), VectorAdd(Up, Down));
+			const VectorRegister4Float Laplacian = VectorSubtract(Sum, VectorMultiply(Center, Four));
+			VectorStore(VectorMultiply(VectorMultiplyAdd(Laplacian, Diffusion, Center), Keep), Dst + i);
+		}
+		for (; X <= StepMax.X; X++)
+		{
+			const int32 i = Row + X;
+			const float Laplacian = Src[i - 1] + Src[i + 1] + Src[i - Width] + Src[i + Width] - 4.0f * Src[i];
+			Dst[i] = (Src[i] + StepDiffusion * Laplacian) * StepKeep;
+		}
+
+		// Combustion, burning cells turn fuel into heat
+		for (X = StepMin.X; X <= StepMax.X; X++)
+		{
+			const int32 i = Row + X;
+			if (FuelData[i] > 0.0f && Src[i] >= Params.IgnitionHeat)
+			{
+				const float Burnt = FMath::Min(FuelData[i], StepBurn);
+				FuelData[i] -= Burnt;
+				Dst[i] += Burnt * Params.HeatPerFuel;
+			}
+			StepMaxHeat = FMath::Max(StepMaxHeat, Dst[i]);
+		}
+	}
+}
+
+void FSFireGrid::EndStep()
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	Swap(Heat, HeatNext);
+
+	// Fire is out, clear the region so the next fire starts from a small box again
+	if (StepMaxHeat < FireGridDeadHeat && PendingHeat.Num() == 0)
+	{
+		for (int32 Y = ActiveMin.Y; Y <= ActiveMax.Y; Y++)
+		{
+			FMemory::Memzero(&Heat[Index(ActiveMin.X, Y)], (ActiveMax.X - ActiveMin.X + 1) * sizeof(float));
+			FMemory::Memzero(&HeatNext[Index(ActiveMin.X, Y)], (ActiveMax.X - ActiveMin.X + 1) * sizeof(float));
+		}
+		bActive = false;
+	}
+}
+
+void FSFireGrid::Step(float StepDeltaTime)
+{
+	BeginStep(StepDeltaTime);
+	StepRows(0, GetNumStepRows());
+	EndStep();
+}
+
+double FSFireGrid::RunBenchmark(int32 Size, int32 NumSteps, int32& OutActiveCells)
+{
+	FSFireGrid Grid;
+	Grid.Init(Size, Size, 100.0f, FVector2D::ZeroVector);
+
+	// Fuel everywhere so the fire keeps spreading for the whole run
+	for (int32 Y = 1; Y < Size - 1; Y++)
+	{
+		for (int32 X = 1; X < Size - 1; X++)
+		{
+			Grid.AddFuel(X, Y, 10.0f);
+		}
+	}
+	Grid.AddHeat(Size / 2, Size / 2, 50.0f);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumSteps; i++)
+	{
+		Grid.Step(0.1f);
+	}
+	const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	OutActiveCells = Grid.bActive ? (Grid.ActiveMax.X - Grid.ActiveMin.X + 1) * (Grid.ActiveMax.Y - Grid.ActiveMin.Y + 1) : 0;
+	return ElapsedMs / FMath::Max(NumSteps, 1);
+}
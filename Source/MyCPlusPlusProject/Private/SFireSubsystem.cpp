@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SFireSubsystem.h"
+
+#include "SFrameCost.h"
+#include "SExplosiveBarrel.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SMemoryBudget.h"
+#include "SPropSimulationSubsystem.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystemComponent.h"
+
+static TAutoConsoleVariable<float> CVarFireStepRate(
+	TEXT("s.Fire.StepRate"), 10.0f,
+	TEXT("Fire simulation steps per second, each step is spread over the frames in between."), ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFireGridSize(
+	TEXT("s.Fire.GridSize"), 512,
+	TEXT("Cells per side of the fire grid, read when the world starts."), ECVF_ReadOnly);
+
+static TAutoConsoleVariable<float> CVarFireCellSize(
+	TEXT("s.Fire.CellSize"), 200.0f,
+	TEXT("Size of a fire cell in world units, read when the world starts."), ECVF_ReadOnly);
+
+static TAutoConsoleVariable<int32> CVarFireMaxFlameVisuals(
+	TEXT("s.Fire.MaxFlameVisuals"), 48,
+	TEXT("Size of the pooled flame emitter set, only the burning cells closest to a camera get one."), ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarFireVisualDistance(
+	TEXT("s.Fire.VisualDistance"), 10000.0f,
+	TEXT("Burning cells further than this from every camera get no flame emitter."), ECVF_Default);
+
+static FAutoConsoleCommand FireBenchmarkCommand(
+	TEXT("s.Fire.Benchmark"),
+	TEXT("Steps a standalone fire grid, no world needed. Usage: s.Fire.Benchmark [GridSize=512] [Steps=200]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Size = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 512;
+		const int32 NumSteps = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 200;
+
+		int32 ActiveCells = 0;
+		const double MsPerStep = FSFireGrid::RunBenchmark(Size, NumSteps, ActiveCells);
+		UE_LOG(LogTemp, Display, TEXT("FireGrid benchmark: %dx%d grid, %d steps, %.3f ms/step, %d active cells at the end (%.1f Mcells/s)"),
+			Size, Size, NumSteps, MsPerStep, ActiveCells, MsPerStep > 0.0 ? ActiveCells / (MsPerStep * 1000.0) : 0.0);
+	}));
+
+bool USFireSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	if (!Super::ShouldCreateSubsystem(Outer))
+	{
+		return false;
+	}
+
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && (World->WorldType == EWorldType::Game || World->WorldType == EWorldType::PIE);
+}
+
+void USFireSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const int32 Size = CVarFireGridSize.GetValueOnGameThread();
+	const float CellSize = CVarFireCellSize.GetValueOnGameThread();
+
+	// Centred on the world origin
+	Grid.Init(Size, Size, CellSize, FVector2D(-0.5f * Size * CellSize));
+	BurningCells.Init(false, Size * Size);
+	CellHeights.SetNumZeroed(Size * Size);
+	HasCellHeight.Init(false, Size * Size);
+
+	// Simulated props that explode start fires the same way live barrels do
+	if (USPropSimulationSubsystem* PropSimulation = Collection.InitializeDependency<USPropSimulationSubsystem>())
+	{
+		PropSimulation->OnEntitiesExploded.AddUObject(this, &USFireSubsystem::OnPropsExploded);
+	}
+}
+
+void USFireSubsystem::Deinitialize()
+{
+	if (USPropSimulationSubsystem* PropSimulation = GetWorld()->GetSubsystem<USPropSimulationSubsystem>())
+	{
+		PropSimulation->OnEntitiesExploded.RemoveAll(this);
+	}
+
+	for (UParticleSystemComponent* Flame : FlamePool)
+	{
+		if (Flame)
+		{
+			Flame->DestroyComponent();
+		}
+	}
+	FlamePool.Reset();
+	FlamePoolCells.Reset();
+
+	Super::Deinitialize();
+}
+
+void USFireSubsystem::RecordCellHeight(const FVector& Location, float Radius)
+{
+	int32 CenterX, CenterY;
+	Grid.WorldToCell(Location, CenterX, CenterY);
+	const int32 CellRadius = FMath::CeilToInt(Radius / Grid.GetCellSize());
+
+	for (int32 Y = CenterY - CellRadius; Y <= CenterY + CellRadius; Y++)
+	{
+		for (int32 X = CenterX - CellRadius; X <= CenterX + CellRadius; X++)
+		{
+			if (Grid.IsValidCell(X, Y))
+			{
+				CellHeights[Y * Grid.GetWidth() + X] = Location.Z;
+				HasCellHeight[Y * Grid.GetWidth() + X] = true;
+			}
+		}
+	}
+}
+
+void USFireSubsystem::AddFuel(const FVector& Location, float Radius, float Amount)
+{
+	Grid.AddFuelInRadius(Location, Radius, Amount);
+	RecordCellHeight(Location, Radius);
+}
+
+void USFireSubsystem::AddHeat(const FVector& Location, float Radius, float Amount)
+{
+	Grid.AddHeatInRadius(Location, Radius, Amount);
+	RecordCellHeight(Location, Radius);
+}
+
+void USFireSubsystem::SetFlameTemplate(UParticleSystem* Template)
+{
+	if (!FlameTemplate)
+	{
+		FlameTemplate = Template;
+	}
+}
+
+void USFireSubsystem::OnPropsExploded(TConstArrayView<int32> Entities)
+{
+	const FSPropSimFragments& Fragments = GetWorld()->GetSubsystem<USPropSimulationSubsystem>()->GetFragments();
+	for (int32 Entity : Entities)
+	{
+		AddHeat(FVector(Fragments.Positions[Entity]), Grid.GetCellSize(), 20.0f);
+	}
+}
+
+void USFireSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("Fire");
+
+	if (!Grid.HasActiveRegion())
+	{
+		StepAccumulator = 0.0f;
+		return;
+	}
+
+	const float StepInterval = 1.0f / FMath::Max(CVarFireStepRate.GetValueOnGameThread(), 0.1f);
+	StepAccumulator += DeltaTime;
+
+	if (!bStepInProgress)
+	{
+		if (StepAccumulator < StepInterval)
+		{
+			return;
+		}
+
+		// Never try to catch up on more than one step after a hitch
+		StepAccumulator = FMath::Min(StepAccumulator - StepInterval, StepInterval);
+		Grid.BeginStep(StepInterval);
+		NextStepRow = 0;
+		bStepInProgress = true;
+	}
+
+	// Spread the rows of this step over the frames until the next one is due
+	const int32 NumRows = Grid.GetNumStepRows();
+	const int32 RowsThisFrame = FMath::Max(1, FMath::CeilToInt(NumRows * FMath::Min(DeltaTime / StepInterval, 1.0f)));
+	Grid.StepRows(NextStepRow, RowsThisFrame);
+	NextStepRow += RowsThisFrame;
+
+	if (NextStepRow >= NumRows)
+	{
+		Grid.EndStep();
+		bStepInProgress = false;
+		OnStepCompleted();
+	}
+}
+
+void USFireSubsystem::OnStepCompleted()
+{
+	const int32 Width = Grid.GetWidth();
+
+	TArray<FIntPoint> Burning;
+	TArray<FIntPoint> NewlyBurning;
+	TBitArray<> StillBurning(false, BurningCells.Num());
+
+	Grid.ForEachBurningCell([&](int32 X, int32 Y)
+	{
+		const int32 CellIndex = Y * Width + X;
+		Burning.Emplace(X, Y);
+		StillBurning[CellIndex] = true;
+		if (!BurningCells[CellIndex])
+		{
+			NewlyBurning.Emplace(X, Y);
+		}
+
+		// Fire spread into a cell we have no height for, borrow it from a neighbour
+		if (!HasCellHeight[CellIndex])
+		{
+			for (const int32 Neighbour : { CellIndex - 1, CellIndex + 1, CellIndex - Width, CellIndex + Width })
+			{
+				if (HasCellHeight[Neighbour])
+				{
+					CellHeights[CellIndex] = CellHeights[Neighbour];
+					HasCellHeight[CellIndex] = true;
+					break;
+				}
+			}
+		}
+	});
+
+	BurningCells = MoveTemp(StillBurning);
+
+	if (NewlyBurning.Num() > 0)
+	{
+		IgniteCells(NewlyBurning);
+	}
+	UpdateFlameVisuals(Burning);
+}
+
+void USFireSubsystem::IgniteCells(const TArray<FIntPoint>& Cells)
+{
+	const int32 Width = Grid.GetWidth();
+
+	if (USPropSimulationSubsystem* PropSimulation = GetWorld()->GetSubsystem<USPropSimulationSubsystem>())
+	{
+		for (const FIntPoint& Cell : Cells)
+		{
+			FVector Location = Grid.CellToWorld(Cell.X, Cell.Y);
+			Location.Z = CellHeights[Cell.Y * Width + Cell.X];
+			PropSimulation->AddFire(Location, Grid.GetCellSize());
+		}
+	}
+
+	// Live barrels are only the few promoted ones, checking them when new cells catch fire is cheap
+	if (const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>())
+	{
+		Registry->ForEach<ASExplosiveBarrel>(ESRegistryKind::Barrel, [this, Width](ASExplosiveBarrel* Barrel)
+		{
+			int32 X, Y;
+			if (Grid.WorldToCell(Barrel->GetActorLocation(), X, Y) && BurningCells[Y * Width + X])
+			{
+				Barrel->RequestExplode();
+			}
+		});
+	}
+}
+
+void USFireSubsystem::UpdateFlameVisuals(const TArray<FIntPoint>& Cells)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Effects);
+	const int32 Width = Grid.GetWidth();
+	const int32 MaxVisuals = FlameTemplate ? CVarFireMaxFlameVisuals.GetValueOnGameThread() : 0;
+	const float MaxDistanceSq = FMath::Square(CVarFireVisualDistance.GetValueOnGameThread());
+
+	struct FView
+	{
+		FVector Location;
+		FVector Direction;
+		float CosHalfFOV;
+	};
+	TArray<FView, TInlineAllocator<4>> Views;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PC = It->Get();
+		if (PC && PC->IsLocalController() && PC->PlayerCameraManager)
+		{
+			// A little wider than the real FOV so flames don't pop at the screen edge
+			const float HalfFOV = FMath::DegreesToRadians(FMath::Min(PC->PlayerCameraManager->GetFOVAngle() * 0.6f, 89.0f));
+			Views.Add({ PC->PlayerCameraManager->GetCameraLocation(), PC->PlayerCameraManager->GetCameraRotation().Vector(), FMath::Cos(HalfFOV) });
+		}
+	}
+
+	// Visible burning cells, closest first
+	TArray<TPair<float, int32>> Visible;
+	if (MaxVisuals > 0)
+	{
+		for (const FIntPoint& Cell : Cells)
+		{
+			const int32 CellIndex = Cell.Y * Width + Cell.X;
+			FVector Location = Grid.CellToWorld(Cell.X, Cell.Y);
+			Location.Z = CellHeights[CellIndex];
+
+			float BestDistanceSq = MAX_flt;
+			for (const FView& View : Views)
+			{
+				const FVector ToCell = Location - View.Location;
+				const float DistanceSq = ToCell.SizeSquared();
+				if (DistanceSq <= MaxDistanceSq && FVector::DotProduct(ToCell.GetSafeNormal(), View.Direction) >= View.CosHalfFOV)
+				{
+					BestDistanceSq = FMath::Min(BestDistanceSq, DistanceSq);
+				}
+			}
+			if (BestDistanceSq < MAX_flt)
+			{
+				Visible.Emplace(BestDistanceSq, CellIndex);
+			}
+		}
+		Visible.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+		Visible.SetNum(FMath::Min(Visible.Num(), MaxVisuals));
+	}
+
+	TSet<int32> Wanted;
+	for (const TPair<float, int32>& Entry : Visible)
+	{
+		Wanted.Add(Entry.Value);
+	}
+
+	// Free emitters whose cell went out or out of view, keep the ones that are still wanted where they are
+	for (int32 i = 0; i < FlamePool.Num(); i++)
+	{
+		if (FlamePoolCells[i] == INDEX_NONE)
+		{
+			continue;
+		}
+		if (Wanted.Remove(FlamePoolCells[i]) == 0)
+		{
+			FlamePool[i]->DeactivateSystem();
+			FlamePoolCells[i] = INDEX_NONE;
+		}
+	}
+
+	// Whatever is left in Wanted needs an emitter
+	for (const int32 CellIndex : Wanted)
+	{
+		int32 Slot = FlamePoolCells.Find(INDEX_NONE);
+		if (Slot == INDEX_NONE)
+		{
+			if (FlamePool.Num() >= MaxVisuals)
+			{
+				break;
+			}
+			UParticleSystemComponent* Flame = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), FlameTemplate, FVector::ZeroVector,
+				FRotator::ZeroRotator, FVector(1.0f), false, EPSCPoolMethod::None, false);
+			if (!Flame)
+			{
+				break;
+			}
+			Slot = FlamePool.Add(Flame);
+			FlamePoolCells.Add(INDEX_NONE);
+		}
+
+		FVector Location = Grid.CellToWorld(CellIndex % Width, CellIndex / Width);
+		Location.Z = CellHeights[CellIndex];
+		FlamePool[Slot]->SetWorldLocation(Location);
+		FlamePool[Slot]->ActivateSystem(true);
+		FlamePoolCells[Slot] = CellIndex;
+	}
+}
+
+TStatId USFireSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USFireSubsystem, STATGROUP_Tickables);
+}
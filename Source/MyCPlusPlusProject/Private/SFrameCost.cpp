@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SFrameCost.h"
+
+static TMap<FName, FSFrameCost::FEntry> GFrameCostEntries;
+
+void FSFrameCost::Add(FName Name, double Seconds)
+{
+	check(IsInGameThread());
+
+	FEntry& Entry = GFrameCostEntries.FindOrAdd(Name);
+	Entry.TotalSeconds += Seconds;
+	Entry.MaxSeconds = FMath::Max(Entry.MaxSeconds, Seconds);
+	Entry.Calls++;
+}
+
+void FSFrameCost::Reset()
+{
+	GFrameCostEntries.Reset();
+}
+
+void FSFrameCost::LogReport(int32 NumFrames)
+{
+	TArray<TPair<FName, FEntry>> Sorted;
+	for (const TPair<FName, FEntry>& Pair : GFrameCostEntries)
+	{
+		Sorted.Emplace(Pair.Key, Pair.Value);
+	}
+	Sorted.Sort([](const TPair<FName, FEntry>& A, const TPair<FName, FEntry>& B) { return A.Value.TotalSeconds > B.Value.TotalSeconds; });
+
+	const int32 Frames = FMath::Max(NumFrames, 1);
+	for (const TPair<FName, FEntry>& Pair : Sorted)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %-24s %7.3f ms/frame  max %7.3f ms  %d calls"), *Pair.Key.ToString(),
+			Pair.Value.TotalSeconds * 1000.0 / Frames, Pair.Value.MaxSeconds * 1000.0, Pair.Value.Calls);
+	}
+}
+
+const TMap<FName, FSFrameCost::FEntry>& FSFrameCost::GetEntries()
+{
+	return GFrameCostEntries;
+}
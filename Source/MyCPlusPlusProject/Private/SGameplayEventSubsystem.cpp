@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGameplayEventSubsystem.h"
+
+#include "SFrameCost.h"
+#include "SExplosiveBarrel.h"
+#include "SGameplayInterface.h"
+#include "SMemoryBudget.h"
+#include "SSaveGameSubsystem.h"
+
+void USGameplayEventSubsystem::Post(const FSGameplayEvent& Event)
+{
+	PendingEvents.Enqueue(Event);
+}
+
+void USGameplayEventSubsystem::Flush()
+{
+	check(IsInGameThread());
+
+	// Only what is queued right now, events posted by the handlers below wait for the next frame
+	FSGameplayEvent Event;
+	while (PendingEvents.Dequeue(Event))
+	{
+		TArray<FSGameplayEvent>& Batch = Batches[static_cast<int32>(Event.Type)];
+
+		// The same barrel or absorbed actor can be reported several times by one physics step. Events replayed from
+		// the server carry no source, each of them is a different explosion or absorption
+		const bool bHasSource = !Event.Source.IsExplicitlyNull();
+		if (bHasSource && (Event.Type == ESGameplayEventType::Explosion || Event.Type == ESGameplayEventType::Absorbed))
+		{
+			bool bDuplicate = false;
+			BatchedKeys.Add(MakeTuple(Event.Type, Event.Source, Event.Target), &bDuplicate);
+			if (bDuplicate)
+			{
+				continue;
+			}
+		}
+		Batch.Add(MoveTemp(Event));
+	}
+
+	BatchedKeys.Reset();
+
+	for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(ESGameplayEventType::Count); TypeIndex++)
+	{
+		TArray<FSGameplayEvent>& Batch = Batches[TypeIndex];
+		if (Batch.Num() == 0)
+		{
+			continue;
+		}
+
+		switch (static_cast<ESGameplayEventType>(TypeIndex))
+		{
+		case ESGameplayEventType::Interacted: HandleInteracted(Batch); break;
+		case ESGameplayEventType::Teleported: HandleTeleported(Batch); break;
+		case ESGameplayEventType::Absorbed: HandleAbsorbed(Batch); break;
+		case ESGameplayEventType::Explosion: HandleExplosion(Batch); break;
+		default: break;
+		}
+
+		Listeners[TypeIndex].Broadcast(Batch);
+		Batch.Reset();
+	}
+}
+
+void USGameplayEventSubsystem::HandleInteracted(TConstArrayView<FSGameplayEvent> Events)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Interaction);
+	for (const FSGameplayEvent& Event : Events)
+	{
+		AActor* Target = Event.Target.Get();
+		if (Target && Target->Implements<USGameplayInterface>())
+		{
+			ISGameplayInterface::Execute_Interact(Target, Cast<APawn>(Event.Source.Get()));
+		}
+	}
+}
+
+void USGameplayEventSubsystem::HandleTeleported(TConstArrayView<FSGameplayEvent> Events)
+{
+	for (const FSGameplayEvent& Event : Events)
+	{
+		if (AActor* Target = Event.Target.Get())
+		{
+			Target->TeleportTo(Event.Location, Event.Rotation, false, false);
+		}
+	}
+}
+
+void USGameplayEventSubsystem::HandleAbsorbed(TConstArrayView<FSGameplayEvent> Events)
+{
+	USSaveGameSubsystem* Save = GetWorld()->GetSubsystem<USSaveGameSubsystem>();
+	for (const FSGameplayEvent& Event : Events)
+	{
+		if (AActor* Target = Event.Target.Get())
+		{
+			if (Save)
+			{
+				Save->MarkChanged(Target, ESSaveFlags::Destroyed);
+			}
+			Target->Destroy();
+		}
+	}
+}
+
+void USGameplayEventSubsystem::HandleExplosion(TConstArrayView<FSGameplayEvent> Events)
+{
+	for (const FSGameplayEvent& Event : Events)
+	{
+		ASExplosiveBarrel* Barrel = Cast<ASExplosiveBarrel>(Event.Source.Get());
+		if (Barrel && !Barrel->HasExploded())
+		{
+			Barrel->Explode();
+			Barrel->Destroy();
+		}
+	}
+}
+
+void USGameplayEventSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("GameplayEvents");
+	Flush();
+}
+
+TStatId USGameplayEventSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGameplayEventSubsystem, STATGROUP_Tickables);
+}
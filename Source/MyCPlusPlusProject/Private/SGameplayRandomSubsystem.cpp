@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGameplayRandomSubsystem.h"
+
+void USGameplayRandomSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Replaced by the game mode on the server, clients keep this one for cosmetics
+	SetSeed(FPlatformTime::Cycles());
+}
+
+void USGameplayRandomSubsystem::SetSeed(int32 InSeed)
+{
+	Seed = InSeed;
+	Streams.Reset();
+}
+
+FRandomStream& USGameplayRandomSubsystem::GetStream(FName Name)
+{
+	check(IsInGameThread());
+
+	if (FRandomStream* Stream = Streams.Find(Name))
+	{
+		return *Stream;
+	}
+	return Streams.Add(Name, FRandomStream((int32)GetSubstreamKey(Name)));
+}
+
+FSCounterRandom USGameplayRandomSubsystem::GetCounterStream(FName Name) const
+{
+	return FSCounterRandom(GetSubstreamKey(Name));
+}
+
+uint32 USGameplayRandomSubsystem::GetSubstreamKey(FName Name) const
+{
+	// Hash of the text, FName hashes depend on the order names were created in and differ between runs
+	return FSCounterRandom::Hash((uint32)Seed, FCrc::StrCrc32(*Name.ToString()));
+}
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGameplayRegistrySubsystem.h"
+
+#include "Engine/Level.h"
+#include "Engine/StaticMeshActor.h"
+
+static FAutoConsoleCommandWithWorld RegistryStatsCommand(
+	TEXT("s.Registry.Stats"),
+	TEXT("Logs how many gameplay actors of each kind are resident, with memory use."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (const USGameplayRegistrySubsystem* Registry = World ? World->GetSubsystem<USGameplayRegistrySubsystem>() : nullptr)
+		{
+			Registry->LogStats(TEXT("Now"));
+		}
+	}));
+
+void USGameplayRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Streaming levels and World Partition cells both come and go through these
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &USGameplayRegistrySubsystem::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &USGameplayRegistrySubsystem::OnLevelRemoved);
+}
+
+void USGameplayRegistrySubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+
+	Super::Deinitialize();
+}
+
+void USGameplayRegistrySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Levels that were visible before we started listening, the persistent level at least
+	for (ULevel* Level : InWorld.GetLevels())
+	{
+		if (Level && Level->bIsVisible)
+		{
+			AddLevel(Level);
+		}
+	}
+
+	if (InWorld.IsGameWorld() && FParse::Value(FCommandLine::Get(), TEXT("LoadBenchmark="), BenchmarkTimeRemaining))
+	{
+		LogStats(TEXT("Begin play"));
+	}
+}
+
+void USGameplayRegistrySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Only ticks while a load benchmark is running
+	BenchmarkTimeRemaining -= DeltaTime;
+	if (BenchmarkTimeRemaining <= 0.0f)
+	{
+		LogStats(TEXT("Settled"));
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+TStatId USGameplayRegistrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGameplayRegistrySubsystem, STATGROUP_Tickables);
+}
+
+void USGameplayRegistrySubsystem::Register(AActor* Actor, ESRegistryKind Kind)
+{
+	if (Actor)
+	{
+		Actors[(int32)Kind].AddUnique(Actor);
+	}
+}
+
+void USGameplayRegistrySubsystem::Unregister(AActor* Actor, ESRegistryKind Kind)
+{
+	Actors[(int32)Kind].RemoveSingleSwap(Actor);
+}
+
+void USGameplayRegistrySubsystem::GetActorsInRadius(const FVector& Location, float Radius, TArray<AActor*>& OutActors,
+	std::initializer_list<ESRegistryKind> Kinds) const
+{
+	const float RadiusSq = FMath::Square(Radius);
+	for (ESRegistryKind Kind : Kinds)
+	{
+		for (const TWeakObjectPtr<AActor>& WeakActor : Actors[(int32)Kind])
+		{
+			AActor* Actor = WeakActor.Get();
+			if (Actor && FVector::DistSquared(Actor->GetActorLocation(), Location) <= RadiusSq)
+			{
+				OutActors.Add(Actor);
+			}
+		}
+	}
+}
+
+bool USGameplayRegistrySubsystem::IsPhysicsProp(const AActor* Actor)
+{
+	const AStaticMeshActor* MeshActor = Cast<AStaticMeshActor>(Actor);
+	const UStaticMeshComponent* Mesh = MeshActor ? MeshActor->GetStaticMeshComponent() : nullptr;
+	return Mesh && (Mesh->GetCollisionProfileName() == FName("PhysicsActor") || Mesh->BodyInstance.bSimulatePhysics);
+}
+
+void USGameplayRegistrySubsystem::AddLevel(ULevel* Level)
+{
+	for (AActor* Actor : Level->Actors)
+	{
+		if (IsPhysicsProp(Actor))
+		{
+			// Blackholes find the things they swallow through overlaps
+			Cast<AStaticMeshActor>(Actor)->GetStaticMeshComponent()->SetGenerateOverlapEvents(true);
+			Register(Actor, ESRegistryKind::PhysicsProp);
+		}
+	}
+}
+
+void USGameplayRegistrySubsystem::RemoveLevel(ULevel* Level)
+{
+	// Actors are gone or going, compare levels rather than dereferencing anything but the level pointer
+	Actors[(int32)ESRegistryKind::PhysicsProp].RemoveAllSwap([Level](const TWeakObjectPtr<AActor>& Actor)
+	{
+		return !Actor.IsValid() || Level == nullptr || Actor->GetLevel() == Level;
+	});
+}
+
+void USGameplayRegistrySubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld() && Level)
+	{
+		AddLevel(Level);
+	}
+}
+
+void USGameplayRegistrySubsystem::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	// A null level means every level of the world
+	if (World == GetWorld())
+	{
+		RemoveLevel(Level);
+	}
+}
+
+void USGameplayRegistrySubsystem::LogStats(const TCHAR* Label) const
+{
+	int32 NumLevels = 0;
+	for (const ULevel* Level : GetWorld()->GetLevels())
+	{
+		NumLevels += Level && Level->bIsVisible ? 1 : 0;
+	}
+
+	const FPlatformMemoryStats Memory = FPlatformMemory::GetStats();
+	UE_LOG(LogTemp, Display, TEXT("Registry [%s]: %.2f s since start, %.1f MB used, %d levels resident, %d barrels, %d chests, %d prop managers, %d physics props, %d pawns"),
+		Label, FPlatformTime::Seconds() - GStartTime, Memory.UsedPhysical / (1024.0 * 1024.0), NumLevels,
+		Num(ESRegistryKind::Barrel), Num(ESRegistryKind::Chest), Num(ESRegistryKind::PropManager), Num(ESRegistryKind::PhysicsProp), Num(ESRegistryKind::Pawn));
+}
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGameplaySettings.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/Paths.h"
+
+FSGameplayConstants USGameplaySettings::Constants;
+FSGameplayConstants USGameplaySettings::StartupConstants;
+bool USGameplaySettings::bStartupConstantsSet = false;
+FSimpleMulticastDelegate USGameplaySettings::OnConstantsChanged;
+
+static TAutoConsoleVariable<int32> CVarSettingsAutoReload(
+	TEXT("s.Settings.AutoReload"),
+	1,
+	TEXT("Apply changes to the gameplay tuning section of Config/DefaultGame.ini while the game runs."),
+	ECVF_Default);
+
+static FAutoConsoleCommand SettingsReloadCommand(
+	TEXT("s.Settings.Reload"),
+	TEXT("Reads the gameplay tuning section of Config/DefaultGame.ini again and applies it."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		GetMutableDefault<USGameplaySettings>()->ReloadFromFile();
+	}));
+
+void USGameplaySettings::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		UpdateConstants();
+	}
+}
+
+#if WITH_EDITOR
+void USGameplaySettings::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	UpdateConstants();
+}
+#endif
+
+const FSGameplayConstants& USGameplaySettings::GetStartupConstants()
+{
+	// Gameplay class defaults can be constructed before the settings, load them first
+	GetDefault<USGameplaySettings>();
+	return StartupConstants;
+}
+
+void USGameplaySettings::UpdateConstants()
+{
+	Constants.AimTraceLength = AimTraceLength;
+	Constants.PrimaryAttackCastTime = PrimaryAttackCastTime;
+	Constants.PrimaryAttackCooldown = PrimaryAttackCooldown;
+	Constants.SpecialAttackCastTime = SpecialAttackCastTime;
+	Constants.SpecialAttackCooldown = SpecialAttackCooldown;
+	Constants.InteractionRadius = InteractionRadius;
+	Constants.InteractionReach = InteractionReach;
+	Constants.BlackholeForceStrength = BlackholeForceStrength;
+	Constants.BlackholeMinRadius = FMath::Min(BlackholeMinRadius, BlackholeMaxRadius);
+	Constants.BlackholeMaxRadius = FMath::Max(BlackholeMinRadius, BlackholeMaxRadius);
+	Constants.BlackholePulseSpeed = BlackholePulseSpeed;
+	Constants.DashSpeed = DashSpeed;
+	Constants.BarrelExplosionRadius = BarrelExplosionRadius;
+	Constants.BarrelExplosionImpulse = BarrelExplosionImpulse;
+
+	if (!bStartupConstantsSet)
+	{
+		StartupConstants = Constants;
+		bStartupConstantsSet = true;
+	}
+
+	OnConstantsChanged.Broadcast();
+}
+
+FString USGameplaySettings::GetFilePath()
+{
+	return FPaths::Combine(FPaths::ProjectConfigDir(), TEXT("DefaultGame.ini"));
+}
+
+bool USGameplaySettings::ReloadFromFile()
+{
+	// Straight from disk, the config cache still holds what was read at startup
+	FConfigFile File;
+	File.Read(GetFilePath());
+
+	const FConfigSection* Section = File.Find(GetClass()->GetPathName());
+	if (!Section)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Settings: no [%s] in %s"), *GetClass()->GetPathName(), *GetFilePath());
+		return false;
+	}
+
+	int32 NumApplied = 0;
+	for (TFieldIterator<FProperty> It(GetClass()); It; ++It)
+	{
+		const FConfigValue* Value = It->HasAnyPropertyFlags(CPF_Config) ? Section->Find(It->GetFName()) : nullptr;
+		if (Value && It->ImportText_Direct(*Value->GetValue(), It->ContainerPtrToValuePtr<void>(this), this, PPF_None))
+		{
+			NumApplied++;
+		}
+	}
+
+	UpdateConstants();
+	UE_LOG(LogTemp, Display, TEXT("Settings: applied %d gameplay constants from %s"), NumApplied, *GetFilePath());
+	return true;
+}
+
+void USGameplaySettings::StartWatching()
+{
+#if !UE_BUILD_SHIPPING
+	if (WatchHandle.IsValid())
+	{
+		return;
+	}
+
+	WatchedTimeStamp = IFileManager::Get().GetTimeStamp(*GetFilePath());
+	WatchHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &USGameplaySettings::PollFile), 1.0f);
+#endif
+}
+
+void USGameplaySettings::StopWatching()
+{
+	if (WatchHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(WatchHandle);
+		WatchHandle.Reset();
+	}
+}
+
+bool USGameplaySettings::PollFile(float DeltaTime)
+{
+	if (CVarSettingsAutoReload.GetValueOnGameThread() == 0)
+	{
+		return true;
+	}
+
+	const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*GetFilePath());
+	if (TimeStamp != WatchedTimeStamp)
+	{
+		WatchedTimeStamp = TimeStamp;
+		ReloadFromFile();
+	}
+	return true;
+}
@@ -0,0 +1,278 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGravityWellSubsystem.h"
+
+#include "SFrameCost.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
+#include <atomic>
+
+static TAutoConsoleVariable<int32> CVarPhysicsAsyncWells(
+	TEXT("s.Physics.AsyncWells"),
+	1,
+	TEXT("Apply blackhole pulls on the physics thread at the fixed physics rate, 0 uses their radial force components."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs PhysicsFrameRateSweepCommand(
+	TEXT("s.Physics.FrameRateSweep"),
+	TEXT("Caps the frame rate at 30, 60 and 144 in turn and logs frame, game thread and physics step rates. Usage: s.Physics.FrameRateSweep [SecondsPerRate]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USGravityWellSubsystem* GravityWells = World ? World->GetSubsystem<USGravityWellSubsystem>() : nullptr)
+		{
+			GravityWells->StartFrameRateSweep(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 10.0f);
+		}
+	}));
+
+// Game thread to physics thread, one per game thread frame, used by every physics step of that frame
+struct FSGravityWellInput : public Chaos::FSimCallbackInput
+{
+	TArray<FSGravityWell> Wells;
+	TArray<FSingleParticlePhysicsProxy*> Bodies;
+
+	void Reset()
+	{
+		Wells.Reset();
+		Bodies.Reset();
+	}
+};
+
+class FSGravityWellCallback : public Chaos::TSimCallbackObject<FSGravityWellInput>
+{
+public:
+	std::atomic<int32> NumSteps { 0 };
+
+	virtual void OnPreSimulate_Internal() override
+	{
+		NumSteps++;
+
+		// No input when the game thread had no wells this frame
+		const FSGravityWellInput* Input = GetConsumerInput_Internal();
+		if (!Input)
+		{
+			return;
+		}
+
+		for (FSingleParticlePhysicsProxy* Proxy : Input->Bodies)
+		{
+			// Null once the body was removed from the solver since the game thread gathered it
+			Chaos::FRigidBodyHandle_Internal* Body = Proxy ? Proxy->GetPhysicsThreadAPI() : nullptr;
+			if (!Body || Body->ObjectState() == Chaos::EObjectStateType::Kinematic || Body->ObjectState() == Chaos::EObjectStateType::Static)
+			{
+				continue;
+			}
+
+			// Same as the radial force component's tick: constant falloff, a force so heavier bodies move less
+			FVector Force = FVector::ZeroVector;
+			for (const FSGravityWell& Well : Input->Wells)
+			{
+				const FVector Delta = FVector(Body->X()) - Well.Center;
+				if (Delta.SizeSquared() <= FMath::Square(Well.Radius))
+				{
+					Force += Delta.GetSafeNormal() * Well.Strength;
+				}
+			}
+
+			if (!Force.IsNearlyZero())
+			{
+				if (Body->ObjectState() == Chaos::EObjectStateType::Sleeping)
+				{
+					Body->SetObjectState(Chaos::EObjectStateType::Dynamic);
+				}
+				Body->AddForce(Force);
+			}
+		}
+	}
+};
+
+bool USGravityWellSubsystem::IsEnabled()
+{
+	return CVarPhysicsAsyncWells.GetValueOnGameThread() != 0;
+}
+
+void USGravityWellSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (FPhysScene* Scene = InWorld.GetPhysicsScene())
+	{
+		Callback = Scene->GetSolver()->CreateAndRegisterSimCallbackObject_External<FSGravityWellCallback>();
+	}
+}
+
+void USGravityWellSubsystem::Deinitialize()
+{
+	EndSweep();
+
+	// Without a scene the solver is already gone and freed the callback with it
+	FPhysScene* Scene = GetWorld()->GetPhysicsScene();
+	if (Callback && Scene)
+	{
+		Scene->GetSolver()->UnregisterAndFreeSimCallbackObject_External(Callback);
+	}
+	Callback = nullptr;
+	Wells.Reset();
+
+	Super::Deinitialize();
+}
+
+void USGravityWellSubsystem::SetWell(const UObject* Owner, const FSGravityWell& Well)
+{
+	Wells.Add(Owner, Well);
+}
+
+void USGravityWellSubsystem::RemoveWell(const UObject* Owner)
+{
+	Wells.Remove(Owner);
+}
+
+int32 USGravityWellSubsystem::GetNumPhysicsSteps() const
+{
+	return Callback ? Callback->NumSteps.load() : 0;
+}
+
+void USGravityWellSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SendWells();
+	TickSweep();
+}
+
+TStatId USGravityWellSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USGravityWellSubsystem, STATGROUP_Tickables);
+}
+
+void USGravityWellSubsystem::SendWells()
+{
+	if (!Callback || Wells.Num() == 0 || !IsEnabled())
+	{
+		return;
+	}
+
+	S_SCOPED_FRAME_COST("GravityWells");
+
+	const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>();
+	if (!Registry)
+	{
+		return;
+	}
+
+	FSGravityWellInput* Input = Callback->GetProducerInputData_External();
+	Input->Reset();
+
+	// Bodies in more than one well are sent once, the physics thread sums the wells for each
+	TSet<FSingleParticlePhysicsProxy*> Seen;
+	TArray<AActor*> Nearby;
+	for (const TPair<TObjectKey<UObject>, FSGravityWell>& Pair : Wells)
+	{
+		const FSGravityWell& Well = Pair.Value;
+		Input->Wells.Add(Well);
+
+		Nearby.Reset();
+		Registry->GetActorsInRadius(Well.Center, Well.Radius, Nearby, { ESRegistryKind::Barrel, ESRegistryKind::PhysicsProp });
+		for (AActor* Actor : Nearby)
+		{
+			UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>(Actor->GetRootComponent());
+			if (!Primitive || !Primitive->IsSimulatingPhysics())
+			{
+				continue;
+			}
+
+			FSingleParticlePhysicsProxy* Proxy = Primitive->GetBodyInstance()->GetPhysicsActorHandle();
+			bool bAlreadySeen = true;
+			if (Proxy)
+			{
+				Seen.Add(Proxy, &bAlreadySeen);
+			}
+			if (!bAlreadySeen)
+			{
+				Input->Bodies.Add(Proxy);
+			}
+		}
+	}
+}
+
+void USGravityWellSubsystem::StartFrameRateSweep(float SecondsPerRate)
+{
+	IConsoleVariable* MaxFPS = IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS"));
+	if (!MaxFPS)
+	{
+		return;
+	}
+
+	EndSweep();
+
+	SweepRates = { 30.0f, 60.0f, 144.0f };
+	SweepSecondsPerRate = FMath::Max(SecondsPerRate, 1.0f);
+	SweepSavedMaxFPS = MaxFPS->GetFloat();
+
+	UE_LOG(LogTemp, Display, TEXT("Physics: frame rate sweep, %.0f seconds per rate, %d gravity wells, async wells %s"),
+		SweepSecondsPerRate, Wells.Num(), IsEnabled() ? TEXT("on") : TEXT("off"));
+	BeginSweepRate(0);
+}
+
+void USGravityWellSubsystem::BeginSweepRate(int32 Index)
+{
+	SweepIndex = Index;
+	SweepTimeRemaining = SweepSecondsPerRate;
+	SweepFrames = 0;
+	SweepFrameSeconds = 0.0;
+	SweepGameThreadSeconds = 0.0;
+	SweepStartSteps = GetNumPhysicsSteps();
+
+	IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS"))->Set(SweepRates[Index], ECVF_SetByConsole);
+}
+
+void USGravityWellSubsystem::TickSweep()
+{
+	if (SweepIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Real frame time, not the clamped or dilated game delta
+	const double FrameSeconds = FApp::GetDeltaTime();
+	SweepFrames++;
+	SweepFrameSeconds += FrameSeconds;
+	SweepGameThreadSeconds += FPlatformTime::ToSeconds(GGameThreadTime);
+
+	SweepTimeRemaining -= FrameSeconds;
+	if (SweepTimeRemaining > 0.0f)
+	{
+		return;
+	}
+
+	// A fixed physics rate shows as the same steps per second at every frame rate
+	const double StepsPerSecond = (GetNumPhysicsSteps() - SweepStartSteps) / FMath::Max(SweepFrameSeconds, UE_DOUBLE_SMALL_NUMBER);
+	UE_LOG(LogTemp, Display, TEXT("Physics: cap %3.0f FPS, frame %.2f ms, game thread %.2f ms, %.1f physics steps/s"),
+		SweepRates[SweepIndex], SweepFrameSeconds * 1000.0 / SweepFrames, SweepGameThreadSeconds * 1000.0 / SweepFrames, StepsPerSecond);
+
+	if (SweepRates.IsValidIndex(SweepIndex + 1))
+	{
+		BeginSweepRate(SweepIndex + 1);
+	}
+	else
+	{
+		EndSweep();
+	}
+}
+
+void USGravityWellSubsystem::EndSweep()
+{
+	if (SweepIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	SweepIndex = INDEX_NONE;
+	IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS"))->Set(SweepSavedMaxFPS, ECVF_SetByConsole);
+}
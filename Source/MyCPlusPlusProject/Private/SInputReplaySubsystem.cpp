@@ -0,0 +1,437 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SInputReplaySubsystem.h"
+
+#include "SCharacter.h"
+#include "SGameplayRandomSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "HAL/PlatformFileManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayRecordCommand(
+	TEXT("s.Replay.Record"),
+	TEXT("Reloads the map and records the local players' input to a file. Usage: s.Replay.Record <File>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USInputReplaySubsystem* Replay = World ? World->GetSubsystem<USInputReplaySubsystem>() : nullptr)
+		{
+			Replay->RestartRecording(Args.Num() > 0 ? Args[0] : TEXT("Session.srpl"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayPlayCommand(
+	TEXT("s.Replay.Play"),
+	TEXT("Reloads the map and plays back recorded input, optionally from a given frame. Usage: s.Replay.Play <File> [Frame]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USInputReplaySubsystem* Replay = World ? World->GetSubsystem<USInputReplaySubsystem>() : nullptr)
+		{
+			Replay->RestartReplay(Args.Num() > 0 ? Args[0] : TEXT("Session.srpl"), Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 0);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs ReplaySeekCommand(
+	TEXT("s.Replay.Seek"),
+	TEXT("Brings the running replay to a recorded frame. Usage: s.Replay.Seek <Frame>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		USInputReplaySubsystem* Replay = World ? World->GetSubsystem<USInputReplaySubsystem>() : nullptr;
+		if (Replay && Args.Num() > 0)
+		{
+			Replay->SeekReplay(FCString::Atoi(*Args[0]));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld ReplayStopCommand(
+	TEXT("s.Replay.Stop"),
+	TEXT("Stops recording or playing back input."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (USInputReplaySubsystem* Replay = World ? World->GetSubsystem<USInputReplaySubsystem>() : nullptr)
+		{
+			Replay->Stop();
+		}
+	}));
+
+void USInputReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (!InWorld.IsGameWorld())
+	{
+		return;
+	}
+
+	// Options left on the URL by a restart come first, then the command line
+	if (const TCHAR* ReplayOption = InWorld.URL.GetOption(TEXT("ReplayInput="), nullptr))
+	{
+		bExitWhenDone = InWorld.URL.HasOption(TEXT("ReplayExit"));
+		const TCHAR* SeekOption = InWorld.URL.GetOption(TEXT("ReplaySeek="), nullptr);
+		if (StartReplay(ReplayOption) && SeekOption)
+		{
+			SeekReplay(FCString::Atoi(SeekOption));
+		}
+		return;
+	}
+	if (const TCHAR* RecordOption = InWorld.URL.GetOption(TEXT("RecordInput="), nullptr))
+	{
+		StartRecording(RecordOption);
+		return;
+	}
+
+	FString FileName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ReplayInput="), FileName))
+	{
+		bExitWhenDone = true;
+		StartReplay(FileName);
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("RecordInput="), FileName))
+	{
+		StartRecording(FileName);
+	}
+}
+
+void USInputReplaySubsystem::Deinitialize()
+{
+	Stop();
+	Super::Deinitialize();
+}
+
+FString USInputReplaySubsystem::ResolvePath(const FString& FileName)
+{
+	return FPaths::IsRelative(FileName) ? FPaths::ProjectSavedDir() / TEXT("Replays") / FileName : FileName;
+}
+
+bool USInputReplaySubsystem::StartRecording(const FString& FileName)
+{
+	Stop();
+
+	const FString Path = ResolvePath(FileName);
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Replay: can't write %s"), *Path);
+		return false;
+	}
+
+	// Restart the gameplay random streams so the recording and its replays draw the same numbers from here on
+	USGameplayRandomSubsystem* Random = GetWorld()->GetSubsystem<USGameplayRandomSubsystem>();
+	Random->SetSeed(Random->GetSeed());
+
+	// Split screen players are recorded too, each one's input after the other's in every frame
+	const UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	int32 NumPlayers = FMath::Max(GameInstance ? GameInstance->GetNumLocalPlayers() : 1, 1);
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	int32 Seed = Random->GetSeed();
+	int32 FrameSize = sizeof(float) + NumPlayers * FSInputFrame::SerializedSize;
+	*Writer << Magic << Version << Seed << NumPlayers << FrameSize;
+
+	RecordDeltaTime = 0.0f;
+	RecordFrames.Init(FSInputFrame(), NumPlayers);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USInputReplaySubsystem::OnWorldPostActorTick);
+
+	UE_LOG(LogTemp, Display, TEXT("Replay: recording %d local players to %s, seed %d"), NumPlayers, *Path, Seed);
+	return true;
+}
+
+bool USInputReplaySubsystem::StartReplay(const FString& FileName)
+{
+	Stop();
+
+	const FString Path = ResolvePath(FileName);
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (MappedFile)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+	if (!MappedRegion || MappedRegion->GetMappedSize() < HeaderSize)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Replay: can't map %s"), *Path);
+		Stop();
+		return false;
+	}
+
+	uint32 Header[5];
+	FMemory::Memcpy(Header, MappedRegion->GetMappedPtr(), HeaderSize);
+	const int32 NumPlayers = (int32)Header[3];
+	if (Header[0] != FileMagic || Header[1] != FileVersion || NumPlayers <= 0 || NumPlayers > 8
+		|| Header[4] != sizeof(float) + NumPlayers * FSInputFrame::SerializedSize)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Replay: %s is not a version %u input recording"), *Path, FileVersion);
+		Stop();
+		return false;
+	}
+
+	const UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	const int32 NumLocalPlayers = GameInstance ? GameInstance->GetNumLocalPlayers() : 0;
+	if (NumLocalPlayers < NumPlayers)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Replay: %s has %d local players, only %d are playing"), *Path, NumPlayers, NumLocalPlayers);
+	}
+
+	GetWorld()->GetSubsystem<USGameplayRandomSubsystem>()->SetSeed((int32)Header[2]);
+	ReplayFileName = FileName;
+	NumReplayPlayers = NumPlayers;
+	ReplayFrameSize = (int32)Header[4];
+	NumReplayFrames = int32((MappedRegion->GetMappedSize() - HeaderSize) / ReplayFrameSize);
+	ReplayFrameIndex = 0;
+	ReplayStartTime = FPlatformTime::Seconds();
+
+	// Recorded delta times replace the real ones, the engine ticks as fast as it can. The engine's own settings are
+	// put back when the replay stops
+	bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+	SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &USInputReplaySubsystem::OnBeginFrame);
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &USInputReplaySubsystem::OnWorldTickStart);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USInputReplaySubsystem::OnWorldPostActorTick);
+
+	UE_LOG(LogTemp, Display, TEXT("Replay: playing %s, %d frames, seed %d"), *Path, NumReplayFrames, (int32)Header[2]);
+	return true;
+}
+
+void USInputReplaySubsystem::Stop()
+{
+	// Only a replay that got going took over the engine's time step
+	const bool bWasPlaying = BeginFrameHandle.IsValid();
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	BeginFrameHandle.Reset();
+	WorldTickStartHandle.Reset();
+	PostActorTickHandle.Reset();
+
+	if (Writer)
+	{
+		Writer->Close();
+		Writer.Reset();
+		UE_LOG(LogTemp, Display, TEXT("Replay: recording stopped"));
+	}
+
+	if (MappedRegion)
+	{
+		const double Elapsed = FPlatformTime::Seconds() - ReplayStartTime;
+		UE_LOG(LogTemp, Display, TEXT("Replay: %d frames in %.2f s, %.2f ms/frame"),
+			ReplayFrameIndex, Elapsed, ReplayFrameIndex > 0 ? Elapsed * 1000.0 / ReplayFrameIndex : 0.0);
+
+		if (bWasPlaying)
+		{
+			FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+			FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		}
+
+		if (SeekFrame != INDEX_NONE)
+		{
+			SeekFrame = INDEX_NONE;
+			SetWorldRendering(true);
+		}
+
+		if (bExitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	NumReplayFrames = 0;
+	NumReplayPlayers = 0;
+}
+
+void USInputReplaySubsystem::ReloadMap(const FString& Options)
+{
+	const FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName());
+	UGameplayStatics::OpenLevel(GetWorld(), FName(*MapName), true, Options);
+}
+
+void USInputReplaySubsystem::RestartRecording(const FString& FileName)
+{
+	Stop();
+	ReloadMap(FString::Printf(TEXT("RecordInput=%s"), *FileName));
+}
+
+void USInputReplaySubsystem::RestartReplay(const FString& FileName, int32 Frame)
+{
+	FString Options = FString::Printf(TEXT("ReplayInput=%s"), *FileName);
+	if (Frame > 0)
+	{
+		Options += FString::Printf(TEXT("?ReplaySeek=%d"), Frame);
+	}
+
+	// This world ends with the reload, the replay in the next one quits when it is done
+	if (bExitWhenDone)
+	{
+		Options += TEXT("?ReplayExit");
+		bExitWhenDone = false;
+	}
+
+	Stop();
+	ReloadMap(Options);
+}
+
+void USInputReplaySubsystem::SeekReplay(int32 Frame)
+{
+	if (!IsReplaying())
+	{
+		return;
+	}
+
+	// The world can't go back in time, start over and simulate up to the frame
+	Frame = FMath::Clamp(Frame, 0, NumReplayFrames);
+	if (Frame < ReplayFrameIndex)
+	{
+		RestartReplay(ReplayFileName, Frame);
+		return;
+	}
+
+	if (Frame > ReplayFrameIndex)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Replay: seeking from frame %d to %d"), ReplayFrameIndex, Frame);
+		SeekFrame = Frame;
+		SetWorldRendering(false);
+	}
+}
+
+void USInputReplaySubsystem::SetWorldRendering(bool bEnabled)
+{
+	// Frames skipped over by a seek are simulated but not drawn
+	if (UGameViewportClient* Viewport = GetWorld()->GetGameViewport())
+	{
+		Viewport->bDisableWorldRendering = !bEnabled;
+	}
+}
+
+void USInputReplaySubsystem::RecordAxis(const ASCharacter* Character, ESInputAxis Axis, float Value)
+{
+	const int32 PlayerIndex = GetLocalPlayerIndex(Character);
+	if (RecordFrames.IsValidIndex(PlayerIndex))
+	{
+		RecordFrames[PlayerIndex].Axes[(int32)Axis] += Value;
+	}
+}
+
+void USInputReplaySubsystem::RecordAction(const ASCharacter* Character, ESInputAction Action)
+{
+	const int32 PlayerIndex = GetLocalPlayerIndex(Character);
+	if (RecordFrames.IsValidIndex(PlayerIndex))
+	{
+		RecordFrames[PlayerIndex].Actions |= 1 << (int32)Action;
+	}
+}
+
+ASCharacter* USInputReplaySubsystem::GetLocalCharacter(int32 PlayerIndex) const
+{
+	const UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	const ULocalPlayer* Player = GameInstance ? GameInstance->GetLocalPlayerByIndex(PlayerIndex) : nullptr;
+	const APlayerController* PC = Player ? Player->GetPlayerController(GetWorld()) : nullptr;
+	return PC ? Cast<ASCharacter>(PC->GetPawn()) : nullptr;
+}
+
+int32 USInputReplaySubsystem::GetLocalPlayerIndex(const ASCharacter* Character) const
+{
+	const UGameInstance* GameInstance = GetWorld()->GetGameInstance();
+	const int32 NumPlayers = GameInstance ? GameInstance->GetNumLocalPlayers() : 0;
+	for (int32 PlayerIndex = 0; PlayerIndex < NumPlayers; PlayerIndex++)
+	{
+		if (GetLocalCharacter(PlayerIndex) == Character)
+		{
+			return PlayerIndex;
+		}
+	}
+	return INDEX_NONE;
+}
+
+float USInputReplaySubsystem::ReadDeltaTime(int32 Frame) const
+{
+	float DeltaTime;
+	FMemory::Memcpy(&DeltaTime, MappedRegion->GetMappedPtr() + HeaderSize + int64(Frame) * ReplayFrameSize, sizeof(float));
+	return DeltaTime;
+}
+
+FSInputFrame USInputReplaySubsystem::ReadFrame(int32 Frame, int32 PlayerIndex) const
+{
+	const uint8* Data = MappedRegion->GetMappedPtr() + HeaderSize + int64(Frame) * ReplayFrameSize + sizeof(float)
+		+ PlayerIndex * FSInputFrame::SerializedSize;
+
+	FSInputFrame Result;
+	FMemory::Memcpy(Result.Axes, Data, sizeof(Result.Axes));
+	Result.Actions = Data[FSInputFrame::SerializedSize - 1];
+	return Result;
+}
+
+void USInputReplaySubsystem::WriteFrame()
+{
+	*Writer << RecordDeltaTime;
+	for (FSInputFrame& Frame : RecordFrames)
+	{
+		for (float& Axis : Frame.Axes)
+		{
+			*Writer << Axis;
+		}
+		*Writer << Frame.Actions;
+	}
+}
+
+void USInputReplaySubsystem::OnBeginFrame()
+{
+	// Before the engine updates its clock, the frame about to run uses the recorded delta time
+	if (ReplayFrameIndex < NumReplayFrames)
+	{
+		FApp::SetFixedDeltaTime(ReadDeltaTime(ReplayFrameIndex));
+	}
+}
+
+void USInputReplaySubsystem::OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld() || ReplayFrameIndex >= NumReplayFrames)
+	{
+		return;
+	}
+
+	// Before any actor ticks, like input processed by the player controllers
+	for (int32 PlayerIndex = 0; PlayerIndex < NumReplayPlayers; PlayerIndex++)
+	{
+		if (ASCharacter* Character = GetLocalCharacter(PlayerIndex))
+		{
+			Character->ApplyInputFrame(ReadFrame(ReplayFrameIndex, PlayerIndex));
+		}
+	}
+}
+
+void USInputReplaySubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	if (IsRecording())
+	{
+		RecordDeltaTime = FApp::GetDeltaTime();
+		WriteFrame();
+		RecordFrames.Init(FSInputFrame(), RecordFrames.Num());
+	}
+	else if (IsReplaying())
+	{
+		ReplayFrameIndex++;
+		if (IsSeeking() && ReplayFrameIndex >= SeekFrame)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Replay: reached frame %d"), ReplayFrameIndex);
+			SeekFrame = INDEX_NONE;
+			SetWorldRendering(true);
+		}
+
+		if (ReplayFrameIndex >= NumReplayFrames)
+		{
+			Stop();
+		}
+	}
+}
@@ -3,7 +3,12 @@
 
 #include "SInteractionComponent.h"
 
+#include "SGameplayEventSubsystem.h"
 #include "SGameplayInterface.h"
+#include "SGameplaySettings.h"
+#include "SMemoryBudget.h"
+#include "SPropInstanceManager.h"
+#include "SQueryBatchSubsystem.h"
 
 void USInteractionComponent::PrimaryInteract()
 {
@@ -15,30 +20,76 @@ void USInteractionComponent::PrimaryInteract()
 	FVector EyeLocation;
 	FRotator EyeRotation;
 	MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
-	FVector End = EyeLocation + (EyeRotation.Vector() * 1000);
+	const FSGameplayConstants& Constants = USGameplaySettings::GetConstants();
+	FVector End = EyeLocation + (EyeRotation.Vector() * Constants.InteractionReach);
 
 	// FHitResult Hit;
 	// bool bBlockingHit = GetWorld()->LineTraceSingleByObjectType(Hit, EyeLocation, End, ObjectQueryParams);
 
-	TArray<FHitResult> Hits;
-	float SphereRadius = 50.0f;
-	bool bBlockingHit = GetWorld()->SweepMultiByObjectType(Hits, EyeLocation, End, FQuat::Identity, ObjectQueryParams, FCollisionShape::MakeSphere(SphereRadius));
+	FSBatchedQuery Query;
+	Query.Type = ESBatchedQueryType::Sweep;
+	Query.Start = EyeLocation;
+	Query.End = End;
+	Query.Radius = Constants.InteractionRadius;
+	Query.ObjectTypes = ObjectQueryParams;
+	Query.Ignore = MyOwner;
+
+	// Swept together with everyone else's queries, interaction happens when the hits come back next frame
+	if (USQueryBatchSubsystem* QueryBatch = GetWorld()->GetSubsystem<USQueryBatchSubsystem>())
+	{
+		TWeakObjectPtr<USInteractionComponent> WeakThis(this);
+		QueryBatch->Request(Query, [WeakThis, EyeLocation, End](TConstArrayView<FHitResult> Hits)
+		{
+			if (WeakThis.IsValid() && WeakThis->GetOwner())
+			{
+				WeakThis->InteractWithHits(Hits, EyeLocation, End);
+			}
+		});
+	}
+}
+
+void USInteractionComponent::InteractWithHits(TConstArrayView<FHitResult> Hits, const FVector& Start, const FVector& End)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Interaction);
+
+	AActor* MyOwner = GetOwner();
+	bool bBlockingHit = Hits.Num() > 0;
 	FColor LineColor = bBlockingHit ? FColor::Green : FColor::Red;
 	
-	for (FHitResult& Hit : Hits)
+	for (const FHitResult& Hit : Hits)
 	{
-		if (AActor* HitActor = Hit.GetActor())
+		AActor* HitActor = Hit.GetActor();
+
+		// Dormant chests are instances, turn the one we hit into a real chest before interacting
+		if (ASPropInstanceManager* PropManager = Cast<ASPropInstanceManager>(HitActor))
+		{
+			HitActor = PropManager->PromoteInteractableFromHit(Hit);
+		}
+
+		if (HitActor)
 		{
-			DrawDebugSphere(GetWorld(),Hit.ImpactPoint, SphereRadius, 32,LineColor, false, 1.5f, 0, 0.2f);
+			DrawDebugSphere(GetWorld(),Hit.ImpactPoint, USGameplaySettings::GetConstants().InteractionRadius, 32,LineColor, false, 1.5f, 0, 0.2f);
 			if (HitActor->Implements<USGameplayInterface>())
 			{
 				APawn* MyPawn = Cast<APawn>(MyOwner);
-				ISGameplayInterface::Execute_Interact(HitActor, MyPawn);
+				if (USGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<USGameplayEventSubsystem>())
+				{
+					FSGameplayEvent Event;
+					Event.Type = ESGameplayEventType::Interacted;
+					Event.Source = MyPawn;
+					Event.Target = HitActor;
+					Event.Location = Hit.ImpactPoint;
+					Events->Post(Event);
+				}
+				else
+				{
+					ISGameplayInterface::Execute_Interact(HitActor, MyPawn);
+				}
 				break;
 			}
 		}
 	}
-	DrawDebugLine(GetWorld(), EyeLocation, End, LineColor, false, 2.0f, 0, 1.0f);
+	DrawDebugLine(GetWorld(), Start, End, LineColor, false, 2.0f, 0, 1.0f);
 }
 
 // Sets default values for this component's properties
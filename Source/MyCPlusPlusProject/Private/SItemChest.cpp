@@ -3,9 +3,39 @@
 
 #include "SItemChest.h"
 
+#include "SGameplayRegistrySubsystem.h"
+#include "SSaveGameSubsystem.h"
+
 void ASItemChest::Interact_Implementation(APawn* InstigatorPawn)
+{
+	USLootSubsystem* LootSubsystem = GetWorld()->GetSubsystem<USLootSubsystem>();
+	if (bIsOpen)
+	{
+		if (LootSubsystem && Loot.Num() > 0)
+		{
+			LootSubsystem->PickUp(Loot, InstigatorPawn);
+			Loot = TArrayView<FSLootItem>();
+		}
+		return;
+	}
+
+	SetOpen();
+
+	if (LootSubsystem)
+	{
+		Loot = LootSubsystem->RollLoot(LootTable);
+	}
+
+	if (USSaveGameSubsystem* Save = GetWorld()->GetSubsystem<USSaveGameSubsystem>())
+	{
+		Save->MarkChanged(this, ESSaveFlags::Opened);
+	}
+}
+
+void ASItemChest::SetOpen()
 {
 	LidMesh->SetRelativeRotation(FRotator(TargetPitch, 0, 0));
+	bIsOpen = true;
 }
 
 // Sets default values
@@ -21,13 +51,25 @@ ASItemChest::ASItemChest()
 	LidMesh->SetupAttachment(BasicMesh);
 
 	TargetPitch = 110;
+	LootTable = nullptr;
 }
 
 // Called when the game starts or when spawned
 void ASItemChest::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>()->Register(this, ESRegistryKind::Chest);
+}
+
+void ASItemChest::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>())
+	{
+		Registry->Unregister(this, ESRegistryKind::Chest);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SLootSubsystem.h"
+
+#include "SCharacter.h"
+#include "SGameplayRandomSubsystem.h"
+#include "SLootTable.h"
+#include "SMemoryBudget.h"
+
+static FAutoConsoleCommandWithWorldAndArgs LootBenchmarkCommand(
+	TEXT("s.Loot.Benchmark"),
+	TEXT("Times rolling loot for many chests. Usage: s.Loot.Benchmark [Chests] [Entries]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USLootSubsystem* Loot = World ? World->GetSubsystem<USLootSubsystem>() : nullptr)
+		{
+			Loot->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10000, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 256);
+		}
+	}));
+
+TArrayView<FSLootItem> USLootSubsystem::RollLoot(const USLootTable* Table, FRandomStream& Random, FMemStackBase& InArena)
+{
+	const FSAliasTable& AliasTable = Table->GetAliasTable();
+	if (Table->Rolls <= 0 || AliasTable.Num() == 0)
+	{
+		return TArrayView<FSLootItem>();
+	}
+
+	FSLootItem* Items = (FSLootItem*)InArena.PushBytes(sizeof(FSLootItem) * Table->Rolls, alignof(FSLootItem));
+	for (int32 i = 0; i < Table->Rolls; i++)
+	{
+		const float ColumnFraction = Random.GetFraction();
+		const float CoinFraction = Random.GetFraction();
+		const FSLootEntry& Entry = Table->Entries[AliasTable.Sample(ColumnFraction, CoinFraction)];
+
+		new (&Items[i]) FSLootItem{ Entry.ItemId, Entry.MinCount < Entry.MaxCount ? Random.RandRange(Entry.MinCount, Entry.MaxCount) : Entry.MinCount };
+	}
+	return TArrayView<FSLootItem>(Items, Table->Rolls);
+}
+
+TArrayView<FSLootItem> USLootSubsystem::RollLoot(const USLootTable* Table)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Interaction);
+	if (!Table)
+	{
+		return TArrayView<FSLootItem>();
+	}
+
+	// Own substream, loot doesn't shift the numbers other systems get
+	FRandomStream& Random = GetWorld()->GetSubsystem<USGameplayRandomSubsystem>()->GetStream(TEXT("Loot"));
+	TArrayView<FSLootItem> Items = RollLoot(Table, Random, Arena);
+	NumRolledItems += Items.Num();
+	return Items;
+}
+
+void USLootSubsystem::PickUp(TArrayView<FSLootItem> Items, APawn* Pawn)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Interaction);
+	ASCharacter* Character = Cast<ASCharacter>(Pawn);
+	for (const FSLootItem& RolledItem : Items)
+	{
+		USLootItem* Item = NewObject<USLootItem>(Pawn ? (UObject*)Pawn : (UObject*)this);
+		Item->ItemId = RolledItem.ItemId;
+		Item->Count = RolledItem.Count;
+
+		if (Character)
+		{
+			Character->AddToInventory(Item);
+		}
+		UE_LOG(LogTemp, Log, TEXT("%s picked up %d x %s"), *GetNameSafe(Pawn), Item->Count, *Item->ItemId.ToString());
+	}
+}
+
+void USLootSubsystem::RunBenchmark(int32 NumChests, int32 NumEntries)
+{
+	NumChests = FMath::Max(NumChests, 1);
+	NumEntries = FMath::Max(NumEntries, 1);
+
+	// Synthetic table with uneven weights, a long tail of rare items like a real one
+	USLootTable* Table = NewObject<USLootTable>(this);
+	Table->Entries.SetNum(NumEntries);
+	for (int32 i = 0; i < NumEntries; i++)
+	{
+		Table->Entries[i].ItemId = FName(TEXT("Item"), i + 1);
+		Table->Entries[i].Weight = 1.0f / (i + 1);
+		Table->Entries[i].MaxCount = 3;
+	}
+
+	const double CompileStartTime = FPlatformTime::Seconds();
+	Table->Compile();
+	const double CompileTime = FPlatformTime::Seconds() - CompileStartTime;
+
+	// Scratch arena and stream, the world's loot and numbers are left alone
+	FMemStackBase BenchmarkArena(0);
+	FRandomStream Random(NumChests);
+	int32 NumItems = 0;
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Chest = 0; Chest < NumChests; Chest++)
+	{
+		NumItems += RollLoot(Table, Random, BenchmarkArena).Num();
+	}
+	const double RollTime = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_DOUBLE_SMALL_NUMBER);
+
+	UE_LOG(LogTemp, Display, TEXT("Loot benchmark: %d chests, %d items from %d entries (compiled in %.3f ms): %.2f ms, %.1f M draws/s, %.1f bytes per item in the arena (a USLootItem is %d bytes before UObject bookkeeping)"),
+		NumChests, NumItems, NumEntries, CompileTime * 1000.0, RollTime * 1000.0, NumItems / RollTime / 1e6,
+		NumItems > 0 ? double(BenchmarkArena.GetByteCount()) / NumItems : 0.0, USLootItem::StaticClass()->GetStructureSize());
+	UE_LOG(LogTemp, Display, TEXT("Loot: %d items rolled in this world, %lld bytes of arena"), NumRolledItems, GetArenaBytes());
+}
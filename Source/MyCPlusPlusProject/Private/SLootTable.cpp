@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SLootTable.h"
+
+void FSAliasTable::Build(TConstArrayView<float> Weights)
+{
+	double Total = 0.0;
+	for (float Weight : Weights)
+	{
+		Total += FMath::Max(Weight, 0.0f);
+	}
+	if (Total <= 0.0)
+	{
+		// Nothing can be drawn, an empty table rolls nothing instead of every entry alike
+		Probability.Reset();
+		Alias.Reset();
+		return;
+	}
+
+	const int32 Num = Weights.Num();
+	Probability.SetNumUninitialized(Num);
+	Alias.SetNumUninitialized(Num);
+
+	// Vose: scale weights so the average is 1, then pair every column below 1 with one above to fill it up
+	TArray<double> Scaled;
+	Scaled.SetNumUninitialized(Num);
+	TArray<int32> Small;
+	TArray<int32> Large;
+	for (int32 i = 0; i < Num; i++)
+	{
+		Scaled[i] = FMath::Max(Weights[i], 0.0f) * Num / Total;
+		(Scaled[i] < 1.0 ? Small : Large).Add(i);
+	}
+
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Less = Small.Pop(false);
+		const int32 More = Large.Pop(false);
+
+		Probability[Less] = (float)Scaled[Less];
+		Alias[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.0;
+		(Scaled[More] < 1.0 ? Small : Large).Add(More);
+	}
+
+	// Whatever is left is 1 up to rounding
+	for (int32 i : Large)
+	{
+		Probability[i] = 1.0f;
+		Alias[i] = i;
+	}
+	for (int32 i : Small)
+	{
+		Probability[i] = 1.0f;
+		Alias[i] = i;
+	}
+}
+
+void USLootTable::PostLoad()
+{
+	Super::PostLoad();
+
+	Compile();
+}
+
+#if WITH_EDITOR
+void USLootTable::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	Compile();
+}
+#endif
+
+void USLootTable::Compile()
+{
+	TArray<float> Weights;
+	Weights.Reserve(Entries.Num());
+	for (const FSLootEntry& Entry : Entries)
+	{
+		Weights.Add(Entry.Weight);
+	}
+	AliasTable.Build(Weights);
+}
@@ -2,9 +2,12 @@
 
 // Include required header files
 #include "SMagicProjectile.h"
+#include "SAttributeComponent.h"
+#include "SProjectileSubsystem.h"
 #include "Components/SphereComponent.h" // For collision sphere
 #include "GameFramework/ProjectileMovementComponent.h" // For projectile movement
 #include "Particles/ParticleSystemComponent.h" // For visual effects
+#include "PhysicalMaterials/PhysicalMaterial.h" // For the surface that was hit
 
 // Constructor - Sets up the default properties and components of the magic projectile
 ASMagicProjectile::ASMagicProjectile()
@@ -15,6 +18,7 @@ ASMagicProjectile::ASMagicProjectile()
 	// Create and setup the sphere collision component
 	SphereComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	SphereComp->SetCollisionProfileName("Projectile"); // Set collision profile to "Projectile"
+	SphereComp->bReturnMaterialOnMove = true; // Hits carry the physical material, impacts pick their effect by surface
 	RootComponent = SphereComp; // Make the sphere the root component of this actor
 
 	// Create and setup the visual effects component
@@ -26,6 +30,109 @@ ASMagicProjectile::ASMagicProjectile()
 	MovementComp->InitialSpeed = 2000.0f; // Set how fast the projectile moves
 	MovementComp->bRotationFollowsVelocity = true; // Make projectile rotate to match its movement direction
 	MovementComp->bInitialVelocityInLocalSpace = true; // Use local space for initial velocity
+	// Fixed substeps, so homing and gravity on subclasses follow the same path at 30 and 144 FPS
+	MovementComp->bForceSubStepping = true;
+	MovementComp->MaxSimulationTimeStep = 1.0f / 60.0f;
+	MovementComp->MaxSimulationIterations = 8;
+}
+
+void ASMagicProjectile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	SphereComp->OnComponentBeginOverlap.AddDynamic(this, &ASMagicProjectile::OnActorOverlap);
+	SphereComp->OnComponentHit.AddDynamic(this, &ASMagicProjectile::OnActorHit);
+}
+
+void ASMagicProjectile::Launch(const FVector& Location, const FRotator& Rotation, APawn* InInstigator)
+{
+	SetInstigator(InInstigator);
+	SphereComp->ClearMoveIgnoreActors();
+	SphereComp->IgnoreActorWhenMoving(InInstigator, true);
+
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	// A projectile that stopped let go of its updated component
+	MovementComp->SetUpdatedComponent(SphereComp);
+	MovementComp->Velocity = Rotation.Vector() * MovementComp->InitialSpeed;
+	MovementComp->Activate(true);
+	EffectComp->Activate(true);
+
+	bActive = true;
+	LaunchTime = GetWorld()->GetTimeSeconds();
+	LaunchLocation = Location;
+}
+
+void ASMagicProjectile::Deactivate()
+{
+	bActive = false;
+
+	MovementComp->StopMovementImmediately();
+	MovementComp->Deactivate();
+	EffectComp->DeactivateImmediate();
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+UParticleSystem* ASMagicProjectile::GetImpactEffect(EPhysicalSurface SurfaceType) const
+{
+	UParticleSystem* const* SurfaceEffect = SurfaceImpactEffects.Find(SurfaceType);
+	return SurfaceEffect && *SurfaceEffect ? *SurfaceEffect : ImpactEffect;
+}
+
+void ASMagicProjectile::OnActorOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+	int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	// Only things with health, and never whoever cast us
+	USAttributeComponent* Attributes = OtherActor ? OtherActor->FindComponentByClass<USAttributeComponent>() : nullptr;
+	if (!Attributes || OtherActor == GetInstigator())
+	{
+		return;
+	}
+
+	RecordImpact(OtherActor, SweepResult);
+}
+
+void ASMagicProjectile::OnActorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse,
+	const FHitResult& Hit)
+{
+	// The Projectile profile blocks pawns, so characters are hit here like walls and props and take their damage
+	// from the impact. Overlaps only come from whatever a blueprint sets to overlap
+	RecordImpact(OtherActor, Hit);
+}
+
+void ASMagicProjectile::RecordImpact(AActor* OtherActor, const FHitResult& Hit)
+{
+	if (!bActive)
+	{
+		return;
+	}
+	bActive = false;
+
+	// Overlaps that didn't come from a sweep carry no hit, use where we are and where we came from
+	const bool bHasHit = Hit.bBlockingHit || !Hit.ImpactPoint.IsZero();
+
+	FSProjectileImpact Impact;
+	Impact.Projectile = this;
+	Impact.HitActor = OtherActor;
+	Impact.Instigator = GetInstigator();
+	Impact.Location = bHasHit ? FVector(Hit.ImpactPoint) : GetActorLocation();
+	Impact.Normal = bHasHit ? FVector(Hit.ImpactNormal) : -GetVelocity().GetSafeNormal();
+	Impact.SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+
+	// Effects, damage and recycling happen together at the end of the frame
+	if (USProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<USProjectileSubsystem>())
+	{
+		MovementComp->StopMovementImmediately();
+		Projectiles->AddImpact(Impact);
+	}
+	else
+	{
+		Destroy();
+	}
 }
 
 // Called when the projectile starts existing in the game
@@ -33,7 +140,14 @@ void ASMagicProjectile::BeginPlay()
 {
 	// Call parent class BeginPlay first
 	Super::BeginPlay();
-	
+
+	// Also spawned outside of USProjectileSubsystem::Launch, the lifetime and distance caps apply all the same
+	LaunchTime = GetWorld()->GetTimeSeconds();
+	LaunchLocation = GetActorLocation();
+	if (USProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<USProjectileSubsystem>())
+	{
+		Projectiles->Track(this);
+	}
 }
 
 // // Called every frame to update the projectile
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SMemoryBudget.h"
+
+#include "BlackholeProjectile.h"
+#include "EngineUtils.h"
+#include "SExplosiveBarrel.h"
+#include "SMagicProjectile.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Projectiles/SDashProjectile.h"
+#include "UObject/UObjectIterator.h"
+
+LLM_DEFINE_TAG(SGameplay_Projectiles);
+LLM_DEFINE_TAG(SGameplay_Effects);
+LLM_DEFINE_TAG(SGameplay_Interaction);
+LLM_DEFINE_TAG(SGameplay_Abilities);
+
+static FAutoConsoleCommandWithWorld MemoryBudgetCommand(
+	TEXT("s.Memory.Budget"),
+	TEXT("Logs live counts and memory of projectiles, barrels and spawned particle systems, warns for those over budget."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (World)
+		{
+			TArray<FSMemoryBudgetEntry> Entries;
+			FSMemoryBudget::Gather(World, Entries);
+			FSMemoryBudget::LogReport(Entries);
+		}
+	}));
+
+static int64 GetObjectBytes(const UObject* Object)
+{
+	return Object->GetClass()->GetStructureSize() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+}
+
+// Particle systems spawned at runtime, attached ones are outered to the actor they follow
+static bool IsSpawnedParticleSystem(const UActorComponent* Component)
+{
+	return Component->IsA<UParticleSystemComponent>() && !Component->IsDefaultSubobject();
+}
+
+static FSMemoryBudgetEntry MakeEntry(const TCHAR* Name)
+{
+	FSMemoryBudgetEntry Entry;
+	Entry.Name = Name;
+
+	FString Budget;
+	if (GConfig->GetString(TEXT("MemoryBudget"), Name, Budget, GGameIni))
+	{
+		int32 MaxKB = 0;
+		FParse::Value(*Budget, TEXT("MaxCount="), Entry.MaxCount);
+		FParse::Value(*Budget, TEXT("MaxKB="), MaxKB);
+		Entry.MaxBytes = (int64)MaxKB * 1024;
+	}
+	return Entry;
+}
+
+void FSMemoryBudget::Gather(UWorld* World, TArray<FSMemoryBudgetEntry>& OutEntries)
+{
+	// Blueprint subclasses count as their native class
+	const TPair<const TCHAR*, UClass*> ActorClasses[] = {
+		{ TEXT("SMagicProjectile"), ASMagicProjectile::StaticClass() },
+		{ TEXT("BlackholeProjectile"), ABlackholeProjectile::StaticClass() },
+		{ TEXT("SDashProjectile"), ASDashProjectile::StaticClass() },
+		{ TEXT("SExplosiveBarrel"), ASExplosiveBarrel::StaticClass() },
+	};
+	const int32 ParticleEntry = UE_ARRAY_COUNT(ActorClasses);
+
+	OutEntries.Reset();
+	for (const TPair<const TCHAR*, UClass*>& ActorClass : ActorClasses)
+	{
+		OutEntries.Add(MakeEntry(ActorClass.Key));
+	}
+	OutEntries.Add(MakeEntry(TEXT("ParticleSystemComponent")));
+
+	TInlineComponentArray<UActorComponent*> Components;
+	for (FActorIterator It(World); It; ++It)
+	{
+		AActor* Actor = *It;
+
+		int32 Tracked = INDEX_NONE;
+		for (int32 i = 0; i < ParticleEntry; i++)
+		{
+			if (Actor->IsA(ActorClasses[i].Value))
+			{
+				Tracked = i;
+				break;
+			}
+		}
+
+		if (Tracked != INDEX_NONE)
+		{
+			FSMemoryBudgetEntry& Entry = OutEntries[Tracked];
+			Entry.Count++;
+			Entry.Bytes += GetObjectBytes(Actor);
+			Actor->GetComponents(Components);
+			for (const UActorComponent* Component : Components)
+			{
+				if (!IsSpawnedParticleSystem(Component))
+				{
+					Entry.Bytes += GetObjectBytes(Component);
+				}
+			}
+		}
+	}
+
+	// Spawned effects have their own budget. Emitters spawned at a location come from the world's pool and belong to
+	// no actor, so they are found among all particle components rather than through the actors
+	for (TObjectIterator<UParticleSystemComponent> It; It; ++It)
+	{
+		const UParticleSystemComponent* Component = *It;
+		if (IsValid(Component) && Component->GetWorld() == World && IsSpawnedParticleSystem(Component))
+		{
+			OutEntries[ParticleEntry].Count++;
+			OutEntries[ParticleEntry].Bytes += GetObjectBytes(Component);
+		}
+	}
+}
+
+void FSMemoryBudget::AccumulatePeak(const TArray<FSMemoryBudgetEntry>& Entries, TArray<FSMemoryBudgetEntry>& InOutPeak)
+{
+	if (InOutPeak.Num() != Entries.Num())
+	{
+		InOutPeak = Entries;
+		return;
+	}
+
+	for (int32 i = 0; i < Entries.Num(); i++)
+	{
+		InOutPeak[i].Count = FMath::Max(InOutPeak[i].Count, Entries[i].Count);
+		InOutPeak[i].Bytes = FMath::Max(InOutPeak[i].Bytes, Entries[i].Bytes);
+	}
+}
+
+int32 FSMemoryBudget::LogReport(const TArray<FSMemoryBudgetEntry>& Entries)
+{
+	int32 NumOverBudget = 0;
+	for (const FSMemoryBudgetEntry& Entry : Entries)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %-24s %6d alive %10.1f KB  (budget %d, %lld KB)"), *Entry.Name.ToString(),
+			Entry.Count, Entry.Bytes / 1024.0, Entry.MaxCount, Entry.MaxBytes / 1024);
+
+		if (Entry.IsOverBudget())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Memory: %s over budget, %d alive using %.1f KB"), *Entry.Name.ToString(),
+				Entry.Count, Entry.Bytes / 1024.0);
+			NumOverBudget++;
+		}
+	}
+	return NumOverBudget;
+}
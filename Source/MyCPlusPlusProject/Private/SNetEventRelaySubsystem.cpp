@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SNetEventRelaySubsystem.h"
+
+#include "SFrameCost.h"
+#include "SCharacter.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+
+static TAutoConsoleVariable<float> CVarNetEventRelevancyDistance(
+	TEXT("s.Net.EventRelevancyDistance"), 15000.0f,
+	TEXT("Explosions and absorptions further than this from a player's view are not sent to that player."), ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarNetMaxEventsPerBatch(
+	TEXT("s.Net.MaxEventsPerBatch"), 32,
+	TEXT("Upper bound of world events sent to one player per frame, closest first."), ECVF_Default);
+
+static TAutoConsoleVariable<bool> CVarNetLogBandwidth(
+	TEXT("s.Net.LogBandwidth"), false,
+	TEXT("Log outgoing bytes per second for every client connection every few seconds."), ECVF_Default);
+
+// Rough wire size of one event (type, quantized location, class NetGUID) and of the RPC around a batch
+static constexpr int32 NetWorldEventBytes = 12;
+static constexpr int32 NetWorldBatchOverheadBytes = 8;
+
+void USNetEventRelaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Clients and standalone games have nobody to relay to
+	if (InWorld.GetNetMode() != NM_ListenServer && InWorld.GetNetMode() != NM_DedicatedServer)
+	{
+		return;
+	}
+
+	if (USGameplayEventSubsystem* EventBus = InWorld.GetSubsystem<USGameplayEventSubsystem>())
+	{
+		EventBus->OnEvents(ESGameplayEventType::Explosion).AddUObject(this, &USNetEventRelaySubsystem::OnExplosions);
+		EventBus->OnEvents(ESGameplayEventType::Absorbed).AddUObject(this, &USNetEventRelaySubsystem::OnAbsorbed);
+	}
+
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &USNetEventRelaySubsystem::OnWorldPostActorTick);
+}
+
+void USNetEventRelaySubsystem::Deinitialize()
+{
+	if (USGameplayEventSubsystem* EventBus = GetWorld()->GetSubsystem<USGameplayEventSubsystem>())
+	{
+		EventBus->OnEvents(ESGameplayEventType::Explosion).RemoveAll(this);
+		EventBus->OnEvents(ESGameplayEventType::Absorbed).RemoveAll(this);
+	}
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	Super::Deinitialize();
+}
+
+void USNetEventRelaySubsystem::OnExplosions(TConstArrayView<FSGameplayEvent> Events)
+{
+	for (const FSGameplayEvent& Event : Events)
+	{
+		// The bus already exploded and destroyed the barrel, its class is all the clients need
+		const AActor* Source = Event.Source.Get(true);
+
+		FSNetWorldEvent& NetEvent = PendingEvents.AddDefaulted_GetRef();
+		NetEvent.Type = ESNetWorldEventType::Explosion;
+		NetEvent.Location = Event.Location;
+		NetEvent.SourceClass = Source ? Source->GetClass() : nullptr;
+	}
+}
+
+void USNetEventRelaySubsystem::OnAbsorbed(TConstArrayView<FSGameplayEvent> Events)
+{
+	for (const FSGameplayEvent& Event : Events)
+	{
+		const AActor* Source = Event.Source.Get(true);
+
+		FSNetWorldEvent& NetEvent = PendingEvents.AddDefaulted_GetRef();
+		NetEvent.Type = ESNetWorldEventType::Absorbed;
+		NetEvent.Location = Event.Location;
+		NetEvent.SourceClass = Source ? Source->GetClass() : nullptr;
+	}
+}
+
+void USNetEventRelaySubsystem::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+	S_SCOPED_FRAME_COST("NetEventRelay");
+
+	if (PendingEvents.Num() > 0)
+	{
+		SendBatches();
+		PendingEvents.Reset();
+	}
+
+	if (CVarNetLogBandwidth.GetValueOnGameThread())
+	{
+		LogBandwidth();
+	}
+}
+
+void USNetEventRelaySubsystem::SendBatches()
+{
+	const float MaxDistanceSq = FMath::Square(CVarNetEventRelevancyDistance.GetValueOnGameThread());
+	const int32 MaxEvents = CVarNetMaxEventsPerBatch.GetValueOnGameThread();
+
+	TArray<TPair<float, int32>> Relevant;
+	TArray<FSNetWorldEvent> Batch;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		ASCharacter* Character = PC ? Cast<ASCharacter>(PC->GetPawn()) : nullptr;
+
+		// Local players on a listen server saw the real thing already
+		if (!Character || PC->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		Relevant.Reset();
+		for (int32 i = 0; i < PendingEvents.Num(); i++)
+		{
+			const float DistanceSq = FVector::DistSquared(PendingEvents[i].Location, ViewLocation);
+			if (DistanceSq <= MaxDistanceSq)
+			{
+				Relevant.Emplace(DistanceSq, i);
+			}
+		}
+		if (Relevant.Num() == 0)
+		{
+			continue;
+		}
+
+		Relevant.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B) { return A.Key < B.Key; });
+
+		Batch.Reset();
+		for (int32 i = 0; i < FMath::Min(Relevant.Num(), MaxEvents); i++)
+		{
+			Batch.Add(PendingEvents[Relevant[i].Value]);
+		}
+
+		Character->ClientReceiveWorldEvents(Batch);
+		EventBytesSent += NetWorldBatchOverheadBytes + Batch.Num() * NetWorldEventBytes;
+	}
+}
+
+void USNetEventRelaySubsystem::LogBandwidth()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = Now - LastBandwidthLogTime;
+	if (Elapsed < 5.0)
+	{
+		return;
+	}
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (NetDriver && LastBandwidthLogTime > 0.0)
+	{
+		int64 TotalOut = 0;
+		for (const UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (Connection)
+			{
+				UE_LOG(LogTemp, Log, TEXT("Net: %s out %d B/s"), *Connection->LowLevelGetRemoteAddress(), Connection->OutBytesPerSecond);
+				TotalOut += Connection->OutBytesPerSecond;
+			}
+		}
+
+		const int32 NumClients = FMath::Max(NetDriver->ClientConnections.Num(), 1);
+		UE_LOG(LogTemp, Display, TEXT("Net: %d clients, %.0f B/s per client on average, world event batches %.0f B/s per client"),
+			NetDriver->ClientConnections.Num(), double(TotalOut) / NumClients, EventBytesSent / Elapsed / NumClients);
+	}
+
+	EventBytesSent = 0;
+	LastBandwidthLogTime = Now;
+}
@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SObjectChurnProbe.h"
+
+#include "Particles/ParticleSystemComponent.h"
+#include "UObject/UObjectGlobals.h"
+
+static TAutoConsoleVariable<float> CVarProbeMaxPerSecond(
+	TEXT("s.GC.Probe.MaxPerSecond"),
+	0.5f,
+	TEXT("Creation rate (objects per second) above which a class of our module counts as steady-state churn in the GC probe report."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs ProbeCommand(
+	TEXT("s.GC.Probe"),
+	TEXT("Counts UObjects created and destroyed per class. Usage: s.GC.Probe Start|Stop"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		FSObjectChurnProbe& Probe = FSObjectChurnProbe::Get();
+		if (Args.Num() > 0 && Args[0] == TEXT("Stop"))
+		{
+			Probe.LogReport();
+			Probe.Stop();
+		}
+		else
+		{
+			Probe.Start();
+		}
+	}));
+
+// Gameplay churn is what our own code creates, directly or as Blueprint subclasses, and the effects it spawns
+static bool IsGameplayClass(const UClass* Class)
+{
+	static const FName ModulePackage(TEXT("/Script/MyCPlusPlusProject"));
+
+	if (Class->IsChildOf(UParticleSystemComponent::StaticClass()))
+	{
+		return true;
+	}
+	for (; Class; Class = Class->GetSuperClass())
+	{
+		if (Class->HasAnyClassFlags(CLASS_Native))
+		{
+			return Class->GetOutermost()->GetFName() == ModulePackage;
+		}
+	}
+	return false;
+}
+
+FSObjectChurnProbe& FSObjectChurnProbe::Get()
+{
+	static FSObjectChurnProbe Probe;
+	return Probe;
+}
+
+void FSObjectChurnProbe::Start()
+{
+	check(IsInGameThread());
+
+	Stop();
+
+	Counts.Reset();
+	NumCollections = 0;
+	MaxCollectSeconds = 0.0;
+	StartTime = FPlatformTime::Seconds();
+
+	GUObjectArray.AddUObjectCreateListener(this);
+	GUObjectArray.AddUObjectDeleteListener(this);
+	PreCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddRaw(this, &FSObjectChurnProbe::OnPreGarbageCollect);
+	PostCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddRaw(this, &FSObjectChurnProbe::OnPostGarbageCollect);
+	bRunning = true;
+}
+
+void FSObjectChurnProbe::Stop()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	GUObjectArray.RemoveUObjectCreateListener(this);
+	GUObjectArray.RemoveUObjectDeleteListener(this);
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostCollectHandle);
+	bRunning = false;
+}
+
+void FSObjectChurnProbe::NotifyUObjectCreated(const UObjectBase* Object, int32 Index)
+{
+	const FName ClassName = Object->GetClass()->GetFName();
+
+	FScopeLock Lock(&CountsLock);
+	Counts.FindOrAdd(ClassName).Created++;
+}
+
+void FSObjectChurnProbe::NotifyUObjectDeleted(const UObjectBase* Object, int32 Index)
+{
+	const FName ClassName = Object->GetClass()->GetFName();
+
+	FScopeLock Lock(&CountsLock);
+	Counts.FindOrAdd(ClassName).Destroyed++;
+}
+
+void FSObjectChurnProbe::OnUObjectArrayShutdown()
+{
+	GUObjectArray.RemoveUObjectCreateListener(this);
+	GUObjectArray.RemoveUObjectDeleteListener(this);
+	bRunning = false;
+}
+
+void FSObjectChurnProbe::OnPreGarbageCollect()
+{
+	CollectStartTime = FPlatformTime::Seconds();
+}
+
+void FSObjectChurnProbe::OnPostGarbageCollect()
+{
+	NumCollections++;
+	MaxCollectSeconds = FMath::Max(MaxCollectSeconds, FPlatformTime::Seconds() - CollectStartTime);
+}
+
+int32 FSObjectChurnProbe::LogReport() const
+{
+	const double Seconds = FMath::Max(FPlatformTime::Seconds() - StartTime, 1.0);
+
+	TArray<TPair<FName, FCounts>> Sorted;
+	{
+		FScopeLock Lock(&CountsLock);
+		for (const TPair<FName, FCounts>& Pair : Counts)
+		{
+			Sorted.Emplace(Pair.Key, Pair.Value);
+		}
+	}
+	Sorted.Sort([](const TPair<FName, FCounts>& A, const TPair<FName, FCounts>& B) { return A.Value.Created > B.Value.Created; });
+
+	UE_LOG(LogTemp, Display, TEXT("GC probe: %.0f seconds, %d collections, worst %.2f ms"), Seconds, NumCollections, MaxCollectSeconds * 1000.0);
+
+	const float MaxPerSecond = CVarProbeMaxPerSecond.GetValueOnGameThread();
+	int32 NumChurning = 0;
+	for (const TPair<FName, FCounts>& Pair : Sorted)
+	{
+		if (Pair.Value.Created == 0)
+		{
+			continue;
+		}
+
+		const double CreatedPerSecond = Pair.Value.Created / Seconds;
+		UE_LOG(LogTemp, Display, TEXT("  %-40s %8.2f created/s %8.2f destroyed/s"), *Pair.Key.ToString(),
+			CreatedPerSecond, Pair.Value.Destroyed / Seconds);
+
+		// Classes are looked up by name at report time, Blueprint classes unloaded since then are skipped
+		const UClass* Class = FindFirstObject<UClass>(*Pair.Key.ToString(), EFindFirstObjectOptions::None);
+		if (Class && IsGameplayClass(Class) && CreatedPerSecond > MaxPerSecond)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("GC probe: %s created at %.2f/s in steady state"), *Pair.Key.ToString(), CreatedPerSecond);
+			NumChurning++;
+		}
+	}
+	return NumChurning;
+}
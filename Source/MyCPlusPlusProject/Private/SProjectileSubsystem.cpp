@@ -0,0 +1,199 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SProjectileSubsystem.h"
+
+#include "SDamageSubsystem.h"
+#include "SFrameCost.h"
+#include "SMagicProjectile.h"
+#include "SMemoryBudget.h"
+#include "Kismet/GameplayStatics.h"
+
+static TAutoConsoleVariable<int32> CVarProjectilePool(
+	TEXT("s.Projectile.Pool"),
+	1,
+	TEXT("Return magic projectiles to a pool after they hit or expire, 0 destroys them."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarProjectileMaxLifetime(
+	TEXT("s.Projectile.MaxLifetime"),
+	5.0f,
+	TEXT("Magic projectiles that hit nothing are recycled after this many seconds."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarProjectileMaxDistance(
+	TEXT("s.Projectile.MaxDistance"),
+	10000.0f,
+	TEXT("Magic projectiles that hit nothing are recycled this far from where they were launched."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarProjectileMaxLive(
+	TEXT("s.Projectile.MaxLive"),
+	256,
+	TEXT("Most magic projectiles in flight, the oldest is recycled to make room."),
+	ECVF_Default);
+
+void USProjectileSubsystem::Deinitialize()
+{
+	Impacts.Reset();
+	Live.Reset();
+	Pool.Reset();
+
+	Super::Deinitialize();
+}
+
+ASMagicProjectile* USProjectileSubsystem::Launch(TSubclassOf<ASMagicProjectile> Class, const FVector& Location, const FRotator& Rotation,
+	APawn* Instigator)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Projectiles);
+
+	// Most recently pooled first, its components are the likeliest to still be warm
+	ASMagicProjectile* Projectile = nullptr;
+	for (int32 i = Pool.Num() - 1; i >= 0; i--)
+	{
+		if (IsValid(Pool[i]) && Pool[i]->GetClass() == Class)
+		{
+			Projectile = Pool[i];
+			Pool.RemoveAt(i, 1, false);
+			break;
+		}
+	}
+
+	if (!Projectile)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.Instigator = Instigator;
+		// Tracks itself in BeginPlay
+		Projectile = GetWorld()->SpawnActor<ASMagicProjectile>(Class, Location, Rotation, SpawnParams);
+		if (!Projectile)
+		{
+			return nullptr;
+		}
+	}
+	else
+	{
+		Track(Projectile);
+	}
+
+	Projectile->Launch(Location, Rotation, Instigator);
+	return Projectile;
+}
+
+void USProjectileSubsystem::Track(ASMagicProjectile* Projectile)
+{
+	Live.AddUnique(Projectile);
+}
+
+void USProjectileSubsystem::AddImpact(const FSProjectileImpact& Impact)
+{
+	Impacts.Add(Impact);
+}
+
+void USProjectileSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("Projectiles");
+
+	ProcessImpacts();
+	RecycleExpired();
+}
+
+TStatId USProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void USProjectileSubsystem::ProcessImpacts()
+{
+	if (Impacts.Num() == 0)
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(SGameplay_Effects);
+	USDamageSubsystem* Damage = GetWorld()->GetSubsystem<USDamageSubsystem>();
+
+	for (const FSProjectileImpact& Impact : Impacts)
+	{
+		ASMagicProjectile* Projectile = Impact.Projectile.Get();
+		if (!Projectile)
+		{
+			continue;
+		}
+
+		// Pooled by the world like the explosions, a volley doesn't leave a component per hit behind
+		if (UParticleSystem* Effect = Projectile->GetImpactEffect(Impact.SurfaceType))
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Effect, Impact.Location, Impact.Normal.Rotation(), FVector(1.0f),
+				true, EPSCPoolMethod::AutoRelease);
+		}
+
+		// Queued with every other hit of the frame, walls have no attributes and take none
+		if (Damage)
+		{
+			Damage->ApplyDamage(Impact.HitActor.Get(), Projectile->GetDamageAmount(), ESDamageType::Magic, Impact.Instigator.Get());
+		}
+
+		Recycle(Projectile);
+	}
+	Impacts.Reset();
+}
+
+void USProjectileSubsystem::RecycleExpired()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	const float MaxLifetime = CVarProjectileMaxLifetime.GetValueOnGameThread();
+	const float MaxDistanceSquared = FMath::Square(CVarProjectileMaxDistance.GetValueOnGameThread());
+
+	// Oldest first, the ones past their lifetime are all at the front
+	int32 NumExpired = 0;
+	while (NumExpired < Live.Num())
+	{
+		const ASMagicProjectile* Projectile = Live[NumExpired];
+		if (IsValid(Projectile) && Now - Projectile->GetLaunchTime() < MaxLifetime)
+		{
+			break;
+		}
+		NumExpired++;
+	}
+
+	const int32 NumOverCap = FMath::Max(Live.Num() - CVarProjectileMaxLive.GetValueOnGameThread(), 0);
+	const int32 NumFront = FMath::Max(NumExpired, NumOverCap);
+	TArray<ASMagicProjectile*> Expired(Live.GetData(), NumFront);
+
+	for (int32 i = NumFront; i < Live.Num(); i++)
+	{
+		// Destroyed by someone else, or flown too far
+		const ASMagicProjectile* Projectile = Live[i];
+		if (!IsValid(Projectile) || (Projectile->IsActive()
+			&& FVector::DistSquared(Projectile->GetActorLocation(), Projectile->GetLaunchLocation()) > MaxDistanceSquared))
+		{
+			Expired.Add(Live[i]);
+		}
+	}
+
+	for (ASMagicProjectile* Projectile : Expired)
+	{
+		Recycle(Projectile);
+	}
+}
+
+void USProjectileSubsystem::Recycle(ASMagicProjectile* Projectile)
+{
+	Live.RemoveSingle(Projectile);
+	if (!IsValid(Projectile))
+	{
+		return;
+	}
+
+	if (CVarProjectilePool.GetValueOnGameThread() != 0 && Pool.Num() < CVarProjectileMaxLive.GetValueOnGameThread())
+	{
+		Projectile->Deactivate();
+		Pool.Add(Projectile);
+	}
+	else
+	{
+		Projectile->Destroy();
+	}
+}
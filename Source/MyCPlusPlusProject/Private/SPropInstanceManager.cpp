@@ -0,0 +1,608 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SPropInstanceManager.h"
+
+#include "SFrameCost.h"
+#include "SDamageSubsystem.h"
+#include "SExplosiveBarrel.h"
+#include "SExplosionOcclusionSubsystem.h"
+#include "SFireSubsystem.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SItemChest.h"
+#include "SMemoryBudget.h"
+#include "SPropSimulationSubsystem.h"
+#include "SSaveGameSubsystem.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Kismet/GameplayStatics.h"
+
+// Sets default values
+ASPropInstanceManager::ASPropInstanceManager()
+{
+	// Only ticks to demote idle props, the interval is applied in BeginPlay
+	PrimaryActorTick.bCanEverTick = true;
+	bCanBeInCluster = true;
+
+	BarrelInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("BarrelInstances"));
+	RootComponent = BarrelInstances;
+	// Dormant barrels are static, the promoted actor takes over physics
+	BarrelInstances->SetCollisionProfileName("BlockAllDynamic");
+	BarrelInstances->SetNotifyRigidBodyCollision(true);
+
+	ChestBaseInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("ChestBaseInstances"));
+	ChestBaseInstances->SetupAttachment(BarrelInstances);
+	ChestBaseInstances->SetCollisionProfileName("BlockAllDynamic");
+
+	ChestLidInstances = CreateDefaultSubobject<UHierarchicalInstancedStaticMeshComponent>(TEXT("ChestLidInstances"));
+	ChestLidInstances->SetupAttachment(BarrelInstances);
+	ChestLidInstances->SetCollisionProfileName("BlockAllDynamic");
+}
+
+// Called when the game starts or when spawned
+void ASPropInstanceManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (bAbsorbPlacedActors)
+	{
+		AbsorbPlacedActors();
+	}
+
+	HiddenBarrelSlots.Init(false, BarrelInstances->GetInstanceCount());
+	HiddenChestSlots.Init(false, ChestBaseInstances->GetInstanceCount());
+	ChestLootTables.SetNum(ChestBaseInstances->GetInstanceCount());
+
+	BarrelInstances->OnComponentHit.AddDynamic(this, &ASPropInstanceManager::OnBarrelInstanceHit);
+
+	// Every dormant barrel is fuel for the fire grid
+	if (USFireSubsystem* Fire = GetWorld()->GetSubsystem<USFireSubsystem>())
+	{
+		Fire->SetFlameTemplate(GetBarrelDefaults()->GetFlameEffect());
+		for (int32 InstanceIndex = 0; InstanceIndex < BarrelInstances->GetInstanceCount(); InstanceIndex++)
+		{
+			FTransform Transform;
+			BarrelInstances->GetInstanceTransform(InstanceIndex, Transform, true);
+			Fire->AddFuel(Transform.GetLocation(), 0.0f, 5.0f);
+		}
+	}
+
+	PropSimulation = GetWorld()->GetSubsystem<USPropSimulationSubsystem>();
+	if (PropSimulation)
+	{
+		BarrelEntities.SetNumUninitialized(BarrelInstances->GetInstanceCount());
+		for (int32 InstanceIndex = 0; InstanceIndex < BarrelEntities.Num(); InstanceIndex++)
+		{
+			FTransform Transform;
+			BarrelInstances->GetInstanceTransform(InstanceIndex, Transform, true);
+			BarrelEntities[InstanceIndex] = PropSimulation->AddEntity(Transform.GetLocation(), this, InstanceIndex);
+		}
+
+		PropSimulation->OnEntitiesIgnited.AddUObject(this, &ASPropInstanceManager::OnSimEntitiesIgnited);
+		PropSimulation->OnEntitiesExploded.AddUObject(this, &ASPropInstanceManager::OnSimEntitiesExploded);
+	}
+
+	SetActorTickInterval(DemoteCheckInterval);
+
+	GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>()->Register(this, ESRegistryKind::PropManager);
+
+	UE_LOG(LogTemp, Log, TEXT("PropInstanceManager: %d barrel and %d chest instances"),
+		BarrelInstances->GetInstanceCount(), ChestBaseInstances->GetInstanceCount());
+}
+
+const ASExplosiveBarrel* ASPropInstanceManager::GetBarrelDefaults() const
+{
+	return GetDefault<ASExplosiveBarrel>(BarrelClass ? BarrelClass.Get() : ASExplosiveBarrel::StaticClass());
+}
+
+void ASPropInstanceManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (PropSimulation)
+	{
+		PropSimulation->OnEntitiesIgnited.RemoveAll(this);
+		PropSimulation->OnEntitiesExploded.RemoveAll(this);
+
+		// The cell is unloading, its props stop costing simulation time
+		for (int32 Entity : BarrelEntities)
+		{
+			PropSimulation->RemoveEntity(Entity);
+		}
+		BarrelEntities.Reset();
+	}
+
+	// Promoted props were spawned in the persistent level and would outlive the cell that owns them
+	if (EndPlayReason == EEndPlayReason::RemovedFromWorld)
+	{
+		for (const FSPromotedProp& Promoted : PromotedBarrels)
+		{
+			if (AActor* Actor = Promoted.Actor.Get())
+			{
+				Actor->Destroy();
+			}
+		}
+		for (const FSPromotedProp& Promoted : PromotedChests)
+		{
+			if (AActor* Actor = Promoted.Actor.Get())
+			{
+				Actor->Destroy();
+			}
+		}
+	}
+
+	if (USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>())
+	{
+		Registry->Unregister(this, ESRegistryKind::PropManager);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASPropInstanceManager::AbsorbPlacedActors()
+{
+	// Only actors of our own level, with level streaming or World Partition every cell brings its own manager
+	TArray<ASExplosiveBarrel*> Barrels;
+	TArray<ASItemChest*> Chests;
+	for (AActor* Actor : GetLevel()->Actors)
+	{
+		if (ASExplosiveBarrel* Barrel = Cast<ASExplosiveBarrel>(Actor))
+		{
+			Barrels.Add(Barrel);
+		}
+		else if (ASItemChest* Chest = Cast<ASItemChest>(Actor))
+		{
+			Chests.Add(Chest);
+		}
+	}
+
+	for (ASExplosiveBarrel* Barrel : Barrels)
+	{
+		UStaticMeshComponent* Mesh = Barrel->GetMeshComp();
+		if (Barrel->HasExploded() || !Mesh || !Mesh->GetStaticMesh())
+		{
+			continue;
+		}
+
+		// All instances of one component share a mesh, barrels with a different mesh stay actors
+		if (!BarrelInstances->GetStaticMesh())
+		{
+			BarrelInstances->SetStaticMesh(Mesh->GetStaticMesh());
+		}
+		if (Mesh->GetStaticMesh() != BarrelInstances->GetStaticMesh())
+		{
+			continue;
+		}
+
+		BarrelInstances->AddInstance(Barrel->GetActorTransform(), true);
+		Barrel->Destroy();
+	}
+
+	bool bHasLidTransform = false;
+	for (ASItemChest* Chest : Chests)
+	{
+		UStaticMeshComponent* Base = Chest->GetBasicMesh();
+		UStaticMeshComponent* Lid = Chest->GetLidMesh();
+		if (Chest->IsOpen() || !Base || !Lid || !Base->GetStaticMesh() || !Lid->GetStaticMesh())
+		{
+			continue;
+		}
+
+		if (!ChestBaseInstances->GetStaticMesh())
+		{
+			ChestBaseInstances->SetStaticMesh(Base->GetStaticMesh());
+			ChestLidInstances->SetStaticMesh(Lid->GetStaticMesh());
+		}
+		if (Base->GetStaticMesh() != ChestBaseInstances->GetStaticMesh() || Lid->GetStaticMesh() != ChestLidInstances->GetStaticMesh())
+		{
+			continue;
+		}
+
+		if (!bHasLidTransform)
+		{
+			LidRelativeTransform = Lid->GetRelativeTransform();
+			bHasLidTransform = true;
+		}
+
+		// Base and lid instances are added in pairs so they always share an index
+		const int32 InstanceIndex = ChestBaseInstances->AddInstance(Chest->GetActorTransform(), true);
+		ChestLidInstances->AddInstance(Lid->GetComponentTransform(), true);
+		ChestLootTables.SetNum(InstanceIndex + 1);
+		ChestLootTables[InstanceIndex] = Chest->LootTable;
+		Chest->Destroy();
+	}
+}
+
+void ASPropInstanceManager::HideInstance(UHierarchicalInstancedStaticMeshComponent* Instances, int32 InstanceIndex)
+{
+	// Removing instances reorders indices, collapsing the slot keeps every index stable so it can be reused on demotion
+	FTransform Transform;
+	Instances->GetInstanceTransform(InstanceIndex, Transform, true);
+	Transform.SetScale3D(FVector::ZeroVector);
+	Instances->UpdateInstanceTransform(InstanceIndex, Transform, true, true, true);
+}
+
+ASExplosiveBarrel* ASPropInstanceManager::PromoteBarrel(int32 InstanceIndex)
+{
+	if (!HiddenBarrelSlots.IsValidIndex(InstanceIndex) || HiddenBarrelSlots[InstanceIndex])
+	{
+		return nullptr;
+	}
+
+	FTransform Transform;
+	BarrelInstances->GetInstanceTransform(InstanceIndex, Transform, true);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	UClass* SpawnClass = BarrelClass ? BarrelClass.Get() : ASExplosiveBarrel::StaticClass();
+	ASExplosiveBarrel* Barrel = GetWorld()->SpawnActor<ASExplosiveBarrel>(SpawnClass, Transform, SpawnParams);
+	if (!Barrel)
+	{
+		return nullptr;
+	}
+
+	// Native class without a Blueprint mesh, borrow the instance mesh
+	if (!Barrel->GetMeshComp()->GetStaticMesh())
+	{
+		Barrel->GetMeshComp()->SetStaticMesh(BarrelInstances->GetStaticMesh());
+	}
+
+	HideInstance(BarrelInstances, InstanceIndex);
+	HiddenBarrelSlots[InstanceIndex] = true;
+
+	if (CanSaveInstances())
+	{
+		Barrel->SetSaveKey(FSSaveKey(BarrelInstances, InstanceIndex));
+	}
+
+	// The actor owns this barrel's gameplay state until it is demoted again
+	if (PropSimulation)
+	{
+		PropSimulation->DetachEntity(BarrelEntities[InstanceIndex]);
+	}
+
+	FSPromotedProp& Promoted = PromotedBarrels.AddDefaulted_GetRef();
+	Promoted.Actor = Barrel;
+	Promoted.InstanceIndex = InstanceIndex;
+	Promoted.LastActiveTime = GetWorld()->GetTimeSeconds();
+
+	return Barrel;
+}
+
+ASItemChest* ASPropInstanceManager::PromoteChest(int32 InstanceIndex)
+{
+	if (!HiddenChestSlots.IsValidIndex(InstanceIndex) || HiddenChestSlots[InstanceIndex])
+	{
+		return nullptr;
+	}
+
+	FTransform Transform;
+	ChestBaseInstances->GetInstanceTransform(InstanceIndex, Transform, true);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	UClass* SpawnClass = ChestClass ? ChestClass.Get() : ASItemChest::StaticClass();
+	ASItemChest* Chest = GetWorld()->SpawnActor<ASItemChest>(SpawnClass, Transform, SpawnParams);
+	if (!Chest)
+	{
+		return nullptr;
+	}
+
+	if (!Chest->GetBasicMesh()->GetStaticMesh())
+	{
+		Chest->GetBasicMesh()->SetStaticMesh(ChestBaseInstances->GetStaticMesh());
+		Chest->GetLidMesh()->SetStaticMesh(ChestLidInstances->GetStaticMesh());
+		Chest->GetLidMesh()->SetRelativeTransform(LidRelativeTransform);
+	}
+
+	if (ChestLootTables[InstanceIndex])
+	{
+		Chest->LootTable = ChestLootTables[InstanceIndex];
+	}
+
+	HideInstance(ChestBaseInstances, InstanceIndex);
+	HideInstance(ChestLidInstances, InstanceIndex);
+	HiddenChestSlots[InstanceIndex] = true;
+
+	if (CanSaveInstances())
+	{
+		Chest->SetSaveKey(FSSaveKey(ChestBaseInstances, InstanceIndex));
+	}
+
+	FSPromotedProp& Promoted = PromotedChests.AddDefaulted_GetRef();
+	Promoted.Actor = Chest;
+	Promoted.InstanceIndex = InstanceIndex;
+	Promoted.LastActiveTime = GetWorld()->GetTimeSeconds();
+
+	return Chest;
+}
+
+AActor* ASPropInstanceManager::PromoteInteractableFromHit(const FHitResult& Hit)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Interaction);
+	const UPrimitiveComponent* HitComponent = Hit.GetComponent();
+
+	// For instanced components the hit item is the instance index
+	if (HitComponent == ChestBaseInstances || HitComponent == ChestLidInstances)
+	{
+		return PromoteChest(Hit.Item);
+	}
+	return nullptr;
+}
+
+int32 ASPropInstanceManager::PromoteBarrelsInRadius(const FVector& Origin, float Radius)
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	// Barrels already promoted inside the radius are still being disturbed, keep them awake
+	const float RadiusSq = FMath::Square(Radius);
+	for (FSPromotedProp& Promoted : PromotedBarrels)
+	{
+		if (Promoted.Actor.IsValid() && FVector::DistSquared(Promoted.Actor->GetActorLocation(), Origin) <= RadiusSq)
+		{
+			Promoted.LastActiveTime = Now;
+		}
+	}
+
+	int32 NumPromoted = 0;
+	for (int32 InstanceIndex : BarrelInstances->GetInstancesOverlappingSphere(Origin, Radius, true))
+	{
+		if (PromoteBarrel(InstanceIndex))
+		{
+			NumPromoted++;
+		}
+	}
+	return NumPromoted;
+}
+
+void ASPropInstanceManager::RemoveBarrel(int32 InstanceIndex)
+{
+	for (int32 i = PromotedBarrels.Num() - 1; i >= 0; --i)
+	{
+		if (PromotedBarrels[i].InstanceIndex == InstanceIndex)
+		{
+			if (AActor* Actor = PromotedBarrels[i].Actor.Get())
+			{
+				Actor->Destroy();
+			}
+			PromotedBarrels.RemoveAtSwap(i);
+		}
+	}
+
+	// Same as an exploded barrel: hidden, and out of the simulation
+	HideInstance(BarrelInstances, InstanceIndex);
+	HiddenBarrelSlots[InstanceIndex] = true;
+	if (PropSimulation && BarrelEntities.IsValidIndex(InstanceIndex))
+	{
+		PropSimulation->DetachEntity(BarrelEntities[InstanceIndex]);
+	}
+}
+
+bool ASPropInstanceManager::ApplySavedInstance(const UHierarchicalInstancedStaticMeshComponent* Instances, int32 InstanceIndex, ESSaveFlags Flags)
+{
+	if (Instances == BarrelInstances)
+	{
+		if (!HiddenBarrelSlots.IsValidIndex(InstanceIndex))
+		{
+			return false;
+		}
+		if (EnumHasAnyFlags(Flags, ESSaveFlags::Exploded | ESSaveFlags::Destroyed))
+		{
+			RemoveBarrel(InstanceIndex);
+		}
+		return true;
+	}
+
+	if (Instances != ChestBaseInstances || !HiddenChestSlots.IsValidIndex(InstanceIndex))
+	{
+		return false;
+	}
+
+	ASItemChest* Chest = nullptr;
+	for (const FSPromotedProp& Promoted : PromotedChests)
+	{
+		if (Promoted.InstanceIndex == InstanceIndex)
+		{
+			Chest = Cast<ASItemChest>(Promoted.Actor.Get());
+		}
+	}
+
+	if (EnumHasAnyFlags(Flags, ESSaveFlags::Destroyed))
+	{
+		if (Chest)
+		{
+			Chest->Destroy();
+		}
+		HideInstance(ChestBaseInstances, InstanceIndex);
+		HideInstance(ChestLidInstances, InstanceIndex);
+		HiddenChestSlots[InstanceIndex] = true;
+	}
+	else if (EnumHasAnyFlags(Flags, ESSaveFlags::Opened))
+	{
+		// Opened chests live as actors, the same as after an interaction
+		if (!Chest && !HiddenChestSlots[InstanceIndex])
+		{
+			Chest = PromoteChest(InstanceIndex);
+		}
+		if (Chest)
+		{
+			Chest->SetOpen();
+		}
+	}
+	return true;
+}
+
+int32 ASPropInstanceManager::GetDormantBarrelCount() const
+{
+	return HiddenBarrelSlots.Num() - HiddenBarrelSlots.CountSetBits();
+}
+
+int32 ASPropInstanceManager::GetDormantChestCount() const
+{
+	return HiddenChestSlots.Num() - HiddenChestSlots.CountSetBits();
+}
+
+void ASPropInstanceManager::OnBarrelInstanceHit(UPrimitiveComponent* HitComponent, AActor* OtherActor,
+	UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	// Same behaviour as ASExplosiveBarrel::OnHit, only the barrel that was actually hit becomes an actor
+	if (ASExplosiveBarrel* Barrel = PromoteBarrel(Hit.Item))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Barrel instance %d hit by: %s"), Hit.Item, *GetNameSafe(OtherActor));
+		Barrel->RequestExplode();
+	}
+}
+
+void ASPropInstanceManager::OnSimEntitiesIgnited(TConstArrayView<int32> Entities)
+{
+	// Flames are drawn by the fire grid from a small emitter pool, a burning barrel just heats up its cell
+	USFireSubsystem* Fire = GetWorld()->GetSubsystem<USFireSubsystem>();
+	if (!Fire)
+	{
+		return;
+	}
+
+	const FSPropSimFragments& Fragments = PropSimulation->GetFragments();
+	for (int32 Entity : Entities)
+	{
+		if (Fragments.Owners[Entity] == this)
+		{
+			Fire->AddHeat(FVector(Fragments.Positions[Entity]), 0.0f, 2.0f);
+		}
+	}
+}
+
+void ASPropInstanceManager::OnSimEntitiesExploded(TConstArrayView<int32> Entities)
+{
+	LLM_SCOPE_BYTAG(SGameplay_Effects);
+	const ASExplosiveBarrel* BarrelDefaults = GetBarrelDefaults();
+	UParticleSystem* ExplosionEffect = BarrelDefaults->GetExplosionEffect();
+	USSaveGameSubsystem* Save = CanSaveInstances() ? GetWorld()->GetSubsystem<USSaveGameSubsystem>() : nullptr;
+	USDamageSubsystem* Damage = GetWorld()->GetSubsystem<USDamageSubsystem>();
+	USExplosionOcclusionSubsystem* Occlusion = USExplosionOcclusionSubsystem::IsEnabled() ? GetWorld()->GetSubsystem<USExplosionOcclusionSubsystem>() : nullptr;
+
+	const FSPropSimFragments& Fragments = PropSimulation->GetFragments();
+	for (int32 Entity : Entities)
+	{
+		if (Fragments.Owners[Entity] != this)
+		{
+			continue;
+		}
+
+		// The barrel is gone for good, its slot stays hidden and is never demoted into again
+		const int32 InstanceIndex = Fragments.OwnerIndices[Entity];
+		HideInstance(BarrelInstances, InstanceIndex);
+		HiddenBarrelSlots[InstanceIndex] = true;
+
+		if (Save)
+		{
+			Save->MarkChanged(FSSaveKey(BarrelInstances, InstanceIndex), ESSaveFlags::Exploded | ESSaveFlags::Destroyed);
+		}
+
+		const FVector Location(Fragments.Positions[Entity]);
+		if (ExplosionEffect)
+		{
+			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ExplosionEffect, Location, FRotator::ZeroRotator, FVector(20.0f),
+				true, EPSCPoolMethod::AutoRelease);
+		}
+
+		// Same batch of line of sight checks as the actor barrels, a chain reaction in one room shares the cached results
+		if (Occlusion)
+		{
+			FSOccludedExplosion Explosion;
+			Explosion.Origin = Location;
+			Explosion.Radius = BarrelDefaults->GetExplosionRadius();
+			Explosion.Impulse = BarrelDefaults->GetExplosionImpulse();
+			Explosion.Falloff = BarrelDefaults->GetImpulseFalloff();
+			Explosion.bImpulseVelChange = BarrelDefaults->GetImpulseVelChange();
+			Explosion.Damage = BarrelDefaults->GetExplosionDamage();
+			Explosion.Source = this;
+			Occlusion->QueueExplosion(Explosion);
+			continue;
+		}
+
+		if (Damage)
+		{
+			Damage->ApplyRadialDamage(Location, BarrelDefaults->GetExplosionRadius(), BarrelDefaults->GetExplosionDamage(), ESDamageType::Explosion, this);
+		}
+
+		// Push live physics actors and characters around the same way ASExplosiveBarrel::Explode does, with the same
+		// settings so simulated and actor barrels feel the same
+		ASExplosiveBarrel::FireImpulse(GetWorld(), Location, BarrelDefaults->GetExplosionRadius(), BarrelDefaults->GetExplosionImpulse(),
+			BarrelDefaults->GetImpulseFalloff(), BarrelDefaults->GetImpulseVelChange(), this);
+	}
+}
+
+void ASPropInstanceManager::DemoteIdleBarrels(float Now)
+{
+	for (int32 i = PromotedBarrels.Num() - 1; i >= 0; --i)
+	{
+		FSPromotedProp& Promoted = PromotedBarrels[i];
+		ASExplosiveBarrel* Barrel = Cast<ASExplosiveBarrel>(Promoted.Actor.Get());
+
+		// Exploded barrels are gone for good, their slot stays hidden
+		if (!Barrel || Barrel->HasExploded())
+		{
+			PromotedBarrels.RemoveAtSwap(i);
+			continue;
+		}
+
+		if (Barrel->GetMeshComp()->IsAnyRigidBodyAwake())
+		{
+			Promoted.LastActiveTime = Now;
+			continue;
+		}
+
+		if (Now - Promoted.LastActiveTime < IdleTimeBeforeDemote)
+		{
+			continue;
+		}
+
+		// Put the instance back where the actor came to rest
+		BarrelInstances->UpdateInstanceTransform(Promoted.InstanceIndex, Barrel->GetActorTransform(), true, true, true);
+		HiddenBarrelSlots[Promoted.InstanceIndex] = false;
+		if (PropSimulation)
+		{
+			PropSimulation->AttachEntity(BarrelEntities[Promoted.InstanceIndex], Barrel->GetActorLocation());
+		}
+		Barrel->Destroy();
+		PromotedBarrels.RemoveAtSwap(i);
+	}
+}
+
+void ASPropInstanceManager::DemoteIdleChests(float Now)
+{
+	for (int32 i = PromotedChests.Num() - 1; i >= 0; --i)
+	{
+		FSPromotedProp& Promoted = PromotedChests[i];
+		ASItemChest* Chest = Cast<ASItemChest>(Promoted.Actor.Get());
+
+		// Opened chests keep their actor, destroyed ones free nothing
+		if (!Chest)
+		{
+			PromotedChests.RemoveAtSwap(i);
+			continue;
+		}
+
+		if (Chest->IsOpen() || Now - Promoted.LastActiveTime < IdleTimeBeforeDemote)
+		{
+			continue;
+		}
+
+		ChestBaseInstances->UpdateInstanceTransform(Promoted.InstanceIndex, Chest->GetActorTransform(), true, true, true);
+		ChestLidInstances->UpdateInstanceTransform(Promoted.InstanceIndex, LidRelativeTransform * Chest->GetActorTransform(), true, true, true);
+		HiddenChestSlots[Promoted.InstanceIndex] = false;
+		Chest->Destroy();
+		PromotedChests.RemoveAtSwap(i);
+	}
+}
+
+// Called every DemoteCheckInterval seconds
+void ASPropInstanceManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("PropInstances");
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	DemoteIdleBarrels(Now);
+	DemoteIdleChests(Now);
+}
@@ -0,0 +1,305 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SPropSimulationSubsystem.h"
+
+#include "SFrameCost.h"
+#include "SGameplayRandomSubsystem.h"
+#include "Async/ParallelFor.h"
+
+static TAutoConsoleVariable<float> CVarPropSimExplosionRadius(
+	TEXT("s.PropSim.ExplosionRadius"), 1000.0f,
+	TEXT("Radius of explosions caused by simulated props."), ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarPropSimExplosionDamage(
+	TEXT("s.PropSim.ExplosionDamage"), 100.0f,
+	TEXT("Damage at the centre of an explosion, falls off linearly to zero at the radius."), ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarPropSimStartHealth(
+	TEXT("s.PropSim.StartHealth"), 100.0f,
+	TEXT("Health of a freshly registered prop."), ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarPropSimBurnDamage(
+	TEXT("s.PropSim.BurnDamagePerSecond"), 25.0f,
+	TEXT("Health lost per second by a burning prop."), ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarPropSimFuseTime(
+	TEXT("s.PropSim.FuseTime"), 1.0f,
+	TEXT("Seconds between a prop running out of health and exploding."), ECVF_Cheat);
+
+static TAutoConsoleVariable<float> CVarPropSimFuseJitter(
+	TEXT("s.PropSim.FuseJitter"), 0.25f,
+	TEXT("Random variation of the fuse time as a fraction of it, so chain reactions don't go off all on the same frame."), ECVF_Cheat);
+
+// Entities per parallel task, big enough that task overhead is negligible next to the loop
+static constexpr int32 PropSimChunkSize = 1024;
+
+static constexpr float PropSimGridCellSize = 1000.0f;
+
+int32 USPropSimulationSubsystem::AddEntity(const FVector& Location, ASPropInstanceManager* Owner, int32 OwnerIndex)
+{
+	// Streaming cells come and go, reuse the slots of unloaded ones so the fragments don't keep growing
+	if (FreeEntities.Num() > 0)
+	{
+		const int32 Entity = FreeEntities.Pop(false);
+		Fragments.Positions[Entity] = FVector3f(Location);
+		Fragments.Health[Entity] = CVarPropSimStartHealth.GetValueOnGameThread();
+		Fragments.FuseTimers[Entity] = 0.0f;
+		Fragments.Flags[Entity] = ESPropSimFlags::None;
+		Fragments.Owners[Entity] = Owner;
+		Fragments.OwnerIndices[Entity] = OwnerIndex;
+
+		bGridDirty = true;
+		return Entity;
+	}
+
+	const int32 Entity = Fragments.Positions.Add(FVector3f(Location));
+	Fragments.Health.Add(CVarPropSimStartHealth.GetValueOnGameThread());
+	Fragments.FuseTimers.Add(0.0f);
+	Fragments.Flags.Add(ESPropSimFlags::None);
+	Fragments.Owners.Add(Owner);
+	Fragments.OwnerIndices.Add(OwnerIndex);
+
+	bGridDirty = true;
+	return Entity;
+}
+
+void USPropSimulationSubsystem::DetachEntity(int32 Entity)
+{
+	if (Fragments.Flags.IsValidIndex(Entity))
+	{
+		Fragments.Flags[Entity] |= ESPropSimFlags::Detached;
+	}
+}
+
+void USPropSimulationSubsystem::RemoveEntity(int32 Entity)
+{
+	if (Fragments.Flags.IsValidIndex(Entity))
+	{
+		Fragments.Flags[Entity] = ESPropSimFlags::Detached;
+		Fragments.Owners[Entity] = nullptr;
+		FreeEntities.Add(Entity);
+		bGridDirty = true;
+	}
+}
+
+void USPropSimulationSubsystem::AttachEntity(int32 Entity, const FVector& Location)
+{
+	if (Fragments.Flags.IsValidIndex(Entity))
+	{
+		Fragments.Flags[Entity] &= ~ESPropSimFlags::Detached;
+		Fragments.Positions[Entity] = FVector3f(Location);
+		bGridDirty = true;
+	}
+}
+
+void USPropSimulationSubsystem::AddExplosion(const FVector& Location, float Radius)
+{
+	PendingExplosions.Add({ FVector3f(Location), Radius, 1.0f, INDEX_NONE });
+}
+
+void USPropSimulationSubsystem::AddFire(const FVector& Location, float Radius)
+{
+	PendingExplosions.Add({ FVector3f(Location), Radius, 0.0f, INDEX_NONE });
+}
+
+FIntPoint USPropSimulationSubsystem::GetCell(const FVector3f& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / PropSimGridCellSize), FMath::FloorToInt(Location.Y / PropSimGridCellSize));
+}
+
+void USPropSimulationSubsystem::RebuildGrid()
+{
+	Grid.Reset();
+	for (int32 Entity = 0; Entity < Fragments.Num(); Entity++)
+	{
+		if (!EnumHasAnyFlags(Fragments.Flags[Entity], ESPropSimFlags::Exploded))
+		{
+			Grid.FindOrAdd(GetCell(Fragments.Positions[Entity])).Add(Entity);
+		}
+	}
+	bGridDirty = false;
+}
+
+void USPropSimulationSubsystem::ProcessFuses(float DeltaTime)
+{
+	const int32 NumChunks = FMath::DivideAndRoundUp(Fragments.Num(), PropSimChunkSize);
+	ParallelFor(NumChunks, [this, DeltaTime](int32 Chunk)
+	{
+		const int32 First = Chunk * PropSimChunkSize;
+		const int32 Last = FMath::Min(First + PropSimChunkSize, Fragments.Num());
+		for (int32 Entity = First; Entity < Last; Entity++)
+		{
+			ESPropSimFlags& Flags = Fragments.Flags[Entity];
+			if ((Flags & (ESPropSimFlags::Ignited | ESPropSimFlags::Detached | ESPropSimFlags::Exploded)) != ESPropSimFlags::Ignited)
+			{
+				continue;
+			}
+
+			Fragments.FuseTimers[Entity] -= DeltaTime;
+			if (Fragments.FuseTimers[Entity] <= 0.0f)
+			{
+				Flags |= ESPropSimFlags::PendingExplode;
+			}
+		}
+	});
+}
+
+float USPropSimulationSubsystem::GetFuseTime(int32 Entity) const
+{
+	// Counter based, the entity index picks the number, so the result doesn't depend on which task ignites it
+	const float FuseTime = CVarPropSimFuseTime.GetValueOnAnyThread();
+	const float Jitter = CVarPropSimFuseJitter.GetValueOnAnyThread();
+	return FuseTime * (1.0f + FuseRandom.FRandRange(Entity, -Jitter, Jitter));
+}
+
+void USPropSimulationSubsystem::ProcessFlames(float DeltaTime)
+{
+	const float BurnDamage = CVarPropSimBurnDamage.GetValueOnGameThread() * DeltaTime;
+
+	const int32 NumChunks = FMath::DivideAndRoundUp(Fragments.Num(), PropSimChunkSize);
+	ParallelFor(NumChunks, [this, BurnDamage](int32 Chunk)
+	{
+		const int32 First = Chunk * PropSimChunkSize;
+		const int32 Last = FMath::Min(First + PropSimChunkSize, Fragments.Num());
+		for (int32 Entity = First; Entity < Last; Entity++)
+		{
+			ESPropSimFlags& Flags = Fragments.Flags[Entity];
+			if ((Flags & (ESPropSimFlags::Burning | ESPropSimFlags::Detached)) != ESPropSimFlags::Burning)
+			{
+				continue;
+			}
+
+			// A burning prop cooks off once the fire has eaten all of its health
+			Fragments.Health[Entity] -= BurnDamage;
+			if (Fragments.Health[Entity] <= 0.0f && !EnumHasAnyFlags(Flags, ESPropSimFlags::Ignited))
+			{
+				Flags |= ESPropSimFlags::Ignited;
+				Fragments.FuseTimers[Entity] = GetFuseTime(Entity);
+			}
+		}
+	});
+}
+
+void USPropSimulationSubsystem::CollectExplosions(TArray<int32>& OutExploded)
+{
+	const float Radius = CVarPropSimExplosionRadius.GetValueOnGameThread();
+
+	for (int32 Entity = 0; Entity < Fragments.Num(); Entity++)
+	{
+		ESPropSimFlags& Flags = Fragments.Flags[Entity];
+		if (!EnumHasAnyFlags(Flags, ESPropSimFlags::PendingExplode))
+		{
+			continue;
+		}
+
+		Flags &= ~(ESPropSimFlags::PendingExplode | ESPropSimFlags::Burning);
+		Flags |= ESPropSimFlags::Exploded;
+
+		PendingExplosions.Add({ Fragments.Positions[Entity], Radius, 1.0f, Entity });
+		OutExploded.Add(Entity);
+	}
+}
+
+void USPropSimulationSubsystem::ProcessExplosions(TArray<int32>& OutIgnited)
+{
+	if (PendingExplosions.Num() == 0)
+	{
+		return;
+	}
+
+	if (bGridDirty)
+	{
+		RebuildGrid();
+	}
+
+	const float MaxDamage = CVarPropSimExplosionDamage.GetValueOnGameThread();
+
+	// Explosions per frame are few compared to entities, so this pass stays serial and only visits nearby cells
+	for (const FSPropSimExplosion& Explosion : PendingExplosions)
+	{
+		const FIntPoint MinCell = GetCell(Explosion.Location - FVector3f(Explosion.Radius));
+		const FIntPoint MaxCell = GetCell(Explosion.Location + FVector3f(Explosion.Radius));
+		const float RadiusSq = FMath::Square(Explosion.Radius);
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+			{
+				const TArray<int32>* Cell = Grid.Find(FIntPoint(X, Y));
+				if (!Cell)
+				{
+					continue;
+				}
+
+				for (int32 Entity : *Cell)
+				{
+					ESPropSimFlags& Flags = Fragments.Flags[Entity];
+					if (Entity == Explosion.Entity || EnumHasAnyFlags(Flags, ESPropSimFlags::Detached | ESPropSimFlags::Exploded))
+					{
+						continue;
+					}
+
+					const float DistSq = FVector3f::DistSquared(Fragments.Positions[Entity], Explosion.Location);
+					if (DistSq > RadiusSq)
+					{
+						continue;
+					}
+
+					// Same falloff a radial impulse uses, full damage at the centre and none at the edge
+					Fragments.Health[Entity] -= MaxDamage * Explosion.DamageScale * (1.0f - FMath::Sqrt(DistSq) / Explosion.Radius);
+
+					if (!EnumHasAnyFlags(Flags, ESPropSimFlags::Burning))
+					{
+						Flags |= ESPropSimFlags::Burning;
+						OutIgnited.Add(Entity);
+					}
+					if (Fragments.Health[Entity] <= 0.0f && !EnumHasAnyFlags(Flags, ESPropSimFlags::Ignited))
+					{
+						Flags |= ESPropSimFlags::Ignited;
+						Fragments.FuseTimers[Entity] = GetFuseTime(Entity);
+					}
+				}
+			}
+		}
+	}
+
+	PendingExplosions.Reset();
+}
+
+void USPropSimulationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("PropSimulation");
+
+	if (Fragments.Num() == 0)
+	{
+		PendingExplosions.Reset();
+		return;
+	}
+
+	TArray<int32> Exploded;
+	TArray<int32> Ignited;
+
+	// The world seed can change (game mode, input replay), the key is cheap to fetch again every step
+	FuseRandom = GetWorld()->GetSubsystem<USGameplayRandomSubsystem>()->GetCounterStream(TEXT("PropSim"));
+
+	ProcessFuses(DeltaTime);
+	ProcessFlames(DeltaTime);
+	CollectExplosions(Exploded);
+	ProcessExplosions(Ignited);
+
+	if (Ignited.Num() > 0)
+	{
+		OnEntitiesIgnited.Broadcast(Ignited);
+	}
+	if (Exploded.Num() > 0)
+	{
+		OnEntitiesExploded.Broadcast(Exploded);
+	}
+}
+
+TStatId USPropSimulationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USPropSimulationSubsystem, STATGROUP_Tickables);
+}
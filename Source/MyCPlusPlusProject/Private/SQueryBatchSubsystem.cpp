@@ -0,0 +1,278 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SQueryBatchSubsystem.h"
+
+#include "SFrameCost.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SGameplaySettings.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarQueryBatch(
+	TEXT("s.QueryBatch"),
+	1,
+	TEXT("Batch aim traces and interaction sweeps into one async submission per frame, 0 runs each one immediately."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarQueryBatchTolerance(
+	TEXT("s.QueryBatch.Tolerance"),
+	10.0f,
+	TEXT("Queries whose start and end are this close share one scene query."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs QueryBatchBenchmarkCommand(
+	TEXT("s.QueryBatch.Benchmark"),
+	TEXT("Times batched against immediate queries. Usage: s.QueryBatch.Benchmark [Players] [Bots] [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USQueryBatchSubsystem* Batch = World ? World->GetSubsystem<USQueryBatchSubsystem>() : nullptr)
+		{
+			Batch->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 4, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 50,
+				Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 300);
+		}
+	}));
+
+FSBatchedQueryKey USQueryBatchSubsystem::MakeKey(const FSBatchedQuery& Query, float Tolerance)
+{
+	const float Scale = 1.0f / FMath::Max(Tolerance, 0.01f);
+
+	FSBatchedQueryKey Key;
+	Key.Start = FIntVector(Query.Start * Scale);
+	Key.End = FIntVector(Query.End * Scale);
+	Key.Radius = FMath::RoundToInt(Query.Radius);
+	Key.Filter = Query.Type == ESBatchedQueryType::Line ? (int32)Query.Channel : Query.ObjectTypes.GetQueryBitfield();
+	Key.Type = Query.Type;
+	Key.Ignore = Query.Ignore;
+	return Key;
+}
+
+void USQueryBatchSubsystem::Request(const FSBatchedQuery& Query, FSBatchedQueryCallback Callback)
+{
+	NumRequested++;
+
+	if (CVarQueryBatch.GetValueOnGameThread() == 0)
+	{
+		NumSubmitted++;
+		TArray<FHitResult> Hits;
+		Execute(Query, Hits);
+		Callback(Hits);
+		return;
+	}
+
+	const FSBatchedQueryKey Key = MakeKey(Query, CVarQueryBatchTolerance.GetValueOnGameThread());
+	int32& GroupIndex = PendingByKey.FindOrAdd(Key, INDEX_NONE);
+	if (GroupIndex == INDEX_NONE)
+	{
+		GroupIndex = Pending.AddDefaulted();
+		Pending[GroupIndex].Query = Query;
+	}
+
+	Pending[GroupIndex].Callbacks.Add(MoveTemp(Callback));
+}
+
+void USQueryBatchSubsystem::Deinitialize()
+{
+	// Callers may be gone already, their callbacks are dropped
+	Pending.Reset();
+	PendingByKey.Reset();
+	InFlight.Reset();
+
+	Super::Deinitialize();
+}
+
+void USQueryBatchSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("QueryBatch");
+
+	CollectResults();
+
+	for (FGroup& Group : Pending)
+	{
+		Submit(Group);
+		NumSubmitted++;
+	}
+	InFlight.Append(MoveTemp(Pending));
+	Pending.Reset();
+	PendingByKey.Reset();
+}
+
+TStatId USQueryBatchSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USQueryBatchSubsystem, STATGROUP_Tickables);
+}
+
+void USQueryBatchSubsystem::Submit(FGroup& Group) const
+{
+	const FSBatchedQuery& Query = Group.Query;
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(SQueryBatch), false, Query.Ignore);
+	if (Query.Type == ESBatchedQueryType::Line)
+	{
+		Group.Handle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Query.Start, Query.End, Query.Channel, Params);
+	}
+	else
+	{
+		Group.Handle = GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Multi, Query.Start, Query.End, FQuat::Identity,
+			Query.ObjectTypes, FCollisionShape::MakeSphere(Query.Radius), Params);
+	}
+}
+
+void USQueryBatchSubsystem::Execute(const FSBatchedQuery& Query, TArray<FHitResult>& OutHits) const
+{
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(SQueryBatch), false, Query.Ignore);
+
+	if (Query.Type == ESBatchedQueryType::Line)
+	{
+		FHitResult Hit;
+		if (GetWorld()->LineTraceSingleByChannel(Hit, Query.Start, Query.End, Query.Channel, Params))
+		{
+			OutHits.Add(Hit);
+		}
+	}
+	else
+	{
+		GetWorld()->SweepMultiByObjectType(OutHits, Query.Start, Query.End, FQuat::Identity, Query.ObjectTypes,
+			FCollisionShape::MakeSphere(Query.Radius), Params);
+	}
+}
+
+void USQueryBatchSubsystem::CollectResults()
+{
+	// Callbacks may request again, those go to Pending and are submitted after this
+	TArray<FGroup> Groups = MoveTemp(InFlight);
+	InFlight.Reset();
+
+	for (FGroup& Group : Groups)
+	{
+		FTraceDatum Datum;
+		if (!GetWorld()->QueryTraceData(Group.Handle, Datum))
+		{
+			if (GetWorld()->IsTraceHandleValid(Group.Handle, false))
+			{
+				InFlight.Add(MoveTemp(Group));
+				continue;
+			}
+		}
+
+		for (const FSBatchedQueryCallback& Callback : Group.Callbacks)
+		{
+			Callback(Datum.OutHits);
+		}
+	}
+}
+
+void USQueryBatchSubsystem::RunBenchmark(int32 NumPlayers, int32 NumBots, int32 NumFrames)
+{
+	// Viewers stand at the registered pawns, spread around them when there are fewer pawns than viewers
+	TArray<FVector> PawnLocations;
+	if (const USGameplayRegistrySubsystem* Registry = GetWorld()->GetSubsystem<USGameplayRegistrySubsystem>())
+	{
+		Registry->ForEach<AActor>(ESRegistryKind::Pawn, [&PawnLocations](AActor* Pawn) { PawnLocations.Add(Pawn->GetActorLocation()); });
+	}
+	if (PawnLocations.Num() == 0)
+	{
+		PawnLocations.Add(FVector::ZeroVector);
+	}
+
+	FRandomStream Random(NumPlayers * 1000 + NumBots);
+	const int32 NumViewers = NumPlayers + NumBots;
+
+	TArray<FVector> Origins;
+	TArray<FVector> Directions;
+	for (int32 i = 0; i < NumViewers; i++)
+	{
+		const FVector Offset = i < PawnLocations.Num() ? FVector::ZeroVector : FVector(Random.GetUnitVector() * FVector(1.0f, 1.0f, 0.0f)) * 2000.0f;
+		Origins.Add(PawnLocations[i % PawnLocations.Num()] + Offset + FVector(0.0f, 0.0f, 60.0f));
+		Directions.Add(FRotator(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f).Vector());
+	}
+
+	// Players aim and interact every frame, bots every fourth frame, a frame's queries are generated up front
+	FCollisionObjectQueryParams InteractTypes;
+	InteractTypes.AddObjectTypesToQuery(ECC_WorldDynamic);
+	const FSGameplayConstants& Constants = USGameplaySettings::GetConstants();
+
+	TArray<TArray<FSBatchedQuery>> Frames;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		TArray<FSBatchedQuery>& Queries = Frames.AddDefaulted_GetRef();
+		for (int32 i = 0; i < NumViewers; i++)
+		{
+			if (i >= NumPlayers && (Frame + i) % 4 != 0)
+			{
+				continue;
+			}
+
+			// Views drift slowly, like someone looking around
+			Directions[i] = FRotator(Random.FRandRange(-0.5f, 0.5f), Random.FRandRange(-1.0f, 1.0f), 0.0f).RotateVector(Directions[i]);
+
+			FSBatchedQuery& Aim = Queries.AddDefaulted_GetRef();
+			Aim.Start = Origins[i];
+			Aim.End = Origins[i] + Directions[i] * Constants.AimTraceLength;
+
+			FSBatchedQuery& Interact = Queries.AddDefaulted_GetRef();
+			Interact.Type = ESBatchedQueryType::Sweep;
+			Interact.Start = Origins[i];
+			Interact.End = Origins[i] + Directions[i] * Constants.InteractionReach;
+			Interact.Radius = Constants.InteractionRadius;
+			Interact.ObjectTypes = InteractTypes;
+		}
+	}
+
+	int32 NumQueries = 0;
+	TArray<FHitResult> Hits;
+	const double DirectStart = FPlatformTime::Seconds();
+	for (const TArray<FSBatchedQuery>& Queries : Frames)
+	{
+		for (const FSBatchedQuery& Query : Queries)
+		{
+			Hits.Reset();
+			Execute(Query, Hits);
+			NumQueries++;
+		}
+	}
+	const double DirectSeconds = FPlatformTime::Seconds() - DirectStart;
+
+	// What the game thread does for a live batch: de-duplicate and submit to the async traces. The handles are dropped,
+	// the traces run with the next frame's async batch and nobody reads them
+	int32 NumUnique = 0;
+	const float Tolerance = CVarQueryBatchTolerance.GetValueOnGameThread();
+	TArray<TArray<FGroup>> FrameGroups;
+	FrameGroups.SetNum(NumFrames);
+	const double SubmitStart = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		TSet<FSBatchedQueryKey> Keys;
+		for (const FSBatchedQuery& Query : Frames[Frame])
+		{
+			bool bAlreadyQueued = false;
+			Keys.Add(MakeKey(Query, Tolerance), &bAlreadyQueued);
+			if (!bAlreadyQueued)
+			{
+				FGroup& Group = FrameGroups[Frame].AddDefaulted_GetRef();
+				Group.Query = Query;
+				Submit(Group);
+				NumUnique++;
+			}
+		}
+	}
+	const double SubmitSeconds = FPlatformTime::Seconds() - SubmitStart;
+
+	// The scene queries the async trace threads then run for it, timed inline since their tasks can't be timed alone
+	const double AsyncStart = FPlatformTime::Seconds();
+	for (const TArray<FGroup>& Groups : FrameGroups)
+	{
+		for (const FGroup& Group : Groups)
+		{
+			Hits.Reset();
+			Execute(Group.Query, Hits);
+		}
+	}
+	const double AsyncSeconds = FPlatformTime::Seconds() - AsyncStart;
+
+	const double MsPerFrame = 1000.0 / FMath::Max(NumFrames, 1);
+	UE_LOG(LogTemp, Display, TEXT("QueryBatch benchmark: %d players, %d bots, %d frames, %d queries"), NumPlayers, NumBots, NumFrames, NumQueries);
+	UE_LOG(LogTemp, Display, TEXT("  immediate: %.3f ms/frame on the game thread"), DirectSeconds * MsPerFrame);
+	UE_LOG(LogTemp, Display, TEXT("  batched: %.3f ms/frame on the game thread to submit %d unique queries (%.1f%% shared), %.3f ms/frame on the async trace threads"),
+		SubmitSeconds * MsPerFrame, NumUnique, 100.0 * (NumQueries - NumUnique) / FMath::Max(NumQueries, 1), AsyncSeconds * MsPerFrame);
+	UE_LOG(LogTemp, Display, TEXT("  live so far: %d requested, %d submitted"), NumRequested, NumSubmitted);
+}
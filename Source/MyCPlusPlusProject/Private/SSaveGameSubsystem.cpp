@@ -0,0 +1,497 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SSaveGameSubsystem.h"
+
+#include "SExplosiveBarrel.h"
+#include "SFrameCost.h"
+#include "SItemChest.h"
+#include "SPropInstanceManager.h"
+#include "Async/Async.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/SoftObjectPath.h"
+
+static TAutoConsoleVariable<int32> CVarSaveApplyBatch(
+	TEXT("s.Save.ApplyBatch"),
+	2048,
+	TEXT("Saved records read and applied per frame while a save loads."),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs SaveGameCommand(
+	TEXT("s.Save.Save"),
+	TEXT("Saves the state of interactive objects. Usage: s.Save.Save [Name]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USSaveGameSubsystem* Save = World ? World->GetSubsystem<USSaveGameSubsystem>() : nullptr)
+		{
+			Save->SaveGame(Args.Num() > 0 ? Args[0] : TEXT("Quick"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs LoadGameCommand(
+	TEXT("s.Save.Load"),
+	TEXT("Loads the state of interactive objects, right after the map loads. Usage: s.Save.Load [Name]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USSaveGameSubsystem* Save = World ? World->GetSubsystem<USSaveGameSubsystem>() : nullptr)
+		{
+			Save->LoadGame(Args.Num() > 0 ? Args[0] : TEXT("Quick"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs SaveBenchmarkCommand(
+	TEXT("s.Save.Benchmark"),
+	TEXT("Times saving and loading synthetic records. Usage: s.Save.Benchmark [Count]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (USSaveGameSubsystem* Save = World ? World->GetSubsystem<USSaveGameSubsystem>() : nullptr)
+		{
+			Save->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000);
+		}
+	}));
+
+FSSaveKey::FSSaveKey(const UObject* Object, int32 InIndex)
+	: Package(*UWorld::RemovePIEPrefix(Object->GetOutermost()->GetName()))
+	, Path(*UWorld::RemovePIEPrefix(Object->GetPathName()))
+	, Index(InIndex)
+{
+}
+
+void USSaveGameSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Streamed cells come back in their as-loaded state, their records have to be applied again
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &USSaveGameSubsystem::OnLevelAdded);
+}
+
+void USSaveGameSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+	StopLoading();
+
+	Super::Deinitialize();
+}
+
+void USSaveGameSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString Name;
+	if (InWorld.IsGameWorld() && FParse::Value(FCommandLine::Get(), TEXT("LoadGame="), Name))
+	{
+		LoadGame(Name);
+	}
+}
+
+TStatId USSaveGameSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USSaveGameSubsystem, STATGROUP_Tickables);
+}
+
+FString USSaveGameSubsystem::ResolvePath(const FString& Name)
+{
+	const FString FileName = FPaths::GetExtension(Name).IsEmpty() ? Name + TEXT(".sav") : Name;
+	return FPaths::IsRelative(FileName) ? FPaths::ProjectSavedDir() / TEXT("SaveGames") / FileName : FileName;
+}
+
+FSSaveKey USSaveGameSubsystem::GetSaveKey(const AActor* Actor)
+{
+	if (!Actor)
+	{
+		return FSSaveKey();
+	}
+
+	// Promoted props are spawned at runtime, they are saved as the instance they came from
+	if (const ASExplosiveBarrel* Barrel = Cast<ASExplosiveBarrel>(Actor))
+	{
+		if (Barrel->GetSaveKey().IsValid())
+		{
+			return Barrel->GetSaveKey();
+		}
+	}
+	else if (const ASItemChest* Chest = Cast<ASItemChest>(Actor))
+	{
+		if (Chest->GetSaveKey().IsValid())
+		{
+			return Chest->GetSaveKey();
+		}
+	}
+
+	return Actor->HasAnyFlags(RF_WasLoaded) ? FSSaveKey(Actor) : FSSaveKey();
+}
+
+void USSaveGameSubsystem::MarkChanged(const FSSaveKey& Key, ESSaveFlags Flags)
+{
+	if (Key.IsValid())
+	{
+		Records.FindOrAdd(Key, ESSaveFlags::None) |= Flags;
+	}
+}
+
+void USSaveGameSubsystem::MarkChanged(const AActor* Actor, ESSaveFlags Flags)
+{
+	MarkChanged(GetSaveKey(Actor), Flags);
+}
+
+void USSaveGameSubsystem::MakeSnapshot(const TMap<FSSaveKey, ESSaveFlags>& InRecords, FSnapshot& OutSnapshot)
+{
+	// Instances of one component share their path, the table stores it once
+	TMap<FName, int32> PathIndices;
+	PathIndices.Reserve(InRecords.Num());
+
+	OutSnapshot.PathIndices.Reserve(InRecords.Num());
+	OutSnapshot.Indices.Reserve(InRecords.Num());
+	OutSnapshot.Flags.Reserve(InRecords.Num());
+
+	for (const TPair<FSSaveKey, ESSaveFlags>& Record : InRecords)
+	{
+		int32 PathIndex;
+		if (const int32* Found = PathIndices.Find(Record.Key.Path))
+		{
+			PathIndex = *Found;
+		}
+		else
+		{
+			PathIndex = OutSnapshot.Paths.Add(Record.Key.Path);
+			PathIndices.Add(Record.Key.Path, PathIndex);
+		}
+
+		OutSnapshot.PathIndices.Add(PathIndex);
+		OutSnapshot.Indices.Add(Record.Key.Index);
+		OutSnapshot.Flags.Add(Record.Value);
+	}
+}
+
+void USSaveGameSubsystem::SerializeSnapshot(const FSnapshot& Snapshot, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reserve(16 + Snapshot.Paths.Num() * 96 + Snapshot.Flags.Num() * 9);
+	FMemoryWriter Ar(OutBytes, true);
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	int32 NumPaths = Snapshot.Paths.Num();
+	int32 NumRecords = Snapshot.Flags.Num();
+	Ar << Magic << Version << NumPaths << NumRecords;
+
+	// Written as text, FName indices are only meaningful inside the process that created them
+	for (const FName& Path : Snapshot.Paths)
+	{
+		FString PathString = Path.ToString();
+		Ar << PathString;
+	}
+
+	for (int32 i = 0; i < NumRecords; i++)
+	{
+		int32 PathIndex = Snapshot.PathIndices[i];
+		int32 Index = Snapshot.Indices[i];
+		uint8 Flags = (uint8)Snapshot.Flags[i];
+		Ar << PathIndex << Index << Flags;
+	}
+}
+
+bool USSaveGameSubsystem::ReadHeader(FArchive& Ar, TArray<FSSaveKey>& OutKeys, int32& OutNumRecords)
+{
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 NumPaths = 0;
+	Ar << Magic << Version << NumPaths << OutNumRecords;
+	if (Ar.IsError() || Magic != FileMagic || Version != FileVersion || NumPaths < 0 || OutNumRecords < 0)
+	{
+		return false;
+	}
+
+	// The counts come from the file, a corrupt one must not make us allocate for records that can't be in it.
+	// A path takes at least its length, a record exactly its three fields
+	constexpr int64 MinPathBytes = sizeof(int32);
+	constexpr int64 RecordBytes = sizeof(int32) + sizeof(int32) + sizeof(uint8);
+	if (NumPaths * MinPathBytes + OutNumRecords * RecordBytes > Ar.TotalSize() - Ar.Tell())
+	{
+		return false;
+	}
+
+	OutKeys.Reset(NumPaths);
+	for (int32 i = 0; i < NumPaths && !Ar.IsError(); i++)
+	{
+		FString Path;
+		Ar << Path;
+
+		FSSaveKey& Key = OutKeys.AddDefaulted_GetRef();
+		Key.Package = *FPackageName::ObjectPathToPackageName(Path);
+		Key.Path = *Path;
+	}
+	return !Ar.IsError() && OutNumRecords * RecordBytes <= Ar.TotalSize() - Ar.Tell();
+}
+
+void USSaveGameSubsystem::ReadRecord(FArchive& Ar, const TArray<FSSaveKey>& Keys, FSSaveKey& OutKey, ESSaveFlags& OutFlags)
+{
+	int32 PathIndex = 0;
+	int32 Index = INDEX_NONE;
+	uint8 Flags = 0;
+	Ar << PathIndex << Index << Flags;
+
+	if (!Keys.IsValidIndex(PathIndex))
+	{
+		Ar.SetError();
+		return;
+	}
+
+	OutKey = Keys[PathIndex];
+	OutKey.Index = Index;
+	OutFlags = (ESSaveFlags)Flags;
+}
+
+void USSaveGameSubsystem::SaveGame(const FString& Name)
+{
+	// One save in flight at a time, they write the same kind of file and must land in order
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	FSnapshot Snapshot;
+	MakeSnapshot(Records, Snapshot);
+	const double SnapshotMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	PendingSave = Async(EAsyncExecution::ThreadPool, [Snapshot = MoveTemp(Snapshot), Path = ResolvePath(Name), SnapshotMs]()
+	{
+		const double SerializeStartTime = FPlatformTime::Seconds();
+		TArray<uint8> Bytes;
+		SerializeSnapshot(Snapshot, Bytes);
+
+		// Through a temporary file, a crash while writing keeps the previous save
+		const FString TempPath = Path + TEXT(".tmp");
+		const bool bSaved = FFileHelper::SaveArrayToFile(Bytes, *TempPath) && IFileManager::Get().Move(*Path, *TempPath);
+		if (!bSaved)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Save: can't write %s"), *Path);
+			return;
+		}
+
+		UE_LOG(LogTemp, Display, TEXT("Save: %d records to %s, %.1f KB, snapshot %.2f ms on the game thread, serialize and write %.2f ms"),
+			Snapshot.Flags.Num(), *Path, Bytes.Num() / 1024.0, SnapshotMs, (FPlatformTime::Seconds() - SerializeStartTime) * 1000.0);
+	});
+}
+
+bool USSaveGameSubsystem::LoadGame(const FString& Name)
+{
+	StopLoading();
+
+	const FString Path = ResolvePath(Name);
+	LoadFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	if (LoadFile)
+	{
+		LoadRegion.Reset(LoadFile->MapRegion(0, LoadFile->GetFileSize()));
+	}
+	if (!LoadRegion)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Save: can't map %s"), *Path);
+		StopLoading();
+		return false;
+	}
+
+	LoadReader = MakeUnique<FMemoryReaderView>(FMemoryView(LoadRegion->GetMappedPtr(), LoadRegion->GetMappedSize()), true);
+	if (!ReadHeader(*LoadReader, LoadKeys, LoadRecordsRemaining))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Save: %s is not a version %u save"), *Path, FileVersion);
+		StopLoading();
+		return false;
+	}
+
+	Records.Reset();
+	Records.Reserve(LoadRecordsRemaining);
+	ApplyQueue.Reset();
+	LoadStartTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Display, TEXT("Save: loading %d records from %s"), LoadRecordsRemaining, *Path);
+	return true;
+}
+
+void USSaveGameSubsystem::StopLoading()
+{
+	LoadReader.Reset();
+	LoadRegion.Reset();
+	LoadFile.Reset();
+	LoadKeys.Reset();
+	LoadRecordsRemaining = 0;
+}
+
+void USSaveGameSubsystem::ReadLoadBatch(int32 BatchSize)
+{
+	const int32 NumToRead = FMath::Min(BatchSize, LoadRecordsRemaining);
+	for (int32 i = 0; i < NumToRead; i++)
+	{
+		FSSaveKey Key;
+		ESSaveFlags Flags = ESSaveFlags::None;
+		ReadRecord(*LoadReader, LoadKeys, Key, Flags);
+		if (LoadReader->IsError())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Save: truncated or corrupt save, %d records were not loaded"), LoadRecordsRemaining - i);
+			StopLoading();
+			return;
+		}
+
+		Records.Add(Key, Flags);
+		ApplyQueue.Add(Key);
+	}
+
+	LoadRecordsRemaining -= NumToRead;
+	if (LoadRecordsRemaining == 0)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Save: loaded %d records in %.2f ms"), Records.Num(), (FPlatformTime::Seconds() - LoadStartTime) * 1000.0);
+		StopLoading();
+	}
+}
+
+bool USSaveGameSubsystem::ApplyRecord(const FSSaveKey& Key, ESSaveFlags Flags)
+{
+	FSoftObjectPath ObjectPath(Key.Path.ToString());
+#if WITH_EDITOR
+	if (GetWorld()->IsPlayInEditor())
+	{
+		ObjectPath.FixupForPIE(GetWorld()->GetOutermost()->GetPIEInstanceID());
+	}
+#endif
+
+	// Not resolving means the object's level isn't loaded, the record is applied when it streams in
+	UObject* Object = ObjectPath.ResolveObject();
+	if (!Object)
+	{
+		return false;
+	}
+
+	if (const UHierarchicalInstancedStaticMeshComponent* Instances = Cast<UHierarchicalInstancedStaticMeshComponent>(Object))
+	{
+		ASPropInstanceManager* Manager = Cast<ASPropInstanceManager>(Instances->GetOwner());
+		return Manager && Manager->HasActorBegunPlay() && Manager->ApplySavedInstance(Instances, Key.Index, Flags);
+	}
+
+	AActor* Actor = Cast<AActor>(Object);
+	if (!Actor)
+	{
+		return false;
+	}
+
+	if (EnumHasAnyFlags(Flags, ESSaveFlags::Destroyed))
+	{
+		Actor->Destroy();
+	}
+	else if (ASItemChest* Chest = Cast<ASItemChest>(Actor); Chest && EnumHasAnyFlags(Flags, ESSaveFlags::Opened))
+	{
+		Chest->SetOpen();
+	}
+	return true;
+}
+
+void USSaveGameSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	S_SCOPED_FRAME_COST("SaveGame");
+
+	const int32 BatchSize = FMath::Max(1, CVarSaveApplyBatch.GetValueOnGameThread());
+	if (LoadReader)
+	{
+		ReadLoadBatch(BatchSize);
+	}
+
+	// Unresolved records are dropped from the queue, they come back when their level is added
+	const int32 NumToApply = FMath::Min(BatchSize, ApplyQueue.Num());
+	const int32 First = ApplyQueue.Num() - NumToApply;
+	for (int32 i = First; i < ApplyQueue.Num(); i++)
+	{
+		if (const ESSaveFlags* Flags = Records.Find(ApplyQueue[i]))
+		{
+			ApplyRecord(ApplyQueue[i], *Flags);
+		}
+	}
+	ApplyQueue.RemoveAt(First, NumToApply, false);
+}
+
+void USSaveGameSubsystem::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld() || !Level)
+	{
+		return;
+	}
+
+	const FName Package(*UWorld::RemovePIEPrefix(Level->GetOutermost()->GetName()));
+	for (const TPair<FSSaveKey, ESSaveFlags>& Record : Records)
+	{
+		if (Record.Key.Package == Package)
+		{
+			ApplyQueue.Add(Record.Key);
+		}
+	}
+}
+
+void USSaveGameSubsystem::RunBenchmark(int32 NumRecords)
+{
+	// A hundred exploded instances per prop manager, spread over as many managers as it takes
+	TMap<FSSaveKey, ESSaveFlags> BenchmarkRecords;
+	BenchmarkRecords.Reserve(NumRecords);
+	for (int32 i = 0; i < NumRecords; i++)
+	{
+		FSSaveKey Key;
+		Key.Package = TEXT("/Game/Maps/Benchmark");
+		Key.Path = *FString::Printf(TEXT("/Game/Maps/Benchmark.Benchmark:PersistentLevel.PropInstanceManager_%d.BarrelInstances"), i / 100);
+		Key.Index = i % 100;
+		BenchmarkRecords.Add(Key, ESSaveFlags::Exploded | ESSaveFlags::Destroyed);
+	}
+
+	const FString Path = ResolvePath(TEXT("Benchmark"));
+
+	const double StartTime = FPlatformTime::Seconds();
+	FSnapshot Snapshot;
+	MakeSnapshot(BenchmarkRecords, Snapshot);
+	const double SnapshotTime = FPlatformTime::Seconds();
+
+	TArray<uint8> Bytes;
+	SerializeSnapshot(Snapshot, Bytes);
+	const double SerializeTime = FPlatformTime::Seconds();
+
+	FFileHelper::SaveArrayToFile(Bytes, *Path);
+	const double WriteTime = FPlatformTime::Seconds();
+
+	// Same path as LoadGame, minus applying: map, read the header and every record into a fresh map
+	TMap<FSSaveKey, ESSaveFlags> LoadedRecords;
+	{
+		TUniquePtr<IMappedFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+		TUniquePtr<IMappedFileRegion> Region(File ? File->MapRegion(0, File->GetFileSize()) : nullptr);
+		if (Region)
+		{
+			FMemoryReaderView Reader(FMemoryView(Region->GetMappedPtr(), Region->GetMappedSize()), true);
+			TArray<FSSaveKey> Keys;
+			int32 NumLoaded = 0;
+			if (ReadHeader(Reader, Keys, NumLoaded))
+			{
+				LoadedRecords.Reserve(NumLoaded);
+				for (int32 i = 0; i < NumLoaded && !Reader.IsError(); i++)
+				{
+					FSSaveKey Key;
+					ESSaveFlags Flags = ESSaveFlags::None;
+					ReadRecord(Reader, Keys, Key, Flags);
+					LoadedRecords.Add(Key, Flags);
+				}
+			}
+		}
+	}
+	const double LoadTime = FPlatformTime::Seconds();
+
+	IFileManager::Get().Delete(*Path);
+
+	UE_LOG(LogTemp, Display, TEXT("Save benchmark: %d records (%d loaded back), %.1f KB: snapshot %.2f ms, serialize %.2f ms, write %.2f ms, map and read %.2f ms"),
+		NumRecords, LoadedRecords.Num(), Bytes.Num() / 1024.0, (SnapshotTime - StartTime) * 1000.0, (SerializeTime - SnapshotTime) * 1000.0,
+		(WriteTime - SerializeTime) * 1000.0, (LoadTime - WriteTime) * 1000.0);
+}
@@ -0,0 +1,303 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SSoakTestSubsystem.h"
+
+#include "SBotController.h"
+#include "SCharacter.h"
+#include "SFrameCost.h"
+#include "SGameplayRandomSubsystem.h"
+#include "SObjectChurnProbe.h"
+#include "SProjectileSubsystem.h"
+#include "EngineUtils.h"
+#include "GameFramework/GameModeBase.h"
+
+static FAutoConsoleCommandWithWorldAndArgs SoakStartCommand(
+	TEXT("s.Soak.Start"),
+	TEXT("Spawns bots that play for a while, then logs frame costs. Usage: s.Soak.Start <Bots> <Seconds> [Seed]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		USSoakTestSubsystem* Soak = World ? World->GetSubsystem<USSoakTestSubsystem>() : nullptr;
+		if (!Soak)
+		{
+			return;
+		}
+
+		const int32 NumBots = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 32;
+		const float Duration = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 60.0f;
+		const int32 Seed = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : World->GetSubsystem<USGameplayRandomSubsystem>()->GetSeed();
+		Soak->StartSoak(NumBots, Duration, Seed);
+	}));
+
+static FAutoConsoleCommandWithWorld SoakStopCommand(
+	TEXT("s.Soak.Stop"),
+	TEXT("Ends the running soak test early and logs its report."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (USSoakTestSubsystem* Soak = World ? World->GetSubsystem<USSoakTestSubsystem>() : nullptr)
+		{
+			Soak->StopSoak();
+		}
+	}));
+
+void USSoakTestSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Headless runs, -SoakBots=N -SoakSeconds=S [-SoakSeed=X]
+	int32 NumBots = 0;
+	if (!InWorld.IsGameWorld() || !FParse::Value(FCommandLine::Get(), TEXT("SoakBots="), NumBots) || NumBots <= 0)
+	{
+		return;
+	}
+
+	float Duration = 60.0f;
+	int32 Seed = InWorld.GetSubsystem<USGameplayRandomSubsystem>()->GetSeed();
+	FParse::Value(FCommandLine::Get(), TEXT("SoakSeconds="), Duration);
+	FParse::Value(FCommandLine::Get(), TEXT("SoakSeed="), Seed);
+
+	bExitWhenDone = true;
+	StartSoak(NumBots, Duration, Seed);
+}
+
+void USSoakTestSubsystem::Deinitialize()
+{
+	if (bRunning)
+	{
+		LogReport();
+		if (FSObjectChurnProbe::Get().IsRunning())
+		{
+			FSObjectChurnProbe::Get().LogReport();
+			FSObjectChurnProbe::Get().Stop();
+		}
+	}
+	Super::Deinitialize();
+}
+
+void USSoakTestSubsystem::StartSoak(int32 NumBots, float Duration, int32 Seed)
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Soak: bots only run on the server"));
+		return;
+	}
+
+	if (bRunning)
+	{
+		StopSoak();
+	}
+
+	SpawnBots(NumBots, Seed);
+
+	bRunning = true;
+	TimeRemaining = Duration;
+	ProbeTimeRemaining = FMath::Min(ProbeWarmup, Duration * 0.5f);
+	NumFrames = 0;
+	TotalFrameSeconds = 0.0;
+	MaxFrameSeconds = 0.0;
+	MemorySampleTime = 0.0f;
+	PeakMemory.Reset();
+	LiveProjectileSamples.Reset();
+	FSFrameCost::Reset();
+
+	UE_LOG(LogTemp, Display, TEXT("Soak: started with %d bots for %.0f seconds, seed %d"), Bots.Num(), Duration, Seed);
+}
+
+void USSoakTestSubsystem::StopSoak()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	bRunning = false;
+	SampleMemory();
+	bool bWithinBudget = LogReport();
+	if (FSObjectChurnProbe::Get().IsRunning())
+	{
+		bWithinBudget &= FSObjectChurnProbe::Get().LogReport() == 0;
+		FSObjectChurnProbe::Get().Stop();
+	}
+	DestroyBots();
+
+	if (bExitWhenDone)
+	{
+		// Non-zero exit code so build machines fail the run
+		FPlatformMisc::RequestExitWithStatus(false, bWithinBudget ? 0 : 1);
+	}
+}
+
+void USSoakTestSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!bRunning)
+	{
+		return;
+	}
+
+	// Real frame time, not the clamped or dilated game delta
+	const double FrameSeconds = FApp::GetDeltaTime();
+	NumFrames++;
+	TotalFrameSeconds += FrameSeconds;
+	MaxFrameSeconds = FMath::Max(MaxFrameSeconds, FrameSeconds);
+
+	MemorySampleTime -= DeltaTime;
+	if (MemorySampleTime <= 0.0f)
+	{
+		MemorySampleTime = MemorySampleInterval;
+		SampleMemory();
+	}
+
+	if (ProbeTimeRemaining > 0.0f)
+	{
+		ProbeTimeRemaining -= DeltaTime;
+		if (ProbeTimeRemaining <= 0.0f)
+		{
+			FSObjectChurnProbe::Get().Start();
+		}
+	}
+
+	TimeRemaining -= DeltaTime;
+	if (TimeRemaining <= 0.0f)
+	{
+		StopSoak();
+	}
+}
+
+TStatId USSoakTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USSoakTestSubsystem, STATGROUP_Tickables);
+}
+
+FVector USSoakTestSubsystem::FindSpawnCenter() const
+{
+	if (const APlayerController* PC = GetWorld()->GetFirstPlayerController())
+	{
+		if (const APawn* Pawn = PC->GetPawn())
+		{
+			return Pawn->GetActorLocation();
+		}
+	}
+
+	// Headless runs have no player
+	if (AGameModeBase* GameMode = GetWorld()->GetAuthGameMode())
+	{
+		if (const AActor* Start = GameMode->FindPlayerStart(nullptr))
+		{
+			return Start->GetActorLocation();
+		}
+	}
+	return FVector::ZeroVector;
+}
+
+void USSoakTestSubsystem::SpawnBots(int32 NumBots, int32 Seed)
+{
+	// Same pawn as the players so bots carry the same projectile classes and meshes
+	TSubclassOf<ASCharacter> BotClass = ASCharacter::StaticClass();
+	if (const AGameModeBase* GameMode = GetWorld()->GetAuthGameMode())
+	{
+		if (GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf(ASCharacter::StaticClass()))
+		{
+			BotClass = GameMode->DefaultPawnClass.Get();
+		}
+	}
+
+	const FVector Center = FindSpawnCenter();
+	FRandomStream Random(Seed);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	for (int32 i = 0; i < NumBots; i++)
+	{
+		const FVector2D Offset = FVector2D(Random.GetUnitVector()).GetSafeNormal() * SpawnRadius * FMath::Sqrt(Random.FRand());
+		const FVector Location = Center + FVector(Offset, 0.0f);
+		const FRotator Rotation(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f);
+
+		ASCharacter* Bot = GetWorld()->SpawnActor<ASCharacter>(BotClass, Location, Rotation, SpawnParams);
+		if (!Bot)
+		{
+			continue;
+		}
+
+		ASBotController* Controller = GetWorld()->SpawnActor<ASBotController>();
+		Controller->SetRandomSeed(Seed + i);
+		Controller->Possess(Bot);
+
+		Bots.Add(Bot);
+		BotControllers.Add(Controller);
+	}
+}
+
+void USSoakTestSubsystem::DestroyBots()
+{
+	for (ASBotController* Controller : BotControllers)
+	{
+		if (IsValid(Controller))
+		{
+			Controller->Destroy();
+		}
+	}
+	for (APawn* Bot : Bots)
+	{
+		if (IsValid(Bot))
+		{
+			Bot->Destroy();
+		}
+	}
+	BotControllers.Reset();
+	Bots.Reset();
+}
+
+void USSoakTestSubsystem::SampleMemory()
+{
+	TArray<FSMemoryBudgetEntry> Entries;
+	FSMemoryBudget::Gather(GetWorld(), Entries);
+	FSMemoryBudget::AccumulatePeak(Entries, PeakMemory);
+
+	if (const USProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<USProjectileSubsystem>())
+	{
+		LiveProjectileSamples.Add(Projectiles->GetNumLive());
+	}
+}
+
+bool USSoakTestSubsystem::LogReport() const
+{
+	int32 NumActors = 0;
+	for (FActorIterator It(GetWorld()); It; ++It)
+	{
+		NumActors++;
+	}
+
+	const int32 Frames = FMath::Max(NumFrames, 1);
+	UE_LOG(LogTemp, Display, TEXT("Soak: %d bots, %d frames, %.2f ms/frame average, %.2f ms worst, %d actors alive"),
+		Bots.Num(), NumFrames, TotalFrameSeconds * 1000.0 / Frames, MaxFrameSeconds * 1000.0, NumActors);
+	FSFrameCost::LogReport(NumFrames);
+
+	// First against last quarter of the run, a leak shows as a count that keeps climbing
+	if (LiveProjectileSamples.Num() >= 4)
+	{
+		const int32 Quarter = LiveProjectileSamples.Num() / 4;
+		int32 First = 0;
+		int32 Last = 0;
+		for (int32 i = 0; i < Quarter; i++)
+		{
+			First += LiveProjectileSamples[i];
+			Last += LiveProjectileSamples[LiveProjectileSamples.Num() - 1 - i];
+		}
+		const float FirstAverage = (float)First / Quarter;
+		const float LastAverage = (float)Last / Quarter;
+		const USProjectileSubsystem* Projectiles = GetWorld()->GetSubsystem<USProjectileSubsystem>();
+
+		UE_LOG(LogTemp, Display, TEXT("Soak: live projectiles %.1f in the first quarter, %.1f in the last, %d at peak, %d pooled"),
+			FirstAverage, LastAverage, FMath::Max(LiveProjectileSamples), Projectiles ? Projectiles->GetNumPooled() : 0);
+		if (LastAverage > FirstAverage * 1.5f + 8.0f)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Soak: live projectiles keep growing"));
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Soak: peak memory"));
+	return FSMemoryBudget::LogReport(PeakMemory) == 0;
+}
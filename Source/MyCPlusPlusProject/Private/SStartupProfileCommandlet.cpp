@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SStartupProfileCommandlet.h"
+
+#include "MyCPlusPlusProject.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+USStartupProfileCommandlet::USStartupProfileCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 USStartupProfileCommandlet::Main(const FString& Params)
+{
+	const double CommandletSeconds = FPlatformTime::Seconds() - GStartTime;
+
+	int32 Iterations = 100;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	ProfileConstruction(FMath::Max(Iterations, 1));
+
+	UE_LOG(LogTemp, Display, TEXT("Editor boot: module loaded at %.2f s, engine initialized at %.2f s, commandlet started at %.2f s"),
+		FMyCPlusPlusProjectModule::LoadedSeconds, FMyCPlusPlusProjectModule::EngineInitSeconds, CommandletSeconds);
+
+	if (!FParse::Param(*Params, TEXT("NoGame")))
+	{
+		FString Map;
+		FParse::Value(*Params, TEXT("Map="), Map);
+
+		const double GameSeconds = ProfileGameBoot(Map);
+		if (GameSeconds < 0.0)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Game boot: couldn't launch the game"));
+			return 1;
+		}
+		UE_LOG(LogTemp, Display, TEXT("Game boot: first map loaded and exited after %.2f s, the game's own log has the breakdown"), GameSeconds);
+	}
+
+	return 0;
+}
+
+void USStartupProfileCommandlet::ProfileConstruction(int32 Iterations) const
+{
+	struct FClassCost
+	{
+		UClass* Class;
+		double Seconds;
+		int32 NumSubobjects;
+	};
+
+	const FName ModulePackage(TEXT("/Script/MyCPlusPlusProject"));
+
+	TArray<FClassCost> Costs;
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		if (Class->GetOutermost()->GetFName() != ModulePackage || Class->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists)
+			|| Class->IsChildOf<UCommandlet>())
+		{
+			continue;
+		}
+
+		TArray<UObject*> Subobjects;
+		Class->GetDefaultObject()->GetDefaultSubobjects(Subobjects);
+
+		// Archetypes run the constructor without registering with a world, like the CDO does
+		TArray<UObject*> Objects;
+		Objects.Reserve(Iterations);
+		const double Start = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; i++)
+		{
+			Objects.Add(NewObject<UObject>(GetTransientPackage(), Class, NAME_None, RF_ArchetypeObject | RF_Transient));
+		}
+		const double Seconds = (FPlatformTime::Seconds() - Start) / Iterations;
+
+		for (UObject* Object : Objects)
+		{
+			Object->MarkAsGarbage();
+		}
+		Costs.Add({ Class, Seconds, Subobjects.Num() });
+	}
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	Costs.Sort([](const FClassCost& A, const FClassCost& B) { return A.Seconds > B.Seconds; });
+
+	double TotalSeconds = 0.0;
+	UE_LOG(LogTemp, Display, TEXT("Construction of %d classes, %d times each:"), Costs.Num(), Iterations);
+	for (const FClassCost& Cost : Costs)
+	{
+		UE_LOG(LogTemp, Display, TEXT("  %-40s %8.2f us  %2d default subobjects"), *Cost.Class->GetName(), Cost.Seconds * 1000000.0, Cost.NumSubobjects);
+		TotalSeconds += Cost.Seconds;
+	}
+	UE_LOG(LogTemp, Display, TEXT("  one of each: %.3f ms"), TotalSeconds * 1000.0);
+}
+
+double USStartupProfileCommandlet::ProfileGameBoot(const FString& Map) const
+{
+	const FString Args = FString::Printf(TEXT("\"%s\" %s -game -nullrhi -nosound -unattended -SStartupExit"),
+		*FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()), *Map);
+
+	const double Start = FPlatformTime::Seconds();
+	FProcHandle Process = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *Args, true, false, false, nullptr, 0, nullptr, nullptr);
+	if (!Process.IsValid())
+	{
+		return -1.0;
+	}
+
+	FPlatformProcess::WaitForProc(Process);
+	FPlatformProcess::CloseProc(Process);
+	return FPlatformTime::Seconds() - Start;
+}
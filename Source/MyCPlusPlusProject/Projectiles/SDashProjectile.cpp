@@ -3,6 +3,10 @@
 
 #include "SDashProjectile.h"
 
+#include "SCharacterMovementComponent.h"
+#include "SGameplayEventSubsystem.h"
+#include "SGameplaySettings.h"
+#include "GameFramework/Character.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
@@ -30,14 +34,22 @@ ASDashProjectile::ASDashProjectile()
 	
 	// Create and configure the projectile movement component
 	MovementComp = CreateDefaultSubobject<UProjectileMovementComponent>(TEXT("MovementComp"));
-	MovementComp->InitialSpeed = 2000.0f; // Set how fast the projectile moves
+	Speed = USGameplaySettings::GetStartupConstants().DashSpeed;
+	MovementComp->InitialSpeed = Speed; // Set how fast the projectile moves
 	MovementComp->bRotationFollowsVelocity = true; // Make projectile rotate to match its movement direction
 	MovementComp->bInitialVelocityInLocalSpace = true; // Use local space for initial velocity
 }
 
 void ASDashProjectile::TeleportInstigator()
 {
-	UE_LOG(LogTemp, Warning, TEXT("SDashProjectile: TeleportInstigator instance with ID %s"), *UniqueID.ToString());
+	UE_LOG(LogTemp, Verbose, TEXT("SDashProjectile: TeleportInstigator instance with ID %s"), *UniqueID.ToString());
+
+	// Clients only simulate a cosmetic copy of the dash, the server teleports and movement replication follows
+	if (GetNetMode() == NM_Client)
+	{
+		Destroy();
+		return;
+	}
 
 	AActor* ActorToTeleport = GetInstigator();
 	// Check if instigator is valid before proceeding
@@ -48,28 +60,53 @@ void ASDashProjectile::TeleportInstigator()
 		return;
 	}
 
+	// Predicted dash, the movement component already moved the character on client and server alike
+	if (const ACharacter* Character = Cast<ACharacter>(ActorToTeleport))
+	{
+		if (Character->GetCharacterMovement()->IsA<USCharacterMovementComponent>())
+		{
+			Destroy();
+			return;
+		}
+	}
+
 
 	// Keep instigator rotation or it may end up jarring
-	UE_LOG(LogTemp, Warning, TEXT("SDashProjectile: Teleporting instigator"));
+	UE_LOG(LogTemp, Verbose, TEXT("SDashProjectile: Teleporting instigator"));
 	FVector NewLocation = GetActorLocation();
 	NewLocation.Z += 100.0f;
-	ActorToTeleport->TeleportTo(NewLocation, ActorToTeleport->GetActorRotation(), false, false);
+	if (USGameplayEventSubsystem* Events = GetWorld()->GetSubsystem<USGameplayEventSubsystem>())
+	{
+		FSGameplayEvent Event;
+		Event.Type = ESGameplayEventType::Teleported;
+		Event.Source = this;
+		Event.Target = ActorToTeleport;
+		Event.Location = NewLocation;
+		Event.Rotation = ActorToTeleport->GetActorRotation();
+		Events->Post(Event);
+	}
+	else
+	{
+		ActorToTeleport->TeleportTo(NewLocation, ActorToTeleport->GetActorRotation(), false, false);
+	}
 	// Now we're ready to destroy self
-	UE_LOG(LogTemp, Warning, TEXT("SDashProjectile: About to destroy self"));
+	UE_LOG(LogTemp, Verbose, TEXT("SDashProjectile: About to destroy self"));
 	bool bDestroy = Destroy();
-	UE_LOG(LogTemp, Warning, TEXT("SDashProjectile: Destroyed %s"), bDestroy ? TEXT("true") : TEXT("false"));
+	UE_LOG(LogTemp, Verbose, TEXT("SDashProjectile: Destroyed %s"), bDestroy ? TEXT("true") : TEXT("false"));
 }
 
 void ASDashProjectile::Explode()
 {
-	UE_LOG(LogTemp, Warning, TEXT("SDashProjectile: Explode instance with ID %s"), *UniqueID.ToString());
+	UE_LOG(LogTemp, Verbose, TEXT("SDashProjectile: Explode instance with ID %s"), *UniqueID.ToString());
 
 	GetWorldTimerManager().ClearTimer(TimerHandle_DelayedDetonate);
 	SetActorEnableCollision(false);
 
 	if (EndEffectComp)
 	{
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EndEffectComp, GetActorLocation(), GetActorRotation());
+		// Pooled, one dash after another reuses the component instead of leaving garbage behind
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), EndEffectComp, GetActorLocation(), GetActorRotation(),
+			FVector(1.0f), true, EPSCPoolMethod::AutoRelease);
 	}
 
 	// Spawn actor at current location and rotation
@@ -86,10 +123,14 @@ void ASDashProjectile::BeginPlay()
 {
 	SphereComp->IgnoreActorWhenMoving(GetInstigator(), true);
 
+	// Tunable at runtime unless the blueprint overrides it
+	MovementComp->InitialSpeed = USGameplaySettings::Resolve(bOverride_Speed, Speed, &FSGameplayConstants::DashSpeed);
+	MovementComp->Velocity = GetActorForwardVector() * MovementComp->InitialSpeed;
+
 	Super::BeginPlay();
 
 	UniqueID = FGuid::NewGuid();
-	UE_LOG(LogTemp, Warning, TEXT("SDashProjectile: Created with ID %s"), *UniqueID.ToString());
+	UE_LOG(LogTemp, Verbose, TEXT("SDashProjectile: Created with ID %s"), *UniqueID.ToString());
 
 	
 	// Spawn beginning effect if assigned
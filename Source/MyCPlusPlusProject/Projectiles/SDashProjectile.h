@@ -48,6 +48,14 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Teleport")
 	float DetonateDelay;
 
+	// Travel speed, USGameplaySettings' DashSpeed like the predicted dash in USCharacterMovementComponent unless
+	// overridden here
+	UPROPERTY(EditDefaultsOnly, Category = "Teleport", meta = (EditCondition = "bOverride_Speed"))
+	float Speed;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Teleport", meta = (InlineEditConditionToggle))
+	uint8 bOverride_Speed : 1;
+
 	// Handle to cancel timer if we already hit something
 	FTimerHandle TimerHandle_DelayedDetonate;
 
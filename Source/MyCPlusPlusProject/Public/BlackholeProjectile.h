@@ -24,9 +24,6 @@ protected:
 	UPROPERTY(visibleanywhere, BlueprintReadWrite, Category= "Components")
 	USphereComponent* SphereComp;
 
-	UPROPERTY(visibleanywhere, BlueprintReadWrite, Category= "Components")
-	USphereComponent* SphereBlackHoleComp;
-
 	UPROPERTY(visibleanywhere, BlueprintReadWrite, Category= "Components")
 	UProjectileMovementComponent* MovementComp;
 
@@ -39,15 +36,48 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	// Animation parameters for the radial force
-	UPROPERTY(EditAnywhere, Category = "Force Animation")
-	float MinRadius = 1000.0f;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (InlineEditConditionToggle))
+	uint8 bOverride_MinRadius : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (InlineEditConditionToggle))
+	uint8 bOverride_MaxRadius : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (InlineEditConditionToggle))
+	uint8 bOverride_AnimationSpeed : 1;
+
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (InlineEditConditionToggle))
+	uint8 bOverride_ForceStrength : 1;
+
+	// Animation parameters for the radial force. USGameplaySettings' Blackhole constants are read every tick, so those
+	// can be tuned while blackholes are out, unless the blueprint overrides them here
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (EditCondition = "bOverride_MinRadius"))
+	float MinRadius;
+
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (EditCondition = "bOverride_MaxRadius"))
+	float MaxRadius;
+
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (EditCondition = "bOverride_AnimationSpeed"))
+	float AnimationSpeed;
+
+	// Given to RadialForceComp every tick, negative pulls
+	UPROPERTY(EditAnywhere, Category = "Force Animation", meta = (EditCondition = "bOverride_ForceStrength"))
+	float ForceStrength;
+
+	float GetMinRadius() const;
+	float GetMaxRadius() const;
+	float GetForceStrength() const;
+
+	// Dormant barrel instances this close are promoted to actors the pull can move, farther ones stay instances
+	UPROPERTY(EditDefaultsOnly, Category = "Blackhole", meta = (ClampMin = "0"))
+	float PromotionRadius = 1500.0f;
 
-	UPROPERTY(EditAnywhere, Category = "Force Animation")
-	float MaxRadius = 3000.0f;
+	// Seconds between promotion checks, a barrel rolling into the radius waits at most this long
+	UPROPERTY(EditDefaultsOnly, Category = "Blackhole", meta = (ClampMin = "0"))
+	float PromotionInterval = 0.25f;
 
-	UPROPERTY(EditAnywhere, Category = "Force Animation")
-	float AnimationSpeed = 2.0f;
+	float PromotionTimeRemaining = 0.0f;
 
 	// To track animation progress
 	float AnimationTime = 0.0f;
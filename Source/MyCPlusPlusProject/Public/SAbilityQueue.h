@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class ESAbility : uint8
+{
+	PrimaryAttack,
+	SpecialAttack,
+
+	Count
+};
+
+/*
+ * Buffered ability input for one character, advanced once per tick by its owner. No timers involved.
+ *
+ * Presses go into a small ring buffer. The front press is cast as soon as nothing else is casting and its ability
+ * is off cooldown: OnCastStart fires, then OnCastRelease once the cast time is over (the projectile leaves the
+ * hand). Cooldowns run from the start of a cast. Time is consumed exactly, if a cooldown ends halfway through a
+ * frame the next cast starts halfway through that frame, so throughput doesn't depend on the frame rate and the
+ * same presses at the same times always give the same casts.
+ *
+ * Presses that wait longer than BufferWindow are dropped, and so are presses beyond the buffer capacity.
+ */
+struct MYCPLUSPLUSPROJECT_API FSAbilityQueue
+{
+	static constexpr int32 Capacity = 8;
+
+	struct FSpec
+	{
+		float CastTime = 0.2f;
+		float Cooldown = 0.2f;
+	};
+
+	float BufferWindow = 0.3f;
+
+	void SetSpec(ESAbility Ability, float CastTime, float Cooldown);
+
+	// Returns false when the buffer is full and the press was dropped
+	bool Push(ESAbility Ability);
+
+	void Advance(float DeltaTime, TFunctionRef<void(ESAbility)> OnCastStart, TFunctionRef<void(ESAbility)> OnCastRelease);
+
+	// Ends the current cast early, for casts released by an animation notify. The cast time then only acts as
+	// a fallback for meshes that don't play the montage. Returns false when nothing was casting.
+	bool ReleaseCast(TFunctionRef<void(ESAbility)> OnCastRelease);
+
+	bool IsCasting() const { return Casting != ESAbility::Count; }
+	int32 GetNumPending() const { return NumPending; }
+	float GetCooldownRemaining(ESAbility Ability) const { return CooldownRemaining[(int32)Ability]; }
+	const FSpec& GetSpec(ESAbility Ability) const { return Specs[(int32)Ability]; }
+
+	void Reset();
+
+private:
+	FSpec Specs[(int32)ESAbility::Count];
+	float CooldownRemaining[(int32)ESAbility::Count] = {};
+
+	ESAbility Pending[Capacity];
+	// Queue clock at the time of each press
+	double PendingTime[Capacity];
+	int32 Head = 0;
+	int32 NumPending = 0;
+
+	ESAbility Casting = ESAbility::Count;
+	float CastRemaining = 0.0f;
+
+	// Advanced by every Advance call, only used to age buffered presses
+	double Clock = 0.0;
+
+	void Pop();
+	void AdvanceCooldowns(float Seconds);
+};
@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SAimAssistSubsystem.generated.h"
+
+struct FSAimQuery
+{
+	FVector Origin = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+
+	// Never picked, usually the one aiming
+	const AActor* Viewer = nullptr;
+};
+
+struct FSAimTarget
+{
+	AActor* Actor = nullptr;
+	FVector AimPoint = FVector::ZeroVector;
+};
+
+/*
+ * Bounding volume hierarchy over spheres. Built top down with median splits, then refit bottom up every frame as the
+ * candidates move: children are stored after their parent, so one reverse pass over the nodes updates every box.
+ */
+struct FSAimBVH
+{
+	struct FNode
+	{
+		FBox Bounds;
+		// Leaves reference Count items from First in Items, inner nodes have Count == 0 and their children at
+		// First and First + 1
+		int32 First = 0;
+		int32 Count = 0;
+	};
+
+	TArray<FNode> Nodes;
+	TArray<int32> Items;
+
+	void Build(TConstArrayView<FSphere> Spheres);
+
+	void Refit(TConstArrayView<FSphere> Spheres);
+
+	// Sum of the leaf box areas, refitting moving spheres makes it grow
+	float GetLeafArea() const;
+
+	// Calls Func(Item) for every sphere that may overlap the cone
+	template <typename FuncType>
+	void QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, FuncType Func) const;
+
+	static bool SphereInCone(const FVector& Center, float Radius, const FVector& Origin, const FVector& Direction,
+		float HalfAngle, float MaxDistance);
+
+private:
+	void BuildNode(int32 NodeIndex, int32 First, int32 Count, TConstArrayView<FSphere> Spheres);
+};
+
+template <typename FuncType>
+void FSAimBVH::QueryCone(const FVector& Origin, const FVector& Direction, float HalfAngle, float MaxDistance, FuncType Func) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+
+		FVector Center, Extent;
+		Node.Bounds.GetCenterAndExtents(Center, Extent);
+		if (!SphereInCone(Center, Extent.Size(), Origin, Direction, HalfAngle, MaxDistance))
+		{
+			continue;
+		}
+
+		if (Node.Count > 0)
+		{
+			for (int32 i = Node.First; i < Node.First + Node.Count; i++)
+			{
+				Func(Items[i]);
+			}
+		}
+		else
+		{
+			Stack.Add(Node.First);
+			Stack.Add(Node.First + 1);
+		}
+	}
+}
+
+/*
+ * Aim assist: picks the best target within a cone around the aim direction instead of tracing straight through the
+ * crosshair. Candidates are the registered characters (USGameplayRegistrySubsystem), props are only ever hit through
+ * the crosshair. Their bounding spheres are kept in a BVH that is refit every frame and rebuilt only when candidates
+ * come or go or the refit boxes got loose.
+ *
+ * A query walks the BVH, scores what is in the cone by angle and distance and traces line of sight to the best ones
+ * only, at most s.AimAssist.MaxTraces. Sorted candidates and line of sight results are cached for the frame, so a
+ * viewer asking again, or several viewers seeing the same target, don't trace again.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USAimAssistSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static bool IsEnabled();
+
+	bool FindTarget(const FSAimQuery& Query, FSAimTarget& OutTarget);
+
+	int32 GetNumCandidates() const { return Candidates.Num(); }
+
+protected:
+	TArray<TWeakObjectPtr<AActor>> Candidates;
+	TArray<FSphere> Spheres;
+	FSAimBVH BVH;
+
+	// Leaf area right after the last build, refitting past a multiple of it triggers a rebuild
+	float BuiltLeafArea = 0.0f;
+
+	struct FScoredCandidate
+	{
+		int32 Index;
+		float Score;
+	};
+
+	struct FViewCache
+	{
+		FVector Origin;
+		FVector Direction;
+		TArray<FScoredCandidate> Sorted;
+	};
+
+	// Per frame caches, keyed by viewer and by (viewer, candidate)
+	TMap<const AActor*, FViewCache> ViewCaches;
+	TMap<TPair<const AActor*, int32>, bool> LineOfSight;
+
+	void UpdateCandidates();
+
+	void GatherSorted(const FSAimQuery& Query, TArray<FScoredCandidate>& OutSorted) const;
+
+	bool HasLineOfSight(const FSAimQuery& Query, int32 Index);
+};
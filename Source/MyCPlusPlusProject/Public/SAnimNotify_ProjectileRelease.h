@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotify.h"
+#include "SAnimNotify_ProjectileRelease.generated.h"
+
+/*
+ * Place on the attack montage at the frame the hand throws. ASCharacter releases the projectile of the current
+ * cast when it fires instead of after a fixed delay.
+ */
+UCLASS(meta = (DisplayName = "Projectile Release"))
+class MYCPLUSPLUSPROJECT_API USAnimNotify_ProjectileRelease : public UAnimNotify
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
+
+	virtual FString GetNotifyName_Implementation() const override;
+};
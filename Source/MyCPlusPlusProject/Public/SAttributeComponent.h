@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SAttributeComponent.generated.h"
+
+class USAttributeComponent;
+
+UENUM(BlueprintType)
+enum class ESDamageType : uint8
+{
+	Magic,
+	Explosion,
+
+	Count UMETA(Hidden)
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_FourParams(FSOnHealthChanged, AActor*, InstigatorActor, USAttributeComponent*, OwningComp, float, NewHealth, float, Delta);
+
+/*
+ * Health and damage resistances of an actor. Damage isn't applied here directly: projectiles and explosions queue it
+ * with USDamageSubsystem, which adds up everything a target took during the frame and calls ApplyHealthChange once,
+ * so OnHealthChanged fires at most once per frame per target however many hits landed.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class MYCPLUSPLUSPROJECT_API USAttributeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	USAttributeComponent();
+
+	UPROPERTY(BlueprintAssignable, Category = "Attributes")
+	FSOnHealthChanged OnHealthChanged;
+
+	// Clamped to [0, MaxHealth], returns false if health didn't change. Server only, clients get the result replicated.
+	bool ApplyHealthChange(AActor* InstigatorActor, float Delta);
+
+	UFUNCTION(BlueprintCallable, Category = "Attributes")
+	float GetHealth() const { return Health; }
+
+	UFUNCTION(BlueprintCallable, Category = "Attributes")
+	bool IsAlive() const { return Health > 0.0f; }
+
+	// Fraction of incoming damage of this type that is ignored
+	float GetResistance(ESDamageType Type) const;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Slot in USDamageSubsystem's target list while registered
+	int32 DamageSlot = INDEX_NONE;
+
+protected:
+	UPROPERTY(EditDefaultsOnly, Category = "Attributes")
+	float MaxHealth = 100.0f;
+
+	UPROPERTY(ReplicatedUsing = OnRep_Health, VisibleInstanceOnly, Category = "Attributes")
+	float Health = 100.0f;
+
+	// 0 takes full damage, 1 is immune
+	UPROPERTY(EditDefaultsOnly, Category = "Attributes")
+	TMap<ESDamageType, float> Resistances;
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION()
+	void OnRep_Health(float OldHealth);
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "SBotController.generated.h"
+
+class ASCharacter;
+
+/*
+ * Load generating bot. Wanders in a random direction, picks a random barrel, chest or prop instance nearby as its
+ * focus and goes through the same abilities a player has: primary attack, blackhole, dash and interact. Everything
+ * runs through ASCharacter, so bots cost what players cost (minus input and camera).
+ * Spawned by USSoakTestSubsystem, doesn't need a nav mesh.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API ASBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+	ASBotController();
+
+	// Bots seeded alike act alike, the soak test seeds each one from its own seed and the bot index
+	void SetRandomSeed(int32 Seed);
+
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+	// Seconds between two abilities, picked at random in this range
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	FVector2D ActionInterval = FVector2D(0.5f, 2.0f);
+
+	// Seconds before picking a new direction to walk in
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float MoveChangeInterval = 3.0f;
+
+	// Targets are picked among props this close
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float TargetSearchRadius = 2000.0f;
+
+	// Relative weights of primary attack, blackhole, dash and interact
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	FVector4 ActionWeights = FVector4(5.0f, 1.5f, 1.5f, 2.0f);
+
+	FRandomStream Random;
+
+	FVector MoveDirection = FVector::ForwardVector;
+
+	float MoveTimeRemaining = 0.0f;
+	float ActionTimeRemaining = 0.0f;
+
+	void PickMoveDirection();
+
+	// Focuses a random prop in range, or a random point ahead when there is none
+	void PickTarget(const ASCharacter* Bot);
+
+	void PerformRandomAction(ASCharacter* Bot);
+};
@@ -4,13 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "SAbilityQueue.h"
+#include "SInputReplaySubsystem.h"
+#include "SReplicationTypes.h"
 #include "SCharacter.generated.h"
 
 class USInteractionComponent;
+class USAttributeComponent;
+class USLootItem;
 // when declaring pointers we don't need to care about the actual type
 class UCameraComponent;
 class USpringArmComponent;
 class UAnimMontage;
+struct FAnimUpdateRateParameters;
+
+DECLARE_DELEGATE_OneParam(FSInputActionDelegate, ESInputAction);
 
 UCLASS()
 class MYCPLUSPLUSPROJECT_API ASCharacter : public ACharacter
@@ -18,12 +26,14 @@ class MYCPLUSPLUSPROJECT_API ASCharacter : public ACharacter
 	GENERATED_BODY()
 public:
 	// Sets default values for this character's properties
-	ASCharacter();
+	ASCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UPROPERTY(VisibleAnywhere, Category="Attack")
 	UCameraComponent* CameraComp; // Pointer only needs to know the type exists
 
@@ -42,30 +52,156 @@ protected:
 	UPROPERTY(VisibleAnywhere, Category="Attack")
 	USInteractionComponent *InteractionComp;
 
+	UPROPERTY(VisibleAnywhere, Category="Attributes")
+	USAttributeComponent* AttributeComp;
+
+	UFUNCTION()
+	void OnHealthChanged(AActor* InstigatorActor, USAttributeComponent* OwningComp, float NewHealth, float Delta);
+
+	virtual void PostInitializeComponents() override;
+
 	UPROPERTY(EditAnywhere, Category="Attack")
 	UAnimMontage *AttackAnim;
 	
-	FTimerHandle TimerHandle_PrimaryAttack;
+	// Cast time is the delay between the montage starting and the projectile leaving the hand. When AttackAnim has
+	// a Projectile Release notify the notify releases the projectile and this is ignored.
+	// USGameplaySettings' values, following its reloads, unless the blueprint overrides them here.
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(EditCondition="bOverride_PrimaryAttackCastTime"))
+	float PrimaryAttackCastTime;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(EditCondition="bOverride_PrimaryAttackCooldown"))
+	float PrimaryAttackCooldown;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(EditCondition="bOverride_SpecialAttackCastTime"))
+	float SpecialAttackCastTime;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(EditCondition="bOverride_SpecialAttackCooldown"))
+	float SpecialAttackCooldown;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(InlineEditConditionToggle))
+	uint8 bOverride_PrimaryAttackCastTime : 1;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(InlineEditConditionToggle))
+	uint8 bOverride_PrimaryAttackCooldown : 1;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(InlineEditConditionToggle))
+	uint8 bOverride_SpecialAttackCastTime : 1;
+
+	UPROPERTY(EditDefaultsOnly, Category="Attack", meta=(InlineEditConditionToggle))
+	uint8 bOverride_SpecialAttackCooldown : 1;
+
+	// Sets the ability queue's cast times and cooldowns, again when the settings are reloaded
+	void ApplyAbilitySpecs();
+
+	FDelegateHandle ConstantsChangedHandle;
+
+	// Attack presses, advanced from Tick
+	FSAbilityQueue AbilityQueue;
+
+	void OnAbilityCastStart(ESAbility Ability);
+
+	void OnAbilityCastRelease(ESAbility Ability);
+
+	// Animation update rate tuning for crowds of characters, see the constructor
+	void OnAnimUpdateRateParamsCreated(FAnimUpdateRateParameters* Params);
+
+	bool HasProjectileReleaseNotify() const;
 
 	void MoveForward(float Value);
 
 	void MoveRigth(float X);
 
-	void PrimaryAttack_TimeElapsed();
+	// Live input lands here first so USInputReplaySubsystem can record it, or ignore it during a replay
+	void OnInputAxis(float Value, ESInputAxis Axis);
 
-	void PrimaryAttack();
+	void OnInputAction(ESInputAction Action);
 
-	void SpecialAttack();
+	void ApplyInputAxis(ESInputAxis Axis, float Value);
+
+	void ApplyInputAction(ESInputAction Action);
+
+	void PrimaryAttack_TimeElapsed();
 
 	void SpecialAttack_TimeElapsed();
 
-	void Dash();
+	// Crosshair ray: center of this player's part of the viewport, or the controller's view for AI
+	bool GetAimRay(FVector& OutOrigin, FVector& OutDirection) const;
+
+	// Where the character is aiming: focal point for AI, else the aim assist target or what the crosshair trace hits.
+	// Local players trace right away. Bots batch the trace (USQueryBatchSubsystem) and OnAimPoint is then called next frame if the character still exists.
+	void RequestAimPoint(TFunction<void(const FVector&)> OnAimPoint);
+
+	// Fires from the muzzle towards AimPoint
+	void FireProjectileAt(ESProjectileSlot Slot, const FVector& AimPoint);
+
+	// From the muzzle towards the aim point
+	void GetFireOriginAndDirection(const FVector& AimPoint, FVector& OutOrigin, FVector& OutDirection) const;
+
+	// Items picked up from chests
+	UPROPERTY(VisibleInstanceOnly, Category="Loot")
+	TArray<USLootItem*> Inventory;
+
+	// Server rejects projectile spawn events further than this from the character
+	UPROPERTY(EditDefaultsOnly, Category="Attack")
+	float MaxProjectileOriginDistance = 500.0f;
+
+	TSubclassOf<AActor> GetProjectileClass(ESProjectileSlot Slot) const;
+
+	// Spawns locally and sends the spawn event to the server (client) or to everyone else (server)
+	void FireProjectile(ESProjectileSlot Slot, const FVector& MuzzleLoc, const FVector& FireDir);
+
+	AActor* SpawnProjectileLocal(const FSProjectileSpawnEvent& Event, float CatchUpSeconds);
+
+	// Shots can arrive this much earlier than the ability allows, network jitter bunches them up
+	UPROPERTY(EditDefaultsOnly, Category="Attack")
+	float MaxFireJitter = 0.1f;
+
+	// Server world time from which each slot may fire again, indexed by ESProjectileSlot
+	float ServerNextFireTime[3] = {};
+
+	// Shortest time between two shots of the slot: the ability cooldown, one dash at a time
+	float GetMinFireInterval(ESProjectileSlot Slot) const;
+
+	// Rejects shots from too far away or faster than the slot can fire
+	bool AcceptServerFire(const FSProjectileSpawnEvent& Event);
+
+	UFUNCTION(Server, Reliable)
+	void ServerFireProjectile(const FSProjectileSpawnEvent& Event);
+
+	// The dash projectile is only a visual when the movement component predicts the dash, losing it is fine
+	UFUNCTION(Server, Unreliable)
+	void ServerFireCosmeticProjectile(const FSProjectileSpawnEvent& Event);
+
+	// Culled by the character's own relevancy, far away players never receive it
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileSpawned(const FSProjectileSpawnEvent& Event);
 
 public:	
+	// Explosions and absorptions relevant to this player, batched once per frame by USNetEventRelaySubsystem
+	UFUNCTION(Client, Unreliable)
+	void ClientReceiveWorldEvents(const TArray<FSNetWorldEvent>& Events);
+
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
 	void PrimaryInteract();
+
+	// Plays back one recorded frame of input
+	void ApplyInputFrame(const FSInputFrame& Frame);
+
+	// Called by USAnimNotify_ProjectileRelease on the attack montage
+	void OnProjectileReleaseNotify();
+
+	// Abilities, bound to input for players and called directly by ASBotController
+	void PrimaryAttack();
+
+	void SpecialAttack();
+
+	void Dash();
+
+	void AddToInventory(USLootItem* Item) { Inventory.Add(Item); }
+
+	const TArray<USLootItem*>& GetInventory() const { return Inventory; }
 	
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SCharacterMovementComponent.generated.h"
+
+// Move data sent to the server, a move that requests the dash also carries the dash projectile's path
+struct FSCharacterNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	FVector_NetQuantize10 DashOrigin;
+	FVector_NetQuantizeNormal DashDirection;
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FSCharacterNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FSCharacterNetworkMoveDataContainer();
+
+	FSCharacterNetworkMoveData MoveData[3];
+};
+
+/*
+ * Character movement with a predicted dash.
+ *
+ * The dash request travels to the server inside the saved move (a custom compressed flag, plus the dash projectile's
+ * origin and direction in FSCharacterNetworkMoveData), so client and server run the exact same dash on the exact same
+ * move: sweep along the path the dash projectile flies, wait for it to detonate (DetonateDelay) and teleport
+ * (TeleportDelay), then move to the landing spot. The owning client teleports right
+ * away instead of waiting for a round trip, and the server only sends a correction when its landing differs.
+ * ASDashProjectile is purely visual for characters using this component.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSSavedMove_SCharacter;
+
+public:
+	USCharacterMovementComponent();
+
+	// Called on the locally controlled character with the dash projectile's origin and direction, the dash starts on
+	// the next move
+	void RequestDash(const FVector& Origin, const FVector& Direction);
+
+	bool IsDashing() const { return DashTimeRemaining > 0.0f; }
+
+	// Same travel speed as the dash projectile, USGameplaySettings' and following its reloads unless the blueprint
+	// overrides it here
+	UPROPERTY(EditDefaultsOnly, Category = "Dash", meta = (EditCondition = "bOverride_DashSpeed"))
+	float DashSpeed;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Dash", meta = (InlineEditConditionToggle))
+	uint8 bOverride_DashSpeed : 1;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Dash")
+	float DetonateDelay = 0.5f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Dash")
+	float TeleportDelay = 0.3f;
+
+	// Landing is raised like ASDashProjectile::TeleportInstigator does
+	UPROPERTY(EditDefaultsOnly, Category = "Dash")
+	float TeleportHeightOffset = 100.0f;
+
+	// The server dashes from the character instead when the client's origin is further away than this
+	UPROPERTY(EditDefaultsOnly, Category = "Dash")
+	float MaxDashOriginDistance = 500.0f;
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+	uint8 bWantsToDash : 1;
+
+	// Time left until the teleport, zero when not dashing
+	float DashTimeRemaining = 0.0f;
+
+	FVector DashTarget = FVector::ZeroVector;
+
+	// Path of the dash projectile, set by RequestDash on the client and from the move data on the server
+	FVector DashOrigin = FVector::ZeroVector;
+	FVector DashDirection = FVector::ForwardVector;
+
+	FSCharacterNetworkMoveDataContainer NetworkMoveDataContainer;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+
+	void StartDash();
+
+	void FinishDash();
+};
+
+// Saved move carrying the dash request and the dash state needed to replay moves after a correction
+class FSSavedMove_SCharacter : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	uint8 bSavedWantsToDash : 1;
+	float SavedDashTimeRemaining = 0.0f;
+	FVector SavedDashTarget = FVector::ZeroVector;
+	FVector SavedDashOrigin = FVector::ZeroVector;
+	FVector SavedDashDirection = FVector::ForwardVector;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+};
+
+class FSNetworkPredictionData_Client_SCharacter : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FSNetworkPredictionData_Client_SCharacter(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SAttributeComponent.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDamageSubsystem.generated.h"
+
+// Damage to one target, a projectile hit
+struct FSDamageRecord
+{
+	TWeakObjectPtr<USAttributeComponent> Target;
+	TWeakObjectPtr<AActor> Instigator;
+	float Amount = 0.0f;
+	ESDamageType Type = ESDamageType::Magic;
+};
+
+// Damage to every target in range, falling off linearly to zero at the radius
+struct FSRadialDamageRecord
+{
+	FVector Origin = FVector::ZeroVector;
+	float Radius = 0.0f;
+	float Amount = 0.0f;
+	ESDamageType Type = ESDamageType::Explosion;
+	TWeakObjectPtr<AActor> Instigator;
+};
+
+/*
+ * Damage pipeline. Hits and explosions only append a record, the records are resolved once per frame after the actors
+ * ticked: every target adds up what it took per damage type, resistances are applied to the sums and each damaged
+ * target gets a single ApplyHealthChange. A chain of 100 barrels going off around a character is 100 records and one
+ * health update (and one OnHealthChanged).
+ *
+ * Radial records are tested against every registered target, attribute components are on characters only so the
+ * target list stays short. Damage is server side, clients get the health through replication.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void ApplyDamage(USAttributeComponent* Target, float Amount, ESDamageType Type, AActor* Instigator);
+
+	// Finds the target's attribute component, does nothing for actors without one
+	void ApplyDamage(AActor* TargetActor, float Amount, ESDamageType Type, AActor* Instigator);
+
+	void ApplyRadialDamage(const FVector& Origin, float Radius, float Amount, ESDamageType Type, AActor* Instigator);
+
+	// Called by USAttributeComponent in BeginPlay / EndPlay
+	void RegisterTarget(USAttributeComponent* Target);
+	void UnregisterTarget(USAttributeComponent* Target);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return PendingDamage.Num() > 0 || PendingRadialDamage.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+	// What a target took this frame, indexed by the target's DamageSlot
+	struct FSAccumulatedDamage
+	{
+		float Amount[(int32)ESDamageType::Count] = {};
+		AActor* Instigator = nullptr;
+		bool bDamaged = false;
+	};
+
+	TArray<FSDamageRecord> PendingDamage;
+	TArray<FSRadialDamageRecord> PendingRadialDamage;
+
+	UPROPERTY()
+	TArray<USAttributeComponent*> Targets;
+
+	TArray<FSAccumulatedDamage> Accumulated;
+
+	bool CanApplyDamage() const;
+
+	void AccumulatePointDamage();
+	void AccumulateRadialDamage();
+	void ApplyAccumulatedDamage();
+};
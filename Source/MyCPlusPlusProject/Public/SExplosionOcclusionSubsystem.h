@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SExplosionOcclusionSubsystem.generated.h"
+
+class UParticleSystem;
+
+// Explosion whose flames, impulse and damage only reach what the blast can see
+struct FSOccludedExplosion
+{
+	FVector Origin = FVector::ZeroVector;
+	float Radius = 0.0f;
+	float Impulse = 0.0f;
+	// Falloff and velocity change of the exploding barrel's radial force
+	TEnumAsByte<ERadialImpulseFalloff> Falloff = RIF_Constant;
+	bool bImpulseVelChange = true;
+	float Damage = 0.0f;
+	TWeakObjectPtr<UParticleSystem> FlameEffect;
+	// Instigator of the damage, ignored by the line of sight traces
+	TWeakObjectPtr<AActor> Source;
+};
+
+/*
+ * Occlusion for explosions. Without it a blast sets fire to, pushes and damages everything within its radius, walls
+ * included. Explosions queued here find their targets with one overlap query each, then check line of sight to every
+ * target with async line traces: all the traces of a frame's explosions are issued together and run in parallel
+ * with the rest of the frame, and the effects are applied when the results are in, on the next frame.
+ *
+ * Visibility is cached per (source cell, target) for s.Explosion.OcclusionCacheTime seconds, so a chain reaction in
+ * one room traces once per target and later explosions there apply immediately from the cache.
+ *
+ * s.Explosion.Occlusion 0 goes back to the unoccluded radius effects.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USExplosionOcclusionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static bool IsEnabled();
+
+	void QueueExplosion(const FSOccludedExplosion& Explosion);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return QueuedExplosions.Num() > 0 || WaitingExplosions.Num() > 0 || Cache.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+	struct FSOcclusionKey
+	{
+		FIntVector Cell;
+		TWeakObjectPtr<AActor> Target;
+
+		bool operator==(const FSOcclusionKey& Other) const { return Cell == Other.Cell && Target == Other.Target; }
+
+		friend uint32 GetTypeHash(const FSOcclusionKey& Key) { return HashCombine(GetTypeHash(Key.Cell), GetTypeHash(Key.Target)); }
+	};
+
+	struct FSOcclusionEntry
+	{
+		bool bVisible = true;
+		float Time = 0.0f;
+	};
+
+	struct FSExplosionRequest
+	{
+		FSOccludedExplosion Explosion;
+		FIntVector Cell;
+		// Overlapped components, several per actor share the actor's visibility
+		TArray<TWeakObjectPtr<UPrimitiveComponent>> Candidates;
+	};
+
+	TMap<FSOcclusionKey, FSOcclusionEntry> Cache;
+
+	// Traces issued this frame, read back on the next one
+	TMap<FSOcclusionKey, FTraceHandle> PendingTraces;
+
+	// Queued this frame, not gathered yet
+	TArray<FSExplosionRequest> QueuedExplosions;
+
+	// Waiting for trace results
+	TArray<FSExplosionRequest> WaitingExplosions;
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	void CollectTraceResults(float Now);
+
+	void GatherCandidates(FSExplosionRequest& Request) const;
+
+	// Issues traces for targets neither cached nor already being traced, returns false if any are pending
+	bool RequestVisibility(const FSExplosionRequest& Request, float Now);
+
+	bool IsVisible(const FSOcclusionKey& Key) const;
+
+	void ApplyExplosion(const FSExplosionRequest& Request);
+};
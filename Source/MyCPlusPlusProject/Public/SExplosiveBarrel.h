@@ -3,6 +3,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "SGameplaySettings.h"
+#include "SSaveGameSubsystem.h"
 #include "SExplosiveBarrel.generated.h"
 
 class USoundCue;
@@ -35,28 +37,90 @@ protected:
     UPROPERTY(EditAnywhere, Category = "Effects")
     UParticleSystem* FlameEffect;
 
+    UPROPERTY(EditAnywhere, Category = "Gameplay", meta = (InlineEditConditionToggle))
+    uint8 bOverride_ExplosionRadius : 1;
+
+    UPROPERTY(EditAnywhere, Category = "Gameplay", meta = (InlineEditConditionToggle))
+    uint8 bOverride_ExplosionImpulse : 1;
+
     // Raio do dano da explosão
-    UPROPERTY(EditAnywhere, Category = "Gameplay")
+    UPROPERTY(EditAnywhere, Category = "Gameplay", meta = (EditCondition = "bOverride_ExplosionRadius"))
     float ExplosionRadius;
 
     // Impulso aplicado aos objetos próximos
-    UPROPERTY(EditAnywhere, Category = "Gameplay")
+    UPROPERTY(EditAnywhere, Category = "Gameplay", meta = (EditCondition = "bOverride_ExplosionImpulse"))
     float ExplosionImpulse;
+
+    // Damage at the center of the explosion, falls off to zero at ExplosionRadius
+    UPROPERTY(EditAnywhere, Category = "Gameplay")
+    float ExplosionDamage = 50.0f;
     
     UFUNCTION()
     void OnHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
    
-    // Make explode function BlueprintCallable so it can be triggered from Blueprints
-    UFUNCTION(BlueprintCallable, Category = "Gameplay")
-    void Explode();
-   
     // O barril já explodiu?
     bool bExploded;
+
+    // Instance slot this barrel was promoted from, invalid for barrels placed as actors
+    FSSaveKey SaveKey;
     
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
 
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:    
     // Called every frame
     virtual void Tick(float DeltaTime) override;
+
+    // Make explode function BlueprintCallable so it can be triggered from Blueprints
+    // Public so the prop instance manager can detonate a barrel it just promoted from an instance
+    UFUNCTION(BlueprintCallable, Category = "Gameplay")
+    void Explode();
+
+    // Sets the mesh burning, shared with USExplosionOcclusionSubsystem
+    static void AttachFlame(UParticleSystem* FlameEffect, UStaticMeshComponent* Mesh);
+
+    // What URadialForceComponent::FireImpulse does to one overlapped component: pushes its bodies if it simulates and
+    // the movement component moving it, so characters are knocked back too. Shared with USExplosionOcclusionSubsystem
+    static void ApplyImpulse(UPrimitiveComponent* Component, const FVector& Origin, float Radius, float Strength,
+        ERadialImpulseFalloff Falloff, bool bVelChange);
+
+    // FireImpulse without a registered force component, on every dynamic component in the radius but IgnoreActor's.
+    // Shared with the instanced barrels of ASPropInstanceManager
+    static void FireImpulse(UWorld* World, const FVector& Origin, float Radius, float Strength, ERadialImpulseFalloff Falloff,
+        bool bVelChange, const AActor* IgnoreActor);
+
+    // Queues the explosion on the gameplay event bus, safe to call from physics callbacks
+    void RequestExplode();
+
+    UStaticMeshComponent* GetMeshComp() const { return MeshComp; }
+
+    bool HasExploded() const { return bExploded; }
+
+    UParticleSystem* GetExplosionEffect() const { return ExplosionEffect; }
+
+    UParticleSystem* GetFlameEffect() const { return FlameEffect; }
+
+    // How the explosion impulse falls off over the radius, as set on RadialForceComp
+    ERadialImpulseFalloff GetImpulseFalloff() const;
+
+    bool GetImpulseVelChange() const;
+
+    // Tunable at runtime through USGameplaySettings, unless this barrel or its blueprint overrides them
+    float GetExplosionRadius() const
+    {
+        return USGameplaySettings::Resolve(bOverride_ExplosionRadius, ExplosionRadius, &FSGameplayConstants::BarrelExplosionRadius);
+    }
+
+    float GetExplosionImpulse() const
+    {
+        return USGameplaySettings::Resolve(bOverride_ExplosionImpulse, ExplosionImpulse, &FSGameplayConstants::BarrelExplosionImpulse);
+    }
+
+    float GetExplosionDamage() const { return ExplosionDamage; }
+
+    const FSSaveKey& GetSaveKey() const { return SaveKey; }
+
+    void SetSaveKey(const FSSaveKey& InSaveKey) { SaveKey = InSaveKey; }
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Plain fire-spread kernel, no UObjects so it can be stepped and benchmarked without a world.
+ *
+ * Every cell stores fuel and heat. Each step heat diffuses to the four neighbours (a 5-point stencil processed four
+ * cells at a time with vector registers), cools down a little, and cells that are hot enough burn fuel to produce
+ * more heat. Only the bounding box of cells that have ever been hot is processed, so the cost follows the size of
+ * the fire and not the size of the level.
+ *
+ * A step can be split in row slices (BeginStep / StepRows / EndStep) so the work is spread over several frames.
+ */
+struct MYCPLUSPLUSPROJECT_API FSFireGrid
+{
+	struct FParams
+	{
+		// Fraction of the neighbour difference exchanged per second, clamped per step so the stencil stays stable
+		float Diffusion = 1.5f;
+		// Fraction of heat lost per second
+		float Cooling = 0.2f;
+		// Heat a cell needs to start burning its fuel
+		float IgnitionHeat = 1.0f;
+		// Fuel burnt per second by a burning cell
+		float BurnRate = 0.25f;
+		// Heat produced per unit of fuel burnt
+		float HeatPerFuel = 8.0f;
+	};
+
+	void Init(int32 InWidth, int32 InHeight, float InCellSize, const FVector2D& InOrigin);
+
+	bool IsValidCell(int32 X, int32 Y) const { return X > 0 && Y > 0 && X < Width - 1 && Y < Height - 1; }
+
+	// World XY to cell, borders are never simulated so they are reported as invalid
+	bool WorldToCell(const FVector& Location, int32& OutX, int32& OutY) const;
+	FVector CellToWorld(int32 X, int32 Y) const;
+
+	void AddFuel(int32 X, int32 Y, float Amount);
+	void AddHeat(int32 X, int32 Y, float Amount);
+
+	// Fuel and heat in every cell whose centre is within the radius
+	void AddFuelInRadius(const FVector& Location, float Radius, float Amount);
+	void AddHeatInRadius(const FVector& Location, float Radius, float Amount);
+
+	float GetHeat(int32 X, int32 Y) const { return Heat[Index(X, Y)]; }
+	float GetFuel(int32 X, int32 Y) const { return Fuel[Index(X, Y)]; }
+	bool IsBurning(int32 X, int32 Y) const { return Fuel[Index(X, Y)] > 0.0f && Heat[Index(X, Y)] >= Params.IgnitionHeat; }
+
+	bool HasActiveRegion() const { return bActive; }
+	int32 GetNumActiveRows() const { return bActive ? ActiveMax.Y - ActiveMin.Y + 1 : 0; }
+
+	// Rows processed by the step started with BeginStep, stays fixed even if heat is added mid-step
+	int32 GetNumStepRows() const { return bActive ? StepMax.Y - StepMin.Y + 1 : 0; }
+
+	// Time sliced stepping, rows are relative to the active region
+	void BeginStep(float StepDeltaTime);
+	void StepRows(int32 FirstRow, int32 NumRows);
+	void EndStep();
+
+	// Whole step in one go
+	void Step(float StepDeltaTime);
+
+	// Calls Visitor(X, Y) for every burning cell
+	template <typename VisitorType>
+	void ForEachBurningCell(VisitorType&& Visitor) const
+	{
+		if (!bActive)
+		{
+			return;
+		}
+		for (int32 Y = ActiveMin.Y; Y <= ActiveMax.Y; Y++)
+		{
+			for (int32 X = ActiveMin.X; X <= ActiveMax.X; X++)
+			{
+				if (IsBurning(X, Y))
+				{
+					Visitor(X, Y);
+				}
+			}
+		}
+	}
+
+	// Steps a Size x Size grid with a fire in the middle and returns the average milliseconds per step
+	static double RunBenchmark(int32 Size, int32 NumSteps, int32& OutActiveCells);
+
+	FParams Params;
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	float GetCellSize() const { return CellSize; }
+
+private:
+	int32 Index(int32 X, int32 Y) const { return Y * Width + X; }
+
+	void ExpandActiveRegion(int32 X, int32 Y);
+
+	int32 Width = 0;
+	int32 Height = 0;
+	float CellSize = 100.0f;
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	TArray<float> Fuel;
+	// Double buffered, the stencil reads Heat and writes HeatNext
+	TArray<float> Heat;
+	TArray<float> HeatNext;
+
+	// Heat added between steps as (cell index, amount)
+	TArray<TPair<int32, float>> PendingHeat;
+
+	// Bounding box of every cell that has been hot since the fire started, grown by one cell per step
+	bool bActive = false;
+	FIntPoint ActiveMin = FIntPoint::ZeroValue;
+	FIntPoint ActiveMax = FIntPoint::ZeroValue;
+
+	// Region and constants captured by BeginStep for the slices of the current step
+	FIntPoint StepMin = FIntPoint::ZeroValue;
+	FIntPoint StepMax = FIntPoint::ZeroValue;
+	float StepDiffusion = 0.0f;
+	float StepKeep = 1.0f;
+	float StepBurn = 0.0f;
+	float StepMaxHeat = 0.0f;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SFireGrid.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SFireSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/*
+ * Runs the fire-spread grid for the world at a fixed low rate (s.Fire.StepRate, 10 Hz by default). Each step is
+ * sliced in rows over the frames until the next step is due, so the cost per frame stays flat.
+ *
+ * When a step completes, cells that just started burning set props on fire (simulated props through the prop
+ * simulation, live barrels directly) and a small pool of flame emitters is moved to the burning cells closest
+ * to the camera. Cells outside every player's view get no emitter at all.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USFireSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Game and PIE worlds only, editor and preview worlds never burn
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Fuel that can burn, barrels put fuel in their cell
+	void AddFuel(const FVector& Location, float Radius, float Amount);
+
+	// Heat that starts (or feeds) a fire, explosions add heat
+	void AddHeat(const FVector& Location, float Radius, float Amount);
+
+	// First flame effect registered is used for every pooled flame visual
+	void SetFlameTemplate(UParticleSystem* Template);
+
+	const FSFireGrid& GetGrid() const { return Grid; }
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	FSFireGrid Grid;
+
+	float StepAccumulator = 0.0f;
+	bool bStepInProgress = false;
+	int32 NextStepRow = 0;
+
+	// Cells that were burning after the previous step, to find the ones that just caught fire
+	TBitArray<> BurningCells;
+
+	// Ground height of a cell, recorded from wherever fuel or heat was added and copied to cells the fire spreads to
+	TArray<float> CellHeights;
+	TBitArray<> HasCellHeight;
+
+	UPROPERTY()
+	UParticleSystem* FlameTemplate;
+
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> FlamePool;
+
+	// Cell index each pooled emitter is showing, INDEX_NONE when free
+	TArray<int32> FlamePoolCells;
+
+	void RecordCellHeight(const FVector& Location, float Radius);
+
+	void OnStepCompleted();
+
+	void IgniteCells(const TArray<FIntPoint>& Cells);
+
+	void UpdateFlameVisuals(const TArray<FIntPoint>& Cells);
+
+	void OnPropsExploded(TConstArrayView<int32> Entities);
+};
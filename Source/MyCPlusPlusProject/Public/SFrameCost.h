@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Game thread time spent by our own systems, readable from code (unlike stat counters, which need a stats build
+ * and a viewer). Each system wraps its per-frame work in S_SCOPED_FRAME_COST, the soak test resets the totals
+ * when it starts and prints them when it ends. Work the systems hand to ParallelFor is included in the scope
+ * of the system that waits for it.
+ */
+struct MYCPLUSPLUSPROJECT_API FSFrameCost
+{
+	struct FEntry
+	{
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+		int32 Calls = 0;
+	};
+
+	// Game thread only
+	static void Add(FName Name, double Seconds);
+
+	static void Reset();
+
+	// One line per system, sorted by total time, averaged over NumFrames
+	static void LogReport(int32 NumFrames);
+
+	static const TMap<FName, FEntry>& GetEntries();
+};
+
+class FSScopedFrameCost
+{
+public:
+	explicit FSScopedFrameCost(FName InName)
+		: Name(InName)
+		, StartTime(FPlatformTime::Seconds())
+	{
+	}
+
+	~FSScopedFrameCost()
+	{
+		FSFrameCost::Add(Name, FPlatformTime::Seconds() - StartTime);
+	}
+
+private:
+	FName Name;
+	double StartTime;
+};
+
+#define S_SCOPED_FRAME_COST(Name) \
+	static const FName PREPROCESSOR_JOIN(SFrameCostName_, __LINE__)(TEXT(Name)); \
+	FSScopedFrameCost PREPROCESSOR_JOIN(SFrameCostScope_, __LINE__)(PREPROCESSOR_JOIN(SFrameCostName_, __LINE__))
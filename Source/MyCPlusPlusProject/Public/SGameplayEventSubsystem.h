@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SGameplayEventSubsystem.generated.h"
+
+// Handlers run in this order every frame, one batch per type
+UENUM()
+enum class ESGameplayEventType : uint8
+{
+	// Source = instigating pawn, Target = actor implementing ISGameplayInterface
+	Interacted,
+	// Source = dash projectile, Target = actor to move, Location/Rotation = destination
+	Teleported,
+	// Source = blackhole, Target = absorbed actor
+	Absorbed,
+	// Source = barrel that goes off, Location = where
+	Explosion,
+
+	Count UMETA(Hidden)
+};
+
+struct FSGameplayEvent
+{
+	ESGameplayEventType Type = ESGameplayEventType::Explosion;
+	TWeakObjectPtr<AActor> Source;
+	TWeakObjectPtr<AActor> Target;
+	FVector Location = FVector::ZeroVector;
+	FRotator Rotation = FRotator::ZeroRotator;
+};
+
+/*
+ * Gameplay event bus. Physics callbacks, timers and worker tasks post events into a lock-free MPSC queue instead of
+ * calling into other actors, and the queue is drained once per frame on the game thread.
+ *
+ * Drained events are grouped by type and processed in ESGameplayEventType order: first the gameplay reaction owned
+ * by the bus (explode, destroy, teleport, interact), then every listener bound to that type gets the whole batch.
+ * Duplicates of the same explosion or absorption within a frame are dropped, so a barrel that is hit twice in one
+ * physics step only explodes once.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USGameplayEventSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnGameplayEvents, TConstArrayView<FSGameplayEvent> /*Events*/);
+
+	// Safe to call from any thread
+	void Post(const FSGameplayEvent& Event);
+
+	// Listeners (audio, UI, analytics) get one call per frame with every event of that type
+	FOnGameplayEvents& OnEvents(ESGameplayEventType Type) { return Listeners[static_cast<int32>(Type)]; }
+
+	// Drains the queue now, normally done once per frame by Tick
+	void Flush();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	TQueue<FSGameplayEvent, EQueueMode::Mpsc> PendingEvents;
+
+	// Reused every frame, one array per event type
+	TArray<FSGameplayEvent> Batches[static_cast<int32>(ESGameplayEventType::Count)];
+
+	// (type, source, target) of the events batched by the current flush, also reused every frame
+	TSet<TTuple<ESGameplayEventType, TWeakObjectPtr<AActor>, TWeakObjectPtr<AActor>>> BatchedKeys;
+
+	FOnGameplayEvents Listeners[static_cast<int32>(ESGameplayEventType::Count)];
+
+	void HandleInteracted(TConstArrayView<FSGameplayEvent> Events);
+	void HandleTeleported(TConstArrayView<FSGameplayEvent> Events);
+	void HandleAbsorbed(TConstArrayView<FSGameplayEvent> Events);
+	void HandleExplosion(TConstArrayView<FSGameplayEvent> Events);
+};
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SGameplayRandomSubsystem.generated.h"
+
+/*
+ * Counter based random numbers: the value is a hash of a key and a counter, there is no state to advance. Parallel
+ * jobs use the element index (and a step number if needed) as counter, so every element gets the same number no
+ * matter which thread processes it or in which order.
+ */
+struct MYCPLUSPLUSPROJECT_API FSCounterRandom
+{
+	uint32 Key = 0;
+
+	FSCounterRandom() = default;
+	explicit FSCounterRandom(uint32 InKey) : Key(InKey) {}
+
+	static uint32 Hash(uint32 Key, uint32 Counter)
+	{
+		// lowbias32 finalizer over the key and a golden ratio spaced counter
+		uint32 X = Key + Counter * 0x9E3779B9u;
+		X ^= X >> 16;
+		X *= 0x7FEB352Du;
+		X ^= X >> 15;
+		X *= 0x846CA68Bu;
+		X ^= X >> 16;
+		return X;
+	}
+
+	uint32 GetUInt(uint32 Counter, uint32 Step = 0) const { return Hash(Hash(Key, Step), Counter); }
+
+	// [0, 1)
+	float GetFraction(uint32 Counter, uint32 Step = 0) const { return (GetUInt(Counter, Step) >> 8) * (1.0f / 16777216.0f); }
+
+	float FRandRange(uint32 Counter, float Min, float Max, uint32 Step = 0) const { return Min + (Max - Min) * GetFraction(Counter, Step); }
+};
+
+/*
+ * Gameplay randomness for one world. Everything random in gameplay code takes its numbers from here instead of
+ * FMath::Rand, so a whole session follows from one seed: benchmark runs repeat, input replays make the same choices
+ * and nothing contends on the global generator.
+ *
+ * The seed comes from the game mode (AMyCPlusPlusProjectGameModeBase) and is stored in input recordings. Each system
+ * asks for its own named substream, seeded from the world seed and the name, so one system drawing more numbers
+ * doesn't shift the numbers another one gets. Parallel jobs use a counter based stream instead (FSCounterRandom).
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USGameplayRandomSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Restarts every substream from the new seed
+	void SetSeed(int32 InSeed);
+
+	int32 GetSeed() const { return Seed; }
+
+	// Game thread only, draw right away rather than keeping the reference around
+	FRandomStream& GetStream(FName Name);
+
+	// Safe to use from any thread once obtained
+	FSCounterRandom GetCounterStream(FName Name) const;
+
+protected:
+	int32 Seed = 0;
+
+	TMap<FName, FRandomStream> Streams;
+
+	uint32 GetSubstreamKey(FName Name) const;
+};
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SGameplayRegistrySubsystem.generated.h"
+
+enum class ESRegistryKind : uint8
+{
+	Barrel,
+	Chest,
+	PropManager,
+	// Static mesh actors simulating physics, the things a blackhole or an explosion pushes around
+	PhysicsProp,
+	// Player and bot characters, aim assist candidates
+	Pawn,
+
+	Count
+};
+
+/*
+ * Resident gameplay actors, by kind. Replaces whole-world actor iteration (GetAllActorsOfClass, TActorIterator):
+ * with level streaming or World Partition only the loaded cells are registered, so queries cost what is resident,
+ * not what the map contains.
+ *
+ * Barrels, chests, prop managers and characters register themselves in BeginPlay and unregister in EndPlay, which is also
+ * called when their cell unloads. Physics props are plain static mesh actors, they are picked up when their level
+ * is added to the world and dropped when it is removed.
+ *
+ * -LoadBenchmark=<Seconds> logs load time, memory and resident counts when the world begins play and again after
+ * the given time (streaming has settled around the player), then quits. Run it headless on the streamed map and on
+ * its single level version to compare:  <Map> -game -nullrhi -unattended -LoadBenchmark=30
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USGameplayRegistrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return BenchmarkTimeRemaining > 0.0f; }
+	virtual TStatId GetStatId() const override;
+
+	void Register(AActor* Actor, ESRegistryKind Kind);
+	void Unregister(AActor* Actor, ESRegistryKind Kind);
+
+	int32 Num(ESRegistryKind Kind) const { return Actors[(int32)Kind].Num(); }
+
+	template <typename ActorType, typename FuncType>
+	void ForEach(ESRegistryKind Kind, FuncType Func) const
+	{
+		// Copy, callbacks may register or unregister (an explosion destroying a barrel)
+		const TArray<TWeakObjectPtr<AActor>> Snapshot = Actors[(int32)Kind];
+		for (const TWeakObjectPtr<AActor>& Actor : Snapshot)
+		{
+			if (ActorType* Typed = Cast<ActorType>(Actor.Get()))
+			{
+				Func(Typed);
+			}
+		}
+	}
+
+	// Registered actors of the given kinds whose location is within the radius
+	void GetActorsInRadius(const FVector& Location, float Radius, TArray<AActor*>& OutActors,
+		std::initializer_list<ESRegistryKind> Kinds) const;
+
+	void LogStats(const TCHAR* Label) const;
+
+protected:
+	TArray<TWeakObjectPtr<AActor>> Actors[(int32)ESRegistryKind::Count];
+
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+
+	float BenchmarkTimeRemaining = 0.0f;
+
+	static bool IsPhysicsProp(const AActor* Actor);
+
+	void AddLevel(ULevel* Level);
+	void RemoveLevel(ULevel* Level);
+
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+};
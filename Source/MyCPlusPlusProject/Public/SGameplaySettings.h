@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "Containers/Ticker.h"
+#include "SGameplaySettings.generated.h"
+
+// Copy of USGameplaySettings that gameplay code reads, plain floats next to each other instead of a UObject lookup
+struct FSGameplayConstants
+{
+	// Crosshair trace when aim assist finds nothing
+	float AimTraceLength = 10000.0f;
+
+	float PrimaryAttackCastTime = 0.2f;
+	float PrimaryAttackCooldown = 0.3f;
+	float SpecialAttackCastTime = 0.2f;
+	float SpecialAttackCooldown = 1.0f;
+
+	float InteractionRadius = 50.0f;
+	float InteractionReach = 1000.0f;
+
+	float BlackholeForceStrength = -500000.0f;
+	float BlackholeMinRadius = 5000.0f;
+	float BlackholeMaxRadius = 10000.0f;
+	float BlackholePulseSpeed = 2.0f;
+
+	float DashSpeed = 2000.0f;
+
+	float BarrelExplosionRadius = 1000.0f;
+	float BarrelExplosionImpulse = 2000.0f;
+};
+
+/*
+ * Gameplay constants that trade cost against quality, in Project Settings > Game > Gameplay Tuning and the
+ * [/Script/MyCPlusPlusProject.SGameplaySettings] section of DefaultGame.ini.
+ *
+ * The values are copied into FSGameplayConstants, read with USGameplaySettings::GetConstants(). Editing the section
+ * in Config/DefaultGame.ini while the game runs applies it within a second (s.Settings.AutoReload, not in shipping
+ * builds), s.Settings.Reload applies it right away. Code that caches a value binds OnConstantsChanged.
+ *
+ * Classes that had their own property for a constant keep it next to a bOverride_ flag, as FPostProcessSettings does,
+ * and read it through Resolve(): an asset or placed actor that ticked the flag keeps its value, the others follow
+ * reloads. The property is defaulted from GetStartupConstants() so the editor shows the value it stands in for.
+ */
+UCLASS(config = Game, defaultconfig, meta = (DisplayName = "Gameplay Tuning"))
+class MYCPLUSPLUSPROJECT_API USGameplaySettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	static const FSGameplayConstants& GetConstants() { return Constants; }
+
+	// The constants as the config had them at startup, before any reload, for property defaults in constructors
+	static const FSGameplayConstants& GetStartupConstants();
+
+	// The per-asset value when its override flag is set, the live constant otherwise
+	static float Resolve(bool bOverride, float AssetValue, float FSGameplayConstants::* Constant)
+	{
+		return bOverride ? AssetValue : Constants.*Constant;
+	}
+
+	// Broadcast after the constants changed, in the editor or from a reload
+	static FSimpleMulticastDelegate OnConstantsChanged;
+
+	// Reads the section again from Config/DefaultGame.ini on disk, returns whether it was found
+	bool ReloadFromFile();
+
+	// Polls the file's timestamp, started by the module once the engine is up
+	void StartWatching();
+	void StopWatching();
+
+	virtual FName GetCategoryName() const override { return TEXT("Game"); }
+
+	virtual void PostInitProperties() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+protected:
+	UPROPERTY(config, EditAnywhere, Category = "Aim", meta = (ClampMin = "100"))
+	float AimTraceLength = 10000.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Attack", meta = (ClampMin = "0"))
+	float PrimaryAttackCastTime = 0.2f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Attack", meta = (ClampMin = "0"))
+	float PrimaryAttackCooldown = 0.3f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Attack", meta = (ClampMin = "0"))
+	float SpecialAttackCastTime = 0.2f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Attack", meta = (ClampMin = "0"))
+	float SpecialAttackCooldown = 1.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Interaction", meta = (ClampMin = "1"))
+	float InteractionRadius = 50.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Interaction", meta = (ClampMin = "1"))
+	float InteractionReach = 1000.0f;
+
+	// Negative pulls
+	UPROPERTY(config, EditAnywhere, Category = "Blackhole")
+	float BlackholeForceStrength = -500000.0f;
+
+	// The force radius pulses between these, bigger radii pull more bodies and cost more
+	UPROPERTY(config, EditAnywhere, Category = "Blackhole", meta = (ClampMin = "0"))
+	float BlackholeMinRadius = 5000.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Blackhole", meta = (ClampMin = "0"))
+	float BlackholeMaxRadius = 10000.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Blackhole", meta = (ClampMin = "0"))
+	float BlackholePulseSpeed = 2.0f;
+
+	// Travel speed of the dash projectile and the predicted dash alike
+	UPROPERTY(config, EditAnywhere, Category = "Dash", meta = (ClampMin = "1"))
+	float DashSpeed = 2000.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Barrel", meta = (ClampMin = "0"))
+	float BarrelExplosionRadius = 1000.0f;
+
+	UPROPERTY(config, EditAnywhere, Category = "Barrel", meta = (ClampMin = "0"))
+	float BarrelExplosionImpulse = 2000.0f;
+
+	static FSGameplayConstants Constants;
+	static FSGameplayConstants StartupConstants;
+	static bool bStartupConstantsSet;
+
+	FTSTicker::FDelegateHandle WatchHandle;
+	FDateTime WatchedTimeStamp;
+
+	void UpdateConstants();
+
+	bool PollFile(float DeltaTime);
+
+	static FString GetFilePath();
+};
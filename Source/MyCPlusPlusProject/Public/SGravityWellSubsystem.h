@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SGravityWellSubsystem.generated.h"
+
+class FSGravityWellCallback;
+
+// A radial pull, the blackhole's radial force without the component
+struct FSGravityWell
+{
+	FVector Center = FVector::ZeroVector;
+	float Radius = 0.0f;
+
+	// Force on every body inside the radius, like the radial force component's ForceStrength, negative pulls
+	float Strength = 0.0f;
+};
+
+/*
+ * Applies gravity wells to the simulating barrels and physics props on the physics thread, in a Chaos sim callback
+ * that runs before every fixed physics step (bTickPhysicsAsync and AsyncFixedTimeStepSize in DefaultEngine.ini). The
+ * pull no longer depends on the game thread's frame rate and runs alongside rendering and game logic.
+ *
+ * Owners set their well every frame and remove it when they end, the game thread only hands the wells and the
+ * bodies within them to the physics thread. s.Physics.AsyncWells 0 goes back to the blackhole's radial force
+ * component.
+ *
+ * s.Physics.FrameRateSweep [SecondsPerRate] caps the frame rate at 30, 60 and 144 in turn and logs the frame and
+ * game thread time and the physics steps per second at each.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USGravityWellSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static bool IsEnabled();
+
+	void SetWell(const UObject* Owner, const FSGravityWell& Well);
+	void RemoveWell(const UObject* Owner);
+
+	int32 GetNumWells() const { return Wells.Num(); }
+
+	// Physics steps run so far, with and without wells
+	int32 GetNumPhysicsSteps() const;
+
+	void StartFrameRateSweep(float SecondsPerRate);
+
+protected:
+	TMap<TObjectKey<UObject>, FSGravityWell> Wells;
+
+	// Owned by the physics solver, freed through it
+	FSGravityWellCallback* Callback = nullptr;
+
+	// Frame rate sweep
+	TArray<float> SweepRates;
+	int32 SweepIndex = INDEX_NONE;
+	float SweepSecondsPerRate = 0.0f;
+	float SweepTimeRemaining = 0.0f;
+	float SweepSavedMaxFPS = 0.0f;
+	int32 SweepFrames = 0;
+	double SweepFrameSeconds = 0.0;
+	double SweepGameThreadSeconds = 0.0;
+	int32 SweepStartSteps = 0;
+
+	// Hands the wells and the simulating bodies in them to the physics thread for its next steps
+	void SendWells();
+
+	void BeginSweepRate(int32 Index);
+	void TickSweep();
+	void EndSweep();
+};
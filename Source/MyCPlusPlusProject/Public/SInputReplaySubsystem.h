@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/MappedFileHandle.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SInputReplaySubsystem.generated.h"
+
+class ASCharacter;
+
+// Axes bound in ASCharacter::SetupPlayerInputComponent
+enum class ESInputAxis : uint8
+{
+	MoveForward,
+	MoveRight,
+	Turn,
+	LookUp,
+
+	Count
+};
+
+// Actions bound in ASCharacter::SetupPlayerInputComponent, stored as bits
+enum class ESInputAction : uint8
+{
+	PrimaryAttack,
+	SpecialAttack,
+	Dash,
+	PrimaryInteract,
+	Jump,
+
+	Count
+};
+
+// Input of one local player for one frame
+struct FSInputFrame
+{
+	float Axes[(int32)ESInputAxis::Count] = {};
+	uint8 Actions = 0;
+
+	// Size on disk, every frame takes the same space so frame N is found without reading the ones before it
+	static constexpr int32 SerializedSize = sizeof(float) * (int32)ESInputAxis::Count + sizeof(uint8);
+};
+
+/*
+ * Records the input of every local player each frame into a compact binary file and plays it back.
+ *
+ * The file is a 20 byte header (magic, version, gameplay seed, number of local players, frame size) followed by fixed
+ * size frames: the engine delta time, then for each local player the four axes and one byte of action bits. Replays
+ * restore the seed of USGameplayRandomSubsystem, so gameplay makes the same random choices (the blackhole's animation
+ * phase, ...).
+ *
+ * Playback memory maps the file, ignores live input and runs each frame with its recorded delta time as a fixed time
+ * step, so the engine doesn't wait for vsync or a frame rate cap. A headless run profiles the same session over and
+ * over:
+ *     MyCPlusPlusProject <Map> -game -nullrhi -unattended -ReplayInput=Session.srpl
+ * Recording from the start of a map:
+ *     MyCPlusPlusProject <Map> -game -RecordInput=Session.srpl
+ * or from the console with s.Replay.Record / s.Replay.Play / s.Replay.Stop, which reload the current map first so
+ * recordings and replays both start from its initial state. Relative paths go to Saved/Replays.
+ *
+ * World state can't be rewound: seeking forward simulates the frames in between without rendering them, seeking
+ * backward reloads the map and does the same from frame 0.
+ *
+ * Physics is resimulated and not recorded, a replay reproduces the load of a session but not every bounce.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USInputReplaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Start right away, from whatever state the world is in
+	bool StartRecording(const FString& FileName);
+	bool StartReplay(const FString& FileName);
+	void Stop();
+
+	// Reload the current map and record or replay from its start
+	void RestartRecording(const FString& FileName);
+	void RestartReplay(const FString& FileName, int32 SeekFrame = 0);
+
+	// Brings the world to the state of a recorded frame by simulating the frames in between
+	void SeekReplay(int32 Frame);
+
+	bool IsRecording() const { return Writer.IsValid(); }
+	bool IsReplaying() const { return MappedRegion.IsValid(); }
+	bool IsSeeking() const { return SeekFrame != INDEX_NONE; }
+
+	// Called by ASCharacter's input bindings for locally controlled players
+	void RecordAxis(const ASCharacter* Character, ESInputAxis Axis, float Value);
+	void RecordAction(const ASCharacter* Character, ESInputAction Action);
+
+protected:
+	static constexpr uint32 FileMagic = 0x4C505253; // "SRPL"
+	static constexpr uint32 FileVersion = 2;
+	static constexpr int32 HeaderSize = 20;
+
+	TUniquePtr<FArchive> Writer;
+	float RecordDeltaTime = 0.0f;
+	TArray<FSInputFrame> RecordFrames;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	FString ReplayFileName;
+	int32 NumReplayFrames = 0;
+	int32 NumReplayPlayers = 0;
+	int32 ReplayFrameSize = 0;
+	int32 ReplayFrameIndex = 0;
+	double ReplayStartTime = 0.0;
+
+	// Frame a seek is simulating towards, INDEX_NONE when not seeking
+	int32 SeekFrame = INDEX_NONE;
+
+	// The engine's fixed time step settings before the replay took them over
+	bool bSavedUseFixedTimeStep = false;
+	double SavedFixedDeltaTime = 0.0;
+
+	// Started from the command line, quit when the replay ends
+	bool bExitWhenDone = false;
+
+	FDelegateHandle BeginFrameHandle;
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle PostActorTickHandle;
+
+	static FString ResolvePath(const FString& FileName);
+
+	// Local players in the order of the game instance, the order their input is stored in
+	ASCharacter* GetLocalCharacter(int32 PlayerIndex) const;
+	int32 GetLocalPlayerIndex(const ASCharacter* Character) const;
+
+	float ReadDeltaTime(int32 Frame) const;
+	FSInputFrame ReadFrame(int32 Frame, int32 PlayerIndex) const;
+	void WriteFrame();
+
+	void ReloadMap(const FString& Options);
+
+	void SetWorldRendering(bool bEnabled);
+
+	void OnBeginFrame();
+	void OnWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+};
@@ -13,6 +13,8 @@ class MYCPLUSPLUSPROJECT_API USInteractionComponent : public UActorComponent
 	GENERATED_BODY()
 
 public:
+	// Sweeps in front of the owner's eyes and interacts with the first ISGameplayInterface hit, once the batched
+	// sweep comes back. Radius and reach are USGameplaySettings' InteractionRadius and InteractionReach.
 	void PrimaryInteract();
 
 public:	
@@ -23,6 +25,8 @@ protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	void InteractWithHits(TConstArrayView<FHitResult> Hits, const FVector& Start, const FVector& End);
+
 public:	
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
@@ -5,9 +5,12 @@
 #include "CoreMinimal.h"
 #include "SGameplayInterface.h"
 #include "GameFramework/Actor.h"
+#include "SLootSubsystem.h"
+#include "SSaveGameSubsystem.h"
 #include "SItemChest.generated.h"
 
 class UStaticMeshComponent;
+class USLootTable;
 
 UCLASS()
 class MYCPLUSPLUSPROJECT_API ASItemChest : public AActor, public ISGameplayInterface
@@ -17,6 +20,10 @@ class MYCPLUSPLUSPROJECT_API ASItemChest : public AActor, public ISGameplayInter
 public:
 	UPROPERTY(EditAnywhere, Category = "Gameplay")
 	float TargetPitch;
+
+	// Rolled when the chest is opened, interacting with an open chest picks the loot up
+	UPROPERTY(EditAnywhere, Category = "Gameplay")
+	USLootTable* LootTable;
 	
 	void Interact_Implementation(APawn* InstigatorPawn);
 	
@@ -24,16 +31,40 @@ public:
 	// Sets default values for this actor's properties
 	ASItemChest();
 
+	UStaticMeshComponent* GetBasicMesh() const { return BasicMesh; }
+
+	UStaticMeshComponent* GetLidMesh() const { return LidMesh; }
+
+	// Closed chests can be folded back into the prop instance manager, opened ones stay actors
+	bool IsOpen() const { return bIsOpen; }
+
+	// Opens the lid without counting as an interaction, used when a save is loaded
+	void SetOpen();
+
+	const FSSaveKey& GetSaveKey() const { return SaveKey; }
+
+	void SetSaveKey(const FSSaveKey& InSaveKey) { SaveKey = InSaveKey; }
+
 protected:
 	UPROPERTY(VisibleAnywhere)
 	UStaticMeshComponent* BasicMesh;
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
 	UStaticMeshComponent* LidMesh;
+
+	bool bIsOpen = false;
+
+	// Instance slot this chest was promoted from, invalid for chests placed as actors
+	FSSaveKey SaveKey;
+
+	// Rolled items not picked up yet, they live in the USLootSubsystem arena
+	TArrayView<FSLootItem> Loot;
 	
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SLootSubsystem.generated.h"
+
+class USLootTable;
+
+// Rolled item waiting in a chest, plain data in the loot arena
+struct FSLootItem
+{
+	FName ItemId;
+	int32 Count = 0;
+};
+
+// Item once a pawn picked it up, the only point loot becomes a UObject
+UCLASS(BlueprintType)
+class MYCPLUSPLUSPROJECT_API USLootItem : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Loot")
+	FName ItemId;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Loot")
+	int32 Count = 0;
+};
+
+/*
+ * Rolls chest loot into a per-world arena. Opening a chest draws from its table's alias table and writes the items
+ * as plain structs into a bump allocator, nothing is allocated per item and nothing is freed until the world goes
+ * away, so a swarm of bots opening thousands of chests costs a few draws and a pointer bump each. Items turn into
+ * USLootItem objects only when a pawn picks them up.
+ *
+ * s.Loot.Benchmark [Chests] [Entries] rolls that many chests (10000 by default) from a synthetic table of the
+ * given size (256) into a scratch arena and logs draws per second and bytes per item.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USLootSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Draws the table's rolls into the arena, the view stays valid for the lifetime of the world
+	TArrayView<FSLootItem> RollLoot(const USLootTable* Table);
+
+	// Turns rolled items into objects owned by the pawn, characters add them to their inventory
+	void PickUp(TArrayView<FSLootItem> Items, APawn* Pawn);
+
+	void RunBenchmark(int32 NumChests, int32 NumEntries);
+
+	int64 GetArenaBytes() const { return Arena.GetByteCount(); }
+
+protected:
+	// No minimum mark count, the world rolls into it without ever marking
+	FMemStackBase Arena { 0 };
+
+	int32 NumRolledItems = 0;
+
+	static TArrayView<FSLootItem> RollLoot(const USLootTable* Table, FRandomStream& Random, FMemStackBase& InArena);
+};
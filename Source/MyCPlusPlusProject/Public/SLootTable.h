@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SLootTable.generated.h"
+
+/*
+ * Walker/Vose alias table: draws an index with probability proportional to its weight in O(1), one column pick and
+ * one biased coin flip, however many entries the table has.
+ */
+struct MYCPLUSPLUSPROJECT_API FSAliasTable
+{
+	// Probability of keeping the column, scaled so the coin is a plain [0, 1) fraction
+	TArray<float> Probability;
+	// Entry taken when the coin says no
+	TArray<int32> Alias;
+
+	// Left empty when no weight is above zero
+	void Build(TConstArrayView<float> Weights);
+
+	int32 Num() const { return Probability.Num(); }
+
+	// Two independent [0, 1) fractions
+	int32 Sample(float ColumnFraction, float CoinFraction) const
+	{
+		const int32 Column = FMath::Min(int32(ColumnFraction * Probability.Num()), Probability.Num() - 1);
+		return CoinFraction < Probability[Column] ? Column : Alias[Column];
+	}
+};
+
+USTRUCT(BlueprintType)
+struct FSLootEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Loot")
+	FName ItemId;
+
+	// Relative to the other entries of the table, they don't have to add up to anything
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = "0"))
+	float Weight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = "1"))
+	int32 MinCount = 1;
+
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = "1"))
+	int32 MaxCount = 1;
+};
+
+/*
+ * Weighted loot a chest rolls when it is opened. The entries are compiled into an alias table when the asset loads
+ * (and again when it is edited), so a roll costs the same for a table of five entries or five thousand.
+ */
+UCLASS(BlueprintType)
+class MYCPLUSPLUSPROJECT_API USLootTable : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Loot")
+	TArray<FSLootEntry> Entries;
+
+	// Items drawn per chest, with replacement
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = "0"))
+	int32 Rolls = 3;
+
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	// Builds the alias table from Entries, tables created at runtime call this once filled
+	void Compile();
+
+	const FSAliasTable& GetAliasTable() const { return AliasTable; }
+
+protected:
+	FSAliasTable AliasTable;
+};
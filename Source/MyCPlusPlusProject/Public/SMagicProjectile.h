@@ -9,6 +9,7 @@
 class UProjectileMovementComponent;
 class USphereComponent;
 class UParticleSystemComponent;
+class UParticleSystem;
 
 UCLASS()
 class MYCPLUSPLUSPROJECT_API ASMagicProjectile : public AActor
@@ -19,6 +20,23 @@ public:
 	// Sets default values for this actor's properties
 	ASMagicProjectile();
 
+	// Starts flying from here, also when taken back out of USProjectileSubsystem's pool
+	void Launch(const FVector& Location, const FRotator& Rotation, APawn* InInstigator);
+
+	// Hidden, without collision and movement, until launched again
+	void Deactivate();
+
+	bool IsActive() const { return bActive; }
+
+	float GetDamageAmount() const { return DamageAmount; }
+
+	double GetLaunchTime() const { return LaunchTime; }
+
+	const FVector& GetLaunchLocation() const { return LaunchLocation; }
+
+	// The surface's effect when there is one, ImpactEffect otherwise
+	UParticleSystem* GetImpactEffect(EPhysicalSurface SurfaceType) const;
+
 protected:
 	UPROPERTY(visibleanywhere, BlueprintReadWrite)
 	USphereComponent* SphereComp;
@@ -28,6 +46,33 @@ protected:
 
 	UPROPERTY(visibleanywhere, BlueprintReadWrite)
 	UParticleSystemComponent* EffectComp;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Damage")
+	float DamageAmount = 20.0f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	UParticleSystem* ImpactEffect;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Effects")
+	TMap<TEnumAsByte<EPhysicalSurface>, UParticleSystem*> SurfaceImpactEffects;
+
+	// Flying and not yet recorded an impact, one projectile hits once
+	bool bActive = true;
+
+	double LaunchTime = 0.0;
+	FVector LaunchLocation = FVector::ZeroVector;
+
+	UFUNCTION()
+	void OnActorOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp,
+		int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void OnActorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse,
+		const FHitResult& Hit);
+
+	void RecordImpact(AActor* OtherActor, const FHitResult& Hit);
+
+	virtual void PostInitializeComponents() override;
 	
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/*
+ * Low-Level Memory tracker tags of our systems, shown under SGameplay in "stat LLM" and Unreal Insights when the game
+ * runs with -llm. Allocations inside an LLM_SCOPE_BYTAG are charged to the tag, the innermost scope wins.
+ */
+LLM_DECLARE_TAG_API(SGameplay_Projectiles, MYCPLUSPLUSPROJECT_API);
+LLM_DECLARE_TAG_API(SGameplay_Effects, MYCPLUSPLUSPROJECT_API);
+LLM_DECLARE_TAG_API(SGameplay_Interaction, MYCPLUSPLUSPROJECT_API);
+LLM_DECLARE_TAG_API(SGameplay_Abilities, MYCPLUSPLUSPROJECT_API);
+
+struct FSMemoryBudgetEntry
+{
+	FName Name;
+
+	int32 Count = 0;
+	int64 Bytes = 0;
+
+	// Zero is no budget
+	int32 MaxCount = 0;
+	int64 MaxBytes = 0;
+
+	bool IsOverBudget() const
+	{
+		return (MaxCount > 0 && Count > MaxCount) || (MaxBytes > 0 && Bytes > MaxBytes);
+	}
+};
+
+/*
+ * Live counts and memory of the gameplay classes that come and go in numbers: projectiles, promoted barrels and
+ * spawned particle systems (those created at runtime by SpawnEmitter, not the ones an actor is built with). Bytes are
+ * the objects themselves plus what their components report as resource size, particle components include their
+ * emitter instances.
+ *
+ * Budgets come from DefaultGame.ini, per class, either limit may be left out:
+ *     [MemoryBudget]
+ *     SMagicProjectile=(MaxCount=256,MaxKB=4096)
+ *
+ * s.Memory.Budget logs the current numbers and warns for every class over budget. The soak test samples them while it
+ * runs and fails a headless run whose peak goes over budget.
+ */
+struct MYCPLUSPLUSPROJECT_API FSMemoryBudget
+{
+	static void Gather(UWorld* World, TArray<FSMemoryBudgetEntry>& OutEntries);
+
+	// Keeps the highest count and bytes of each entry
+	static void AccumulatePeak(const TArray<FSMemoryBudgetEntry>& Entries, TArray<FSMemoryBudgetEntry>& InOutPeak);
+
+	// One line per class, a warning for each over budget. Returns how many are over budget.
+	static int32 LogReport(const TArray<FSMemoryBudgetEntry>& Entries);
+};
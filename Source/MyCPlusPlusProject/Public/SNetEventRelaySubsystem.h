@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGameplayEventSubsystem.h"
+#include "SReplicationTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SNetEventRelaySubsystem.generated.h"
+
+/*
+ * Server side only. Collects the explosions and absorptions handled by the gameplay event bus during a frame and,
+ * at the end of the frame, sends every remote player a single unreliable RPC with the events close enough to
+ * their view (s.Net.EventRelevancyDistance). Far away players receive nothing.
+ *
+ * s.Net.LogBandwidth 1 prints outgoing bytes per second for every client connection, together with the bytes
+ * spent on these batches, so the cost of a fight can be measured on a listen server with simulated clients.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USNetEventRelaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+protected:
+	TArray<FSNetWorldEvent> PendingEvents;
+
+	// Estimated payload of the batches sent since the last bandwidth log
+	int64 EventBytesSent = 0;
+	double LastBandwidthLogTime = 0.0;
+
+	FDelegateHandle PostActorTickHandle;
+
+	void OnExplosions(TConstArrayView<FSGameplayEvent> Events);
+	void OnAbsorbed(TConstArrayView<FSGameplayEvent> Events);
+
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	void SendBatches();
+	void LogBandwidth();
+};
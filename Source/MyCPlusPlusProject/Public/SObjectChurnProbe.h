@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UObjectArray.h"
+
+/*
+ * Counts UObjects created and destroyed per class while it runs, together with the number and worst duration of
+ * garbage collections, to find what feeds GC hitches. Steady-state gameplay should create no UObjects: effects come
+ * from the particle pool and props are promoted from instances, anything that shows up here is churn.
+ *
+ * From the console:   s.GC.Probe Start, s.GC.Probe Stop (logs the report)
+ * The soak test runs it after its warmup and fails a headless run when a class of our module is created faster than
+ * s.GC.Probe.MaxPerSecond, e.g. a 10 minute soak:
+ *     MyCPlusPlusProject <Map> -game -nullrhi -unattended -SoakBots=64 -SoakSeconds=600
+ */
+class MYCPLUSPLUSPROJECT_API FSObjectChurnProbe : public FUObjectArray::FUObjectCreateListener, public FUObjectArray::FUObjectDeleteListener
+{
+public:
+	static FSObjectChurnProbe& Get();
+
+	// Starts counting from zero, restarts when already running
+	void Start();
+
+	void Stop();
+
+	bool IsRunning() const { return bRunning; }
+
+	// Per class rates since Start, top classes first. Returns how many of our module's classes go over
+	// s.GC.Probe.MaxPerSecond.
+	int32 LogReport() const;
+
+	virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override;
+	virtual void NotifyUObjectDeleted(const UObjectBase* Object, int32 Index) override;
+	virtual void OnUObjectArrayShutdown() override;
+
+private:
+	struct FCounts
+	{
+		int32 Created = 0;
+		int32 Destroyed = 0;
+	};
+
+	// Objects are created on loading threads too
+	mutable FCriticalSection CountsLock;
+	TMap<FName, FCounts> Counts;
+
+	bool bRunning = false;
+	double StartTime = 0.0;
+
+	int32 NumCollections = 0;
+	double CollectStartTime = 0.0;
+	double MaxCollectSeconds = 0.0;
+	FDelegateHandle PreCollectHandle;
+	FDelegateHandle PostCollectHandle;
+
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+};
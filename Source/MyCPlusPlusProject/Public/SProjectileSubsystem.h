@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/ChaosEngineInterface.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SProjectileSubsystem.generated.h"
+
+class ASMagicProjectile;
+
+// One projectile hitting something, recorded from the hit or overlap callback
+struct FSProjectileImpact
+{
+	TWeakObjectPtr<ASMagicProjectile> Projectile;
+	TWeakObjectPtr<AActor> HitActor;
+	TWeakObjectPtr<AActor> Instigator;
+	FVector Location = FVector::ZeroVector;
+	FVector Normal = FVector::UpVector;
+	EPhysicalSurface SurfaceType = SurfaceType_Default;
+};
+
+/*
+ * Magic projectile pipeline. Hits only append to the impact buffer, once per frame the buffered impacts spawn their
+ * (pooled) effects, queue their damage on USDamageSubsystem and return their projectiles to the pool, so a burst of
+ * hits in one physics step costs one pass and no actor is destroyed mid-callback.
+ *
+ * Projectiles that never hit anything are recycled after s.Projectile.MaxLifetime seconds or s.Projectile.MaxDistance
+ * of flight, and the oldest one is recycled when more than s.Projectile.MaxLive are flying, which keeps the number of
+ * live projectiles bounded however long a session runs. s.Projectile.Pool 0 destroys them instead of pooling.
+ * The soak test samples GetNumLive to show it stays flat.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USProjectileSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Reuses a pooled projectile of the class when there is one, spawns a new one otherwise
+	ASMagicProjectile* Launch(TSubclassOf<ASMagicProjectile> Class, const FVector& Location, const FRotator& Rotation, APawn* Instigator);
+
+	// Counts a projectile against the caps, projectiles call it in BeginPlay so spawned ones count too
+	void Track(ASMagicProjectile* Projectile);
+
+	void AddImpact(const FSProjectileImpact& Impact);
+
+	int32 GetNumLive() const { return Live.Num(); }
+
+	int32 GetNumPooled() const { return Pool.Num(); }
+
+protected:
+	// Oldest first
+	UPROPERTY()
+	TArray<ASMagicProjectile*> Live;
+
+	UPROPERTY()
+	TArray<ASMagicProjectile*> Pool;
+
+	// Reused every frame
+	TArray<FSProjectileImpact> Impacts;
+
+	void ProcessImpacts();
+
+	// Past their lifetime or distance, or over the live cap
+	void RecycleExpired();
+
+	void Recycle(ASMagicProjectile* Projectile);
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SPropInstanceManager.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class ASExplosiveBarrel;
+class ASItemChest;
+class USLootTable;
+class USPropSimulationSubsystem;
+class USSaveGameSubsystem;
+enum class ESSaveFlags : uint8;
+
+// A barrel or chest that currently lives as a full actor, remembered so it can be folded back into its instance slot
+USTRUCT()
+struct FSPromotedProp
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TWeakObjectPtr<AActor> Actor;
+
+	// Index of the (hidden) instance the actor was promoted from
+	int32 InstanceIndex = INDEX_NONE;
+
+	// Last time something (a hit, an interaction, a blackhole) needed the full actor
+	float LastActiveTime = 0.0f;
+};
+
+/*
+ * Renders dormant barrels and closed chests as HISM instances instead of one actor per prop.
+ * An instance is promoted to a real ASExplosiveBarrel/ASItemChest only when it is hit, interacted with
+ * or pulled by a blackhole, and demoted back to an instance once the actor has been idle for a while.
+ *
+ * Instances can either be painted directly into the HISM components in the editor, or the manager can
+ * absorb barrels and chests placed in the level as actors when the game starts.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API ASPropInstanceManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASPropInstanceManager();
+
+	// Turns the instance into a live barrel actor, returns nullptr if the slot is already promoted
+	ASExplosiveBarrel* PromoteBarrel(int32 InstanceIndex);
+
+	// Turns the chest instance (base + lid) into a live chest actor
+	ASItemChest* PromoteChest(int32 InstanceIndex);
+
+	// Resolves an interaction sweep hit against a chest instance to a live chest, barrels are left dormant
+	AActor* PromoteInteractableFromHit(const FHitResult& Hit);
+
+	// Promotes every dormant barrel within the radius and keeps already promoted ones awake, returns how many were promoted
+	int32 PromoteBarrelsInRadius(const FVector& Origin, float Radius);
+
+	// Restores a saved instance: hides exploded or destroyed ones, promotes and opens opened chests
+	bool ApplySavedInstance(const UHierarchicalInstancedStaticMeshComponent* Instances, int32 InstanceIndex, ESSaveFlags Flags);
+
+	int32 GetDormantBarrelCount() const;
+
+	int32 GetDormantChestCount() const;
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	UHierarchicalInstancedStaticMeshComponent* BarrelInstances;
+
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	UHierarchicalInstancedStaticMeshComponent* ChestBaseInstances;
+
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	UHierarchicalInstancedStaticMeshComponent* ChestLidInstances;
+
+	// Class spawned when a barrel instance is promoted
+	UPROPERTY(EditAnywhere, Category = "Props")
+	TSubclassOf<ASExplosiveBarrel> BarrelClass;
+
+	// Class spawned when a chest instance is promoted
+	UPROPERTY(EditAnywhere, Category = "Props")
+	TSubclassOf<ASItemChest> ChestClass;
+
+	// Offset of the lid relative to the chest base, copied from the first absorbed chest if one exists
+	UPROPERTY(EditAnywhere, Category = "Props")
+	FTransform LidRelativeTransform;
+
+	// Replace barrels and closed chests placed in the level with instances on BeginPlay
+	UPROPERTY(EditAnywhere, Category = "Props")
+	bool bAbsorbPlacedActors = true;
+
+	// Seconds a promoted prop has to stay untouched (and asleep) before it is turned back into an instance
+	UPROPERTY(EditAnywhere, Category = "Props")
+	float IdleTimeBeforeDemote = 5.0f;
+
+	// How often promoted props are checked for demotion, no need to do this every frame
+	UPROPERTY(EditAnywhere, Category = "Props")
+	float DemoteCheckInterval = 1.0f;
+
+	TArray<FSPromotedProp> PromotedBarrels;
+
+	TArray<FSPromotedProp> PromotedChests;
+
+	// Instance slots currently hidden because their prop is a live actor (or was destroyed)
+	TBitArray<> HiddenBarrelSlots;
+
+	TBitArray<> HiddenChestSlots;
+
+	// Loot table of every chest slot, absorbed chests keep the one they were placed with. Null rolls ChestClass's table
+	UPROPERTY()
+	TArray<USLootTable*> ChestLootTables;
+
+	// Simulation entity of every barrel slot, dormant barrels burn and explode inside USPropSimulationSubsystem
+	TArray<int32> BarrelEntities;
+
+	UPROPERTY()
+	USPropSimulationSubsystem* PropSimulation;
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	void AbsorbPlacedActors();
+
+	// Instances are saved by slot, which only identifies the same prop across runs if the manager was placed in the level
+	bool CanSaveInstances() const { return HasAnyFlags(RF_WasLoaded); }
+
+	// Removes the barrel for good, whether it is an instance or a promoted actor
+	void RemoveBarrel(int32 InstanceIndex);
+
+	// Effects and explosion settings of the barrel class, shared by every simulated barrel
+	const ASExplosiveBarrel* GetBarrelDefaults() const;
+
+	void HideInstance(UHierarchicalInstancedStaticMeshComponent* Instances, int32 InstanceIndex);
+
+	void DemoteIdleBarrels(float Now);
+
+	void DemoteIdleChests(float Now);
+
+	void OnSimEntitiesIgnited(TConstArrayView<int32> Entities);
+
+	void OnSimEntitiesExploded(TConstArrayView<int32> Entities);
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION()
+	void OnBarrelInstanceHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+public:
+	// Called every DemoteCheckInterval seconds
+	virtual void Tick(float DeltaTime) override;
+};
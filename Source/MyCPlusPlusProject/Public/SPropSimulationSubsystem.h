@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SGameplayRandomSubsystem.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SPropSimulationSubsystem.generated.h"
+
+class ASPropInstanceManager;
+
+// Per-entity state bits, kept in one byte so a chunk of flags fits in a couple of cache lines
+enum class ESPropSimFlags : uint8
+{
+	None		= 0,
+	// Entity is simulated by a live actor right now, processors skip it
+	Detached	= 1 << 0,
+	Burning		= 1 << 1,
+	Ignited		= 1 << 2,
+	// Fuse ran out this frame, resolved into an explosion by the game thread
+	PendingExplode = 1 << 3,
+	Exploded	= 1 << 4,
+};
+ENUM_CLASS_FLAGS(ESPropSimFlags);
+
+/*
+ * Structure-of-arrays storage for every simulated explosive prop. There is a single archetype (explosive prop),
+ * each array is one fragment and the entity id is the index into all of them. Entities are never compacted,
+ * removing one just sets Detached, so ids handed out to owners stay valid.
+ */
+struct FSPropSimFragments
+{
+	TArray<FVector3f> Positions;
+	TArray<float> Health;
+	TArray<float> FuseTimers;
+	TArray<ESPropSimFlags> Flags;
+
+	// Cold data, only touched on the game thread when an entity changes state
+	TArray<TWeakObjectPtr<ASPropInstanceManager>> Owners;
+	TArray<int32> OwnerIndices;
+
+	int32 Num() const { return Positions.Num(); }
+};
+
+// Explosion fed into the simulation, either by a simulated prop, a live ASExplosiveBarrel or a burning fire cell
+struct FSPropSimExplosion
+{
+	FVector3f Location;
+	float Radius;
+	// 1 for explosions, 0 for fire that only sets props burning
+	float DamageScale;
+	// Entity that exploded, INDEX_NONE for explosions coming from actors
+	int32 Entity;
+};
+
+/*
+ * Data-oriented simulation of dormant explosive props. Health, fuse and flame state of thousands of props are
+ * advanced by a few processors that run over the fragments in parallel chunks, so a level full of barrels costs
+ * a handful of tight loops instead of one actor tick (and a UObject) per barrel.
+ *
+ * Owners (the prop instance manager) only hear about entities whose state changed: started burning or exploded.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USPropSimulationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnEntitiesChanged, TConstArrayView<int32> /*Entities*/);
+
+	// Entities whose fuse ran out this frame, already flagged Exploded
+	FOnEntitiesChanged OnEntitiesExploded;
+
+	// Entities that caught fire this frame
+	FOnEntitiesChanged OnEntitiesIgnited;
+
+	int32 AddEntity(const FVector& Location, ASPropInstanceManager* Owner, int32 OwnerIndex);
+
+	// Hand the entity over to a live actor (promotion), or take it back at a new location (demotion)
+	void DetachEntity(int32 Entity);
+	void AttachEntity(int32 Entity, const FVector& Location);
+
+	// Owner is unloading, the id is recycled by a later AddEntity
+	void RemoveEntity(int32 Entity);
+
+	// Queue an explosion, applied to every attached entity in range on the next simulation step
+	void AddExplosion(const FVector& Location, float Radius);
+
+	// Sets every attached entity in range burning without damaging it, used by the fire simulation
+	void AddFire(const FVector& Location, float Radius);
+
+	const FSPropSimFragments& GetFragments() const { return Fragments; }
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	FSPropSimFragments Fragments;
+
+	// Removed entity ids, reused before the fragments grow
+	TArray<int32> FreeEntities;
+
+	// Explosions waiting to be applied on the next step
+	TArray<FSPropSimExplosion> PendingExplosions;
+
+	// Uniform XY hash grid over entity positions so explosions only visit nearby cells
+	TMap<FIntPoint, TArray<int32>> Grid;
+	bool bGridDirty = false;
+
+	void RebuildGrid();
+
+	FIntPoint GetCell(const FVector3f& Location) const;
+
+	// Fuse times vary a little per entity
+	FSCounterRandom FuseRandom;
+
+	float GetFuseTime(int32 Entity) const;
+
+	// Processors, each one a pass over the fragments
+	void ProcessFuses(float DeltaTime);
+	void ProcessFlames(float DeltaTime);
+	void CollectExplosions(TArray<int32>& OutExploded);
+	void ProcessExplosions(TArray<int32>& OutIgnited);
+};
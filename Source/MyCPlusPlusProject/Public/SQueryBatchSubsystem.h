@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "SQueryBatchSubsystem.generated.h"
+
+enum class ESBatchedQueryType : uint8
+{
+	// Single line trace by channel, the crosshair trace
+	Line,
+	// Multi sphere sweep by object type, the interaction sweep
+	Sweep,
+};
+
+struct FSBatchedQuery
+{
+	ESBatchedQueryType Type = ESBatchedQueryType::Line;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+
+	// Lines only
+	ECollisionChannel Channel = ECC_Visibility;
+
+	// Sweeps only
+	float Radius = 0.0f;
+	FCollisionObjectQueryParams ObjectTypes;
+
+	// Usually the one asking, never hit
+	const AActor* Ignore = nullptr;
+};
+
+// Queries closer than the batching tolerance that ignore the same actor share a key
+struct FSBatchedQueryKey
+{
+	FIntVector Start;
+	FIntVector End;
+	int32 Radius = 0;
+	int32 Filter = 0;
+	ESBatchedQueryType Type = ESBatchedQueryType::Line;
+	const AActor* Ignore = nullptr;
+
+	bool operator==(const FSBatchedQueryKey& Other) const
+	{
+		return Start == Other.Start && End == Other.End && Radius == Other.Radius && Filter == Other.Filter && Type == Other.Type
+			&& Ignore == Other.Ignore;
+	}
+
+	friend uint32 GetTypeHash(const FSBatchedQueryKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Start), GetTypeHash(Key.End)),
+			HashCombine(HashCombine(Key.Radius, Key.Filter), PointerHash(Key.Ignore)));
+	}
+};
+
+// Hits ordered by distance, empty when nothing was hit
+using FSBatchedQueryCallback = TFunction<void(TConstArrayView<FHitResult> Hits)>;
+
+/*
+ * Collects the bots' aim traces and everyone's interaction sweeps during the frame and submits them together to the
+ * engine's async scene queries at the end of it. Queries that start and end within s.QueryBatch.Tolerance of each other
+ * and ignore the same actor (the same caller asking twice in a frame) run once and every caller gets the result.
+ * Results arrive through the callback in the next frame. A local player's crosshair trace doesn't come here, the shot
+ * would leave a frame late.
+ *
+ * s.QueryBatch 0 runs every query immediately instead, the baseline for comparisons.
+ * s.QueryBatch.Benchmark [Players] [Bots] [Frames] compares both on synthetic frames of queries from the registered
+ * pawns: every local player aims and interacts each frame, every bot every few frames (4 and 50 by default). It
+ * reports the game thread cost of running every query immediately, the game thread cost of de-duplicating and
+ * submitting the async batch, and the scene query time the batch moves to the async trace threads.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USQueryBatchSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void Request(const FSBatchedQuery& Query, FSBatchedQueryCallback Callback);
+
+	void RunBenchmark(int32 NumPlayers, int32 NumBots, int32 NumFrames);
+
+protected:
+	struct FGroup
+	{
+		FSBatchedQuery Query;
+		TArray<FSBatchedQueryCallback, TInlineAllocator<2>> Callbacks;
+		FTraceHandle Handle;
+	};
+
+	// Collected this frame
+	TArray<FGroup> Pending;
+	TMap<FSBatchedQueryKey, int32> PendingByKey;
+
+	// Submitted last frame
+	TArray<FGroup> InFlight;
+
+	int32 NumRequested = 0;
+	int32 NumSubmitted = 0;
+
+	void Submit(FGroup& Group) const;
+
+	// Runs the query right away
+	void Execute(const FSBatchedQuery& Query, TArray<FHitResult>& OutHits) const;
+
+	void CollectResults();
+
+	static FSBatchedQueryKey MakeKey(const FSBatchedQuery& Query, float Tolerance);
+};
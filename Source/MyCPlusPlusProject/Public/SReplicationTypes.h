@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "SReplicationTypes.generated.h"
+
+// Which of the character's projectile classes a spawn event refers to
+UENUM()
+enum class ESProjectileSlot : uint8
+{
+	Primary,
+	Special,
+	Dash,
+};
+
+/*
+ * A projectile is replicated once, as this event, and then simulated locally by every client.
+ * Quantized origin and direction plus a slot byte and a timestamp, roughly 16 bytes on the wire.
+ */
+USTRUCT()
+struct FSProjectileSpawnEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	UPROPERTY()
+	ESProjectileSlot Slot = ESProjectileSlot::Primary;
+
+	// Server world time of the spawn, clients fast-forward the projectile by their delay
+	UPROPERTY()
+	float ServerTime = 0.0f;
+};
+
+UENUM()
+enum class ESNetWorldEventType : uint8
+{
+	Explosion,
+	Absorbed,
+};
+
+// Explosions and blackhole absorptions, sent to each client in one batch per frame
+USTRUCT()
+struct FSNetWorldEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	ESNetWorldEventType Type = ESNetWorldEventType::Explosion;
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	// Class of the barrel or blackhole, clients take effects from its defaults. Classes cost a few bytes once
+	// their NetGUID is acked, the actors themselves are usually gone by the time the batch is sent.
+	UPROPERTY()
+	TSubclassOf<AActor> SourceClass;
+};
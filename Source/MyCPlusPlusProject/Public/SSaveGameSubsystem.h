@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Async/MappedFileHandle.h"
+#include "Serialization/MemoryReader.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SSaveGameSubsystem.generated.h"
+
+// What happened to a tracked object since its level was loaded, the only thing a save stores about it
+enum class ESSaveFlags : uint8
+{
+	None		= 0,
+	Opened		= 1 << 0,
+	Exploded	= 1 << 1,
+	// Gone from the world: exploded, swallowed by a blackhole, ...
+	Destroyed	= 1 << 2,
+};
+ENUM_CLASS_FLAGS(ESSaveFlags);
+
+/*
+ * Identifies an object placed in a level across runs: its path without the PIE prefix, and for instanced props the
+ * instance index in the HISM component the path points to. Objects spawned at runtime have no key.
+ */
+struct FSSaveKey
+{
+	// Package of the level, to find the records of a level that streams in
+	FName Package;
+	FName Path;
+	int32 Index = INDEX_NONE;
+
+	FSSaveKey() = default;
+	MYCPLUSPLUSPROJECT_API explicit FSSaveKey(const UObject* Object, int32 InIndex = INDEX_NONE);
+
+	bool IsValid() const { return !Path.IsNone(); }
+
+	bool operator==(const FSSaveKey& Other) const { return Path == Other.Path && Index == Other.Index; }
+
+	friend uint32 GetTypeHash(const FSSaveKey& Key) { return HashCombine(GetTypeHash(Key.Path), ::GetTypeHash(Key.Index)); }
+};
+
+/*
+ * Persists what players did to the interactive objects of a world: opened chests, exploded barrels (actors or
+ * instances), physics props a blackhole swallowed. Gameplay code reports each change with MarkChanged, so the
+ * subsystem holds the delta against the levels as they were loaded and never walks the world to build a save.
+ *
+ * Saving copies the deltas into flat arrays on the game thread and serializes them through an FArchive on a pool
+ * thread, the frame that saves only pays for the copy. The file is a header (magic, version, counts), a table of
+ * object paths and one fixed size record per changed object:
+ *     [uint32 Magic "SSAV"][uint32 Version][int32 NumPaths][int32 NumRecords]
+ *     NumPaths x FString object path
+ *     NumRecords x [int32 PathIndex][int32 InstanceIndex][uint8 Flags]
+ *
+ * Loading memory maps the file and reads s.Save.ApplyBatch records per frame, applying each one to its object if
+ * the object's level is loaded. Records are kept after loading and applied again whenever their level streams in.
+ * Load right after the map, before anything else changed: s.Save.Load, or -LoadGame=<Name> on the command line.
+ *
+ * s.Save.Benchmark [Count] times snapshot, serialization, write and load of Count synthetic records (100000 by
+ * default) without touching the world.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USSaveGameSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return LoadReader.IsValid() || ApplyQueue.Num() > 0; }
+	virtual TStatId GetStatId() const override;
+
+	// Key of an actor for saving: its own path if it was placed in a level, its instance slot if it was promoted from one
+	static FSSaveKey GetSaveKey(const AActor* Actor);
+
+	void MarkChanged(const FSSaveKey& Key, ESSaveFlags Flags);
+	void MarkChanged(const AActor* Actor, ESSaveFlags Flags);
+
+	// Writes the current deltas to Saved/SaveGames/<Name>.sav in the background
+	void SaveGame(const FString& Name);
+
+	// Replaces the current deltas with the ones in the file and starts applying them
+	bool LoadGame(const FString& Name);
+
+	void RunBenchmark(int32 NumRecords);
+
+	int32 GetNumRecords() const { return Records.Num(); }
+
+protected:
+	static constexpr uint32 FileMagic = 0x56415353; // "SSAV"
+	static constexpr uint32 FileVersion = 1;
+
+	// Game thread copy of the deltas handed to the serialization task
+	struct FSnapshot
+	{
+		// Converted to text on the worker
+		TArray<FName> Paths;
+		TArray<int32> PathIndices;
+		TArray<int32> Indices;
+		TArray<ESSaveFlags> Flags;
+	};
+
+	TMap<FSSaveKey, ESSaveFlags> Records;
+
+	// Records waiting to be applied to their objects, filled by loading and by levels streaming in
+	TArray<FSSaveKey> ApplyQueue;
+
+	TFuture<void> PendingSave;
+
+	TUniquePtr<IMappedFileHandle> LoadFile;
+	TUniquePtr<IMappedFileRegion> LoadRegion;
+	TUniquePtr<FMemoryReaderView> LoadReader;
+	TArray<FSSaveKey> LoadKeys;
+	int32 LoadRecordsRemaining = 0;
+	double LoadStartTime = 0.0;
+
+	FDelegateHandle LevelAddedHandle;
+
+	static FString ResolvePath(const FString& Name);
+
+	static void MakeSnapshot(const TMap<FSSaveKey, ESSaveFlags>& InRecords, FSnapshot& OutSnapshot);
+	static void SerializeSnapshot(const FSnapshot& Snapshot, TArray<uint8>& OutBytes);
+
+	// Reads header and path table, leaves the reader on the first record
+	static bool ReadHeader(FArchive& Ar, TArray<FSSaveKey>& OutKeys, int32& OutNumRecords);
+	static void ReadRecord(FArchive& Ar, const TArray<FSSaveKey>& Keys, FSSaveKey& OutKey, ESSaveFlags& OutFlags);
+
+	void ReadLoadBatch(int32 BatchSize);
+	void StopLoading();
+
+	// False if the object isn't loaded or not ready yet
+	bool ApplyRecord(const FSSaveKey& Key, ESSaveFlags Flags);
+
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SMemoryBudget.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SSoakTestSubsystem.generated.h"
+
+class ASBotController;
+
+/*
+ * Soak and scaling test. Spawns N bot characters (ASBotController) around the player start, lets them play for a
+ * fixed time and then logs the frame time together with the cost of each of our systems (FSFrameCost) and the peak
+ * memory of the budgeted classes (FSMemoryBudget), and whether the number of live projectiles stayed flat. After a
+ * warmup, FSObjectChurnProbe counts the UObjects created per class. A headless run exits with an error when a peak is
+ * over budget or gameplay classes churn.
+ *
+ * From the console:   s.Soak.Start <Bots> <Seconds> [Seed], s.Soak.Stop
+ * Headless:           MyCPlusPlusProject <Map> -game -nullrhi -unattended -SoakBots=64 -SoakSeconds=120
+ *                     starts with the first game world and quits once the report is written.
+ *
+ * Bots act on the server only, run on a listen/dedicated server or in standalone.
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USSoakTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void StartSoak(int32 NumBots, float Duration, int32 Seed);
+
+	// Writes the report and removes the bots
+	void StopSoak();
+
+	bool IsRunning() const { return bRunning; }
+
+protected:
+	// Bots are spread over a disc this large around the spawn point
+	float SpawnRadius = 3000.0f;
+
+	UPROPERTY()
+	TArray<APawn*> Bots;
+
+	UPROPERTY()
+	TArray<ASBotController*> BotControllers;
+
+	bool bRunning = false;
+
+	// Started from the command line, quit when done
+	bool bExitWhenDone = false;
+
+	float TimeRemaining = 0.0f;
+
+	// Bots spawning and levels streaming in create objects, steady state starts this long after the soak does
+	float ProbeWarmup = 30.0f;
+	float ProbeTimeRemaining = 0.0f;
+	int32 NumFrames = 0;
+	double TotalFrameSeconds = 0.0;
+	double MaxFrameSeconds = 0.0;
+
+	// Gathering walks every actor, sampled a few times per second rather than every frame
+	float MemorySampleInterval = 0.25f;
+	float MemorySampleTime = 0.0f;
+	TArray<FSMemoryBudgetEntry> PeakMemory;
+
+	// Magic projectiles in flight at each memory sample, should stay flat however long the soak runs
+	TArray<int32> LiveProjectileSamples;
+
+	void SampleMemory();
+
+	FVector FindSpawnCenter() const;
+
+	void SpawnBots(int32 NumBots, int32 Seed);
+
+	void DestroyBots();
+
+	// Returns whether every peak stayed within its memory budget
+	bool LogReport() const;
+};
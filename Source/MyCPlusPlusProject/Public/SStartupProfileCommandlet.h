@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SStartupProfileCommandlet.generated.h"
+
+/*
+ * Profiles what the module costs at startup:
+ *  - constructs every class of the module as an archetype, the same constructor and default subobject work a CDO
+ *    or a Blueprint template costs, and lists the classes by construction time with their default subobjects
+ *  - the editor boot time of this run, up to the module load and the engine init
+ *  - the game boot time, by launching the project with -game -nullrhi until its first map is loaded
+ *
+ *     UnrealEditor-Cmd MyCPlusPlusProject.uproject -run=SStartupProfile [-Iterations=100] [-Map=<Map>] [-NoGame]
+ */
+UCLASS()
+class MYCPLUSPLUSPROJECT_API USStartupProfileCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	USStartupProfileCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	void ProfileConstruction(int32 Iterations) const;
+
+	// Wall time of a game process until its first map is loaded, negative when it couldn't run
+	double ProfileGameBoot(const FString& Map) const;
+};
@@ -0,0 +1,17 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Automation tests for gameplay correctness, each one with time and allocation budgets. Going over an allocation budget
+ * fails the run. Wall-clock time depends on the machine, going over a time budget is a warning unless -TestPerfBudgets
+ * is on the command line (dedicated perf runs). The module is a developer tool, it is built and loaded in editor and
+ * non-shipping game builds.
+ *
+ * Headless on Linux:
+ *     UnrealEditor-Cmd MyCPlusPlusProject.uproject -game -nullrhi -unattended -nosplash -nosound
+ *         -ExecCmds="Automation RunTests MyCPlusPlusProject; Quit"
+ * -TestBudgetScale=<Factor> loosens every time budget for slow build machines.
+ */
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "SAttributeComponent.h"
+#include "SCharacter.h"
+#include "SExplosiveBarrel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBarrelExplodesOnceTest, "MyCPlusPlusProject.Barrel.ExplodesOnce", S_TEST_FLAGS)
+
+bool FSBarrelExplodesOnceTest::RunTest(const FString& Parameters)
+{
+	// Unoccluded, the damage is applied in the frame after the explosion and is exactly the falloff
+	FSScopedConsoleVariable Occlusion(TEXT("s.Explosion.Occlusion"), 0);
+	FSTestWorld World;
+
+	USAttributeComponent* Attributes = FSTestWorld::AddAttributes(World.Spawn<AActor>(FVector::ZeroVector));
+
+	const FVector BarrelLocation(100.0f, 0.0f, 0.0f);
+	ASExplosiveBarrel* Barrel = World.Spawn<ASExplosiveBarrel>(BarrelLocation);
+	const float ExpectedHealth = Attributes->GetHealth() - Barrel->GetExplosionDamage() * (1.0f - BarrelLocation.Size() / Barrel->GetExplosionRadius());
+
+	{
+		FSPerfBudget Budget(*this, TEXT("Explosion"), 5.0, 16);
+
+		// A hit and an overlap in the same frame both request the explosion
+		Barrel->RequestExplode();
+		Barrel->RequestExplode();
+		World.Tick(0.1f);
+	}
+
+	TestFalse(TEXT("Barrel is destroyed"), IsValid(Barrel));
+	TestEqual(TEXT("Target is damaged once"), Attributes->GetHealth(), ExpectedHealth, 0.01f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBarrelKnocksCharacterBackTest, "MyCPlusPlusProject.Barrel.KnocksCharacterBack", S_TEST_FLAGS)
+
+bool FSBarrelKnocksCharacterBackTest::RunTest(const FString& Parameters)
+{
+	// Characters don't simulate, the impulse reaches them through their movement component
+	FSScopedConsoleVariable Occlusion(TEXT("s.Explosion.Occlusion"), 0);
+	FSTestWorld World;
+	World.SpawnFloor();
+
+	ASCharacter* Character = World.Spawn<ASCharacter>(FVector(0.0f, 0.0f, 100.0f));
+	Character->SpawnDefaultController();
+	World.Tick(0.2f);
+	const FVector Start = Character->GetActorLocation();
+
+	ASExplosiveBarrel* Barrel = World.Spawn<ASExplosiveBarrel>(Start + FVector(150.0f, 0.0f, 0.0f));
+	Barrel->RequestExplode();
+	World.Tick(0.2f);
+
+	TestTrue(TEXT("Character is pushed away from the barrel"), Character->GetActorLocation().X < Start.X - 10.0f);
+	return true;
+}
+
+#endif
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "BlackholeProjectile.h"
+#include "Engine/StaticMeshActor.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBlackholeAbsorbsSimulatingTest, "MyCPlusPlusProject.Blackhole.AbsorbsOnlySimulating", S_TEST_FLAGS)
+
+bool FSBlackholeAbsorbsSimulatingTest::RunTest(const FString& Parameters)
+{
+	FSTestWorld World;
+
+	// Both inside the blackhole's sphere when it spawns, only one of them simulates
+	const FVector BoxSize(20.0f);
+	AStaticMeshActor* Simulating = World.SpawnFloatingBox(FVector(0.0f, 50.0f, 0.0f), BoxSize);
+	AStaticMeshActor* Static = World.SpawnBox(FVector(0.0f, -50.0f, 0.0f), BoxSize, TEXT("PhysicsActor"), false);
+
+	{
+		FSPerfBudget Budget(*this, TEXT("Absorb"), 10.0, 32);
+
+		World.Spawn<ABlackholeProjectile>(FVector::ZeroVector);
+		World.Tick(0.1f);
+	}
+
+	TestFalse(TEXT("Simulating body is absorbed"), IsValid(Simulating));
+	TestTrue(TEXT("Static body is kept"), IsValid(Static));
+	return true;
+}
+
+#endif
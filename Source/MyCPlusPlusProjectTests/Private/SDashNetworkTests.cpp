@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "SCharacter.h"
+#include "SCharacterMovementComponent.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "Editor.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationEditorCommon.h"
+
+namespace SDashNetworkTest
+{
+	// Listen server and one client in the editor process, the client sees 150 ms round trips and loses packets
+	constexpr int32 OneWayLatencyMs = 75;
+	constexpr int32 PacketLossPercent = 2;
+	constexpr int32 NumDashes = 5;
+	constexpr double Timeout = 30.0;
+
+	struct FState
+	{
+		TWeakObjectPtr<ASCharacter> Client;
+		TWeakObjectPtr<ASCharacter> ServerCopy;
+		FVector DashStart = FVector::ZeroVector;
+		double StepStartTime = 0.0;
+		int32 DashIndex = 0;
+	};
+
+	UWorld* FindPlayWorld(ENetMode NetMode)
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (Context.WorldType == EWorldType::PIE && World && World->GetNetMode() == NetMode)
+			{
+				return World;
+			}
+		}
+		return nullptr;
+	}
+
+	bool FindCharacters(FState& State)
+	{
+		UWorld* ClientWorld = FindPlayWorld(NM_Client);
+		UWorld* ServerWorld = FindPlayWorld(NM_ListenServer);
+		const APlayerController* PC = ClientWorld ? ClientWorld->GetFirstPlayerController() : nullptr;
+		State.Client = PC ? Cast<ASCharacter>(PC->GetPawn()) : nullptr;
+		if (!ServerWorld || !State.Client.IsValid())
+		{
+			return false;
+		}
+
+		// The server's copy of the client is the one character there that is possessed but not locally controlled
+		for (TActorIterator<ASCharacter> It(ServerWorld); It; ++It)
+		{
+			if (It->GetController() && !It->IsLocallyControlled())
+			{
+				State.ServerCopy = *It;
+			}
+		}
+		return State.ServerCopy.IsValid();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDashPredictionTest, "MyCPlusPlusProject.Dash.PredictedUnderLatencyAndLoss",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FSDashPredictionTest::RunTest(const FString& Parameters)
+{
+	using namespace SDashNetworkTest;
+
+	if (!FAutomationEditorCommonUtils::LoadMap(TEXT("/Game/ActionRoguelike/Maps/TestLevel")))
+	{
+		AddError(TEXT("Could not load TestLevel"));
+		return false;
+	}
+
+	ULevelEditorPlaySettings* PlaySettings = NewObject<ULevelEditorPlaySettings>();
+	PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+	PlaySettings->SetPlayNumberOfClients(2);
+	PlaySettings->SetRunUnderOneProcess(true);
+	PlaySettings->NetworkEmulationSettings.bIsNetworkEmulationEnabled = true;
+	PlaySettings->NetworkEmulationSettings.EmulationTarget = NetworkEmulationTarget::Client;
+	for (FNetworkEmulationPacketSettings* Packets : { &PlaySettings->NetworkEmulationSettings.OutPackets, &PlaySettings->NetworkEmulationSettings.InPackets })
+	{
+		Packets->MinLatency = OneWayLatencyMs;
+		Packets->MaxLatency = OneWayLatencyMs;
+		Packets->PacketLossPercentage = PacketLossPercent;
+	}
+
+	FRequestPlaySessionParams PlayParams;
+	PlayParams.WorldType = EPlaySessionWorldType::PlayInEditor;
+	PlayParams.EditorPlaySettings = PlaySettings;
+	GEditor->RequestPlaySession(PlayParams);
+
+	TSharedRef<FState> State = MakeShared<FState>();
+	State->StepStartTime = FPlatformTime::Seconds();
+
+	// Both characters exist and the client has settled on the floor
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State]()
+	{
+		if (FPlatformTime::Seconds() - State->StepStartTime > Timeout)
+		{
+			AddError(TEXT("Client character never spawned"));
+			return true;
+		}
+		if (!FindCharacters(*State) || State->Client->GetCharacterMovement()->IsFalling())
+		{
+			return false;
+		}
+		State->StepStartTime = FPlatformTime::Seconds();
+		return true;
+	}));
+
+	for (int32 DashIndex = 0; DashIndex < NumDashes; DashIndex++)
+	{
+		// The same dashes every run: one second of rest, then a dash in a fixed direction
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([State, DashIndex]()
+		{
+			ASCharacter* Client = State->Client.Get();
+			if (!Client || FPlatformTime::Seconds() - State->StepStartTime < 1.0)
+			{
+				return Client == nullptr;
+			}
+
+			const FVector Direction = FRotator(0.0f, DashIndex * 360.0f / NumDashes, 0.0f).Vector();
+			State->DashStart = Client->GetActorLocation();
+			CastChecked<USCharacterMovementComponent>(Client->GetCharacterMovement())->RequestDash(State->DashStart, Direction);
+			State->StepStartTime = FPlatformTime::Seconds();
+			return true;
+		}));
+
+		// Predicted: the client lands on its own timer, before the server's teleport could have come back
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, DashIndex]()
+		{
+			ASCharacter* Client = State->Client.Get();
+			const USCharacterMovementComponent* Movement = Client ? Cast<USCharacterMovementComponent>(Client->GetCharacterMovement()) : nullptr;
+			if (!Movement)
+			{
+				return true;
+			}
+			if (FPlatformTime::Seconds() - State->StepStartTime < Movement->DetonateDelay + Movement->TeleportDelay + 0.05)
+			{
+				return false;
+			}
+
+			TestTrue(FString::Printf(TEXT("Dash %d moved the client without waiting for the server"), DashIndex),
+				FVector::Dist2D(Client->GetActorLocation(), State->DashStart) > 100.0f);
+			State->StepStartTime = FPlatformTime::Seconds();
+			return true;
+		}));
+
+		// Reconciled: once the moves are acknowledged, client and server agree on the landing
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, State, DashIndex]()
+		{
+			if (FPlatformTime::Seconds() - State->StepStartTime < 1.0)
+			{
+				return false;
+			}
+
+			const ASCharacter* Client = State->Client.Get();
+			const ASCharacter* ServerCopy = State->ServerCopy.Get();
+			if (TestTrue(TEXT("Characters still exist"), Client && ServerCopy))
+			{
+				TestTrue(FString::Printf(TEXT("Dash %d landed in the same place on client and server"), DashIndex),
+					FVector::Dist(Client->GetActorLocation(), ServerCopy->GetActorLocation()) < 10.0f);
+			}
+			State->StepStartTime = FPlatformTime::Seconds();
+			return true;
+		}));
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([]()
+	{
+		GEditor->RequestEndPlayMap();
+		return true;
+	}));
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([]()
+	{
+		return GEditor->PlayWorld == nullptr;
+	}));
+	return true;
+}
+
+#endif
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "SCharacter.h"
+#include "SCharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSDashValidLocationTest, "MyCPlusPlusProject.Dash.TeleportsToValidLocation", S_TEST_FLAGS)
+
+bool FSDashValidLocationTest::RunTest(const FString& Parameters)
+{
+	FSTestWorld World;
+	World.SpawnFloor();
+
+	// The wall is inside dash range, the landing has to stay in front of it
+	const float WallFront = 550.0f;
+	World.SpawnBox(FVector(WallFront + 50.0f, 0.0f, 200.0f), FVector(100.0f, 1000.0f, 400.0f));
+
+	ASCharacter* Character = World.Spawn<ASCharacter>(FVector(0.0f, 0.0f, 100.0f));
+	Character->SpawnDefaultController();
+	World.Tick(0.2f);
+
+	USCharacterMovementComponent* Movement = CastChecked<USCharacterMovementComponent>(Character->GetCharacterMovement());
+	const FVector Start = Character->GetActorLocation();
+
+	{
+		FSPerfBudget Budget(*this, TEXT("Dash"), 10.0, 8);
+
+		Movement->RequestDash(Start, FVector::ForwardVector);
+		World.Tick(Movement->DetonateDelay + Movement->TeleportDelay + 0.2f);
+	}
+
+	const FVector End = Character->GetActorLocation();
+	UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+
+	TestTrue(TEXT("Dash moved forward"), End.X > Start.X + 100.0f);
+	TestTrue(TEXT("Dash stopped before the wall"), End.X + Capsule->GetScaledCapsuleRadius() <= WallFront + 1.0f);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SDashTest), false, Character);
+	const bool bEncroaching = World.Get()->OverlapBlockingTestByChannel(End, Capsule->GetComponentQuat(), Capsule->GetCollisionObjectType(),
+		Capsule->GetCollisionShape(-1.0f), QueryParams);
+	TestFalse(TEXT("Dash landed outside geometry"), bEncroaching);
+	return true;
+}
+
+#endif
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "SCharacter.h"
+#include "SItemChest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSInteractionNearestTest, "MyCPlusPlusProject.Interaction.HitsNearest", S_TEST_FLAGS)
+
+bool FSInteractionNearestTest::RunTest(const FString& Parameters)
+{
+	FSTestWorld World;
+	World.SpawnFloor();
+
+	ASCharacter* Character = World.Spawn<ASCharacter>(FVector(0.0f, 0.0f, 100.0f));
+	Character->SpawnDefaultController();
+	World.Tick(0.2f);
+
+	// Two chests in line with the view, the sweep reaches both
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	Character->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	ASItemChest* NearChest = World.Spawn<ASItemChest>(FVector(250.0f, 0.0f, EyeLocation.Z));
+	ASItemChest* FarChest = World.Spawn<ASItemChest>(FVector(450.0f, 0.0f, EyeLocation.Z));
+	FSTestWorld::SetCubeMesh(NearChest->GetBasicMesh());
+	FSTestWorld::SetCubeMesh(FarChest->GetBasicMesh());
+
+	{
+		FSPerfBudget Budget(*this, TEXT("Interact"), 5.0, 8);
+
+		// The sweep is batched and comes back next frame, the interaction event is handled after it
+		Character->PrimaryInteract();
+		World.Tick(4.0f / 30.0f);
+	}
+
+	TestTrue(TEXT("Nearest chest is opened"), NearChest->IsOpen());
+	TestFalse(TEXT("Farther chest is left closed"), FarChest->IsOpen());
+	return true;
+}
+
+#endif
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "BlackholeProjectile.h"
+#include "SGameplayRegistrySubsystem.h"
+#include "SGravityWellSubsystem.h"
+#include "Engine/StaticMeshActor.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+static const float TestFrameRates[] = { 30.0f, 60.0f, 144.0f };
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGravityWellFrameRateTest, "MyCPlusPlusProject.Physics.GravityWellSameAtAnyFrameRate", S_TEST_FLAGS)
+
+bool FSGravityWellFrameRateTest::RunTest(const FString& Parameters)
+{
+	FSScopedConsoleVariable AsyncWells(TEXT("s.Physics.AsyncWells"), 1);
+
+	TArray<float> Pulled;
+	for (const float FrameRate : TestFrameRates)
+	{
+		FSTestWorld World;
+
+		const FVector Start(1000.0f, 0.0f, 0.0f);
+		AStaticMeshActor* Box = World.SpawnFloatingBox(Start, FVector(20.0f));
+		World.Get()->GetSubsystem<USGameplayRegistrySubsystem>()->Register(Box, ESRegistryKind::PhysicsProp);
+
+		// Weak enough that the box is still on its way after a second. The strength is a force, scaled by the box's
+		// mass for the same 500 cm/s^2 pull whatever the engine cube weighs
+		FSGravityWell Well;
+		Well.Radius = 5000.0f;
+		Well.Strength = -500.0f * Box->GetStaticMeshComponent()->GetMass();
+		World.Get()->GetSubsystem<USGravityWellSubsystem>()->SetWell(Box, Well);
+
+		World.Tick(1.0f, 1.0f / FrameRate);
+		Pulled.Add(Start.X - Box->GetActorLocation().X);
+	}
+
+	TestTrue(TEXT("Box is pulled towards the well"), Pulled[0] > 100.0f);
+	for (int32 i = 1; i < Pulled.Num(); i++)
+	{
+		TestEqual(FString::Printf(TEXT("Pull at %.0f FPS matches 30 FPS"), TestFrameRates[i]), Pulled[i], Pulled[0], Pulled[0] * 0.1f);
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSBlackholeBouncesTest, "MyCPlusPlusProject.Physics.BlackholeBouncesAtAnyFrameRate", S_TEST_FLAGS)
+
+bool FSBlackholeBouncesTest::RunTest(const FString& Parameters)
+{
+	for (const float FrameRate : TestFrameRates)
+	{
+		FSTestWorld World;
+
+		// Thinner than a 30 FPS frame of travel, an unswept blackhole passes through it
+		World.SpawnBox(FVector(300.0f, 0.0f, 0.0f), FVector(5.0f, 1000.0f, 1000.0f));
+		ABlackholeProjectile* Blackhole = World.Spawn<ABlackholeProjectile>(FVector::ZeroVector);
+
+		World.Tick(1.0f, 1.0f / FrameRate);
+
+		TestTrue(FString::Printf(TEXT("Blackhole bounced off the wall at %.0f FPS"), FrameRate),
+			IsValid(Blackhole) && Blackhole->GetActorLocation().X < 300.0f && Blackhole->GetVelocity().X < 0.0f);
+	}
+	return true;
+}
+
+#endif
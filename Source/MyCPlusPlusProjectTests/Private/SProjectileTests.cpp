@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "STestWorld.h"
+#include "SAttributeComponent.h"
+#include "SMagicProjectile.h"
+#include "SProjectileSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSProjectileRecycledTest, "MyCPlusPlusProject.Projectile.RecycledAfterHit", S_TEST_FLAGS)
+
+bool FSProjectileRecycledTest::RunTest(const FString& Parameters)
+{
+	FSTestWorld World;
+	World.SpawnBox(FVector(500.0f, 0.0f, 0.0f), FVector(100.0f, 1000.0f, 1000.0f));
+
+	USProjectileSubsystem* Projectiles = World.Get()->GetSubsystem<USProjectileSubsystem>();
+	ASMagicProjectile* First = Projectiles->Launch(ASMagicProjectile::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator, nullptr);
+	World.Tick(0.5f);
+
+	TestEqual(TEXT("Projectile that hit the wall is no longer live"), Projectiles->GetNumLive(), 0);
+	TestEqual(TEXT("Projectile that hit the wall is pooled"), Projectiles->GetNumPooled(), 1);
+
+	ASMagicProjectile* Second = nullptr;
+	{
+		FSPerfBudget Budget(*this, TEXT("Relaunch"), 2.0, 0);
+		Second = Projectiles->Launch(ASMagicProjectile::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator, nullptr);
+	}
+	TestTrue(TEXT("Relaunch reuses the pooled projectile"), Second == First);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSProjectileDamagesOnHitTest, "MyCPlusPlusProject.Projectile.DamagesPawnItHits", S_TEST_FLAGS)
+
+bool FSProjectileDamagesOnHitTest::RunTest(const FString& Parameters)
+{
+	FSTestWorld World;
+
+	// Pawns block projectiles, the damage has to come from the hit
+	USAttributeComponent* Attributes = FSTestWorld::AddAttributes(World.SpawnBox(FVector(500.0f, 0.0f, 0.0f), FVector(100.0f), TEXT("Pawn")));
+	const float StartHealth = Attributes->GetHealth();
+
+	USProjectileSubsystem* Projectiles = World.Get()->GetSubsystem<USProjectileSubsystem>();
+	ASMagicProjectile* Projectile = Projectiles->Launch(ASMagicProjectile::StaticClass(), FVector::ZeroVector, FRotator::ZeroRotator, nullptr);
+	const float DamageAmount = Projectile->GetDamageAmount();
+	World.Tick(0.5f);
+
+	TestEqual(TEXT("Pawn took the projectile's damage once"), Attributes->GetHealth(), StartHealth - DamageAmount, 0.01f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSProjectileLiveCapTest, "MyCPlusPlusProject.Projectile.LiveCountBounded", S_TEST_FLAGS)
+
+bool FSProjectileLiveCapTest::RunTest(const FString& Parameters)
+{
+	FSScopedConsoleVariable MaxLive(TEXT("s.Projectile.MaxLive"), 16);
+	FSTestWorld World;
+
+	// Into the void, nothing to hit: only the caps recycle them
+	USProjectileSubsystem* Projectiles = World.Get()->GetSubsystem<USProjectileSubsystem>();
+	int32 MaxSeen = 0;
+	for (int32 i = 0; i < 200; i++)
+	{
+		Projectiles->Launch(ASMagicProjectile::StaticClass(), FVector::ZeroVector, FRotator(0.0f, i * 7.0f, 0.0f), nullptr);
+		World.Tick(0.1f);
+		MaxSeen = FMath::Max(MaxSeen, Projectiles->GetNumLive());
+	}
+
+	TestTrue(TEXT("Live projectiles stay within s.Projectile.MaxLive"), MaxSeen <= 16);
+	TestTrue(TEXT("Pool stays within s.Projectile.MaxLive"), Projectiles->GetNumPooled() <= 16);
+	return true;
+}
+
+#endif
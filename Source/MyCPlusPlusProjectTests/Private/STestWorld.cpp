@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "STestWorld.h"
+
+#include "SAttributeComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectArray.h"
+
+FSTestWorld::FSTestWorld()
+{
+	World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("STestWorld"));
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	// The project's game mode, so gameplay subsystems see the same setup as in a map
+	const FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+}
+
+FSTestWorld::~FSTestWorld()
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+void FSTestWorld::Tick(float Seconds, float DeltaTime)
+{
+	const int32 NumSteps = FMath::Max(FMath::RoundToInt(Seconds / DeltaTime), 1);
+	for (int32 Step = 0; Step < NumSteps; Step++)
+	{
+		World->Tick(LEVELTICK_All, DeltaTime);
+	}
+}
+
+void FSTestWorld::SetCubeMesh(UStaticMeshComponent* Mesh)
+{
+	Mesh->SetMobility(EComponentMobility::Movable);
+	Mesh->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+}
+
+AStaticMeshActor* FSTestWorld::SpawnBox(const FVector& Location, const FVector& Size, FName CollisionProfile, bool bSimulatePhysics)
+{
+	AStaticMeshActor* Box = Spawn<AStaticMeshActor>(Location);
+	UStaticMeshComponent* Mesh = Box->GetStaticMeshComponent();
+
+	SetCubeMesh(Mesh);
+	Mesh->SetCollisionProfileName(CollisionProfile);
+	Mesh->SetGenerateOverlapEvents(true);
+	Box->SetActorScale3D(Size / 100.0f);
+	Mesh->SetSimulatePhysics(bSimulatePhysics);
+	return Box;
+}
+
+AStaticMeshActor* FSTestWorld::SpawnFloor()
+{
+	return SpawnBox(FVector(0.0f, 0.0f, -50.0f), FVector(10000.0f, 10000.0f, 100.0f));
+}
+
+AStaticMeshActor* FSTestWorld::SpawnFloatingBox(const FVector& Location, const FVector& Size)
+{
+	AStaticMeshActor* Box = SpawnBox(Location, Size, TEXT("PhysicsActor"), true);
+	Box->GetStaticMeshComponent()->SetEnableGravity(false);
+	return Box;
+}
+
+USAttributeComponent* FSTestWorld::AddAttributes(AActor* Actor)
+{
+	USAttributeComponent* Attributes = NewObject<USAttributeComponent>(Actor);
+	Attributes->RegisterComponent();
+	return Attributes;
+}
+
+static float GetBudgetScale()
+{
+	static const float BudgetScale = []()
+	{
+		float Scale = 1.0f;
+		FParse::Value(FCommandLine::Get(), TEXT("TestBudgetScale="), Scale);
+		return FMath::Max(Scale, 1.0f);
+	}();
+	return BudgetScale;
+}
+
+FSPerfBudget::FSPerfBudget(FAutomationTestBase& InTest, const TCHAR* InName, double InMaxMilliseconds, int32 InMaxNewObjects)
+	: Test(InTest)
+	, Name(InName)
+	, MaxMilliseconds(InMaxMilliseconds * GetBudgetScale())
+	, MaxNewObjects(InMaxNewObjects)
+	, StartTime(FPlatformTime::Seconds())
+	, StartObjects(GUObjectArray.GetObjectArrayNumMinusAvailable())
+{
+}
+
+FSPerfBudget::~FSPerfBudget()
+{
+	const double Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	const int32 NewObjects = GUObjectArray.GetObjectArrayNumMinusAvailable() - StartObjects;
+
+	Test.AddInfo(FString::Printf(TEXT("%s: %.3f ms (budget %.3f), %d new objects (budget %d)"), Name, Milliseconds, MaxMilliseconds, NewObjects, MaxNewObjects));
+	if (Milliseconds > MaxMilliseconds)
+	{
+		static const bool bStrict = FParse::Param(FCommandLine::Get(), TEXT("TestPerfBudgets"));
+		const FString Message = FString::Printf(TEXT("%s took %.3f ms, over its %.3f ms budget"), Name, Milliseconds, MaxMilliseconds);
+		if (bStrict)
+		{
+			Test.AddError(Message);
+		}
+		else
+		{
+			Test.AddWarning(Message);
+		}
+	}
+	Test.TestTrue(FString::Printf(TEXT("%s within %d new objects"), Name, MaxNewObjects), NewObjects <= MaxNewObjects);
+}
+
+FSScopedConsoleVariable::FSScopedConsoleVariable(const TCHAR* Name, int32 Value)
+	: Variable(IConsoleManager::Get().FindConsoleVariable(Name))
+{
+	if (Variable)
+	{
+		OldValue = Variable->GetInt();
+		Variable->Set(Value, ECVF_SetByCode);
+	}
+}
+
+FSScopedConsoleVariable::~FSScopedConsoleVariable()
+{
+	if (Variable)
+	{
+		Variable->Set(OldValue, ECVF_SetByCode);
+	}
+}
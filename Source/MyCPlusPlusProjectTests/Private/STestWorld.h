@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+
+class AStaticMeshActor;
+class UStaticMeshComponent;
+class USAttributeComponent;
+
+// Every project test runs in game and editor, headless included
+#define S_TEST_FLAGS (EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/*
+ * Empty game world for a test: created without a map, begun play, ticked by hand and destroyed with the helper.
+ * Tests spawn what they need, engine cubes stand in for floors, walls and props.
+ */
+class FSTestWorld
+{
+public:
+	FSTestWorld();
+	~FSTestWorld();
+
+	UWorld* Get() const { return World; }
+
+	// Advances the world by Seconds in fixed steps, rounded to a whole number of them (at least one)
+	void Tick(float Seconds, float DeltaTime = 1.0f / 30.0f);
+
+	template <typename ActorType>
+	ActorType* Spawn(const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		return World->SpawnActor<ActorType>(Location, Rotation, SpawnParams);
+	}
+
+	// Engine cube scaled to Size (in units), generating overlaps like the physics props of a level
+	AStaticMeshActor* SpawnBox(const FVector& Location, const FVector& Size, FName CollisionProfile = TEXT("BlockAll"), bool bSimulatePhysics = false);
+
+	// Floor under the origin, its top at Z = 0
+	AStaticMeshActor* SpawnFloor();
+
+	// Simulating box without gravity, stays where it is until something pushes or pulls it
+	AStaticMeshActor* SpawnFloatingBox(const FVector& Location, const FVector& Size);
+
+	// Health for an actor that has none, so damage to it can be checked
+	static USAttributeComponent* AddAttributes(AActor* Actor);
+
+	// Gives a native component (no Blueprint mesh) the engine cube
+	static void SetCubeMesh(UStaticMeshComponent* Mesh);
+
+private:
+	UWorld* World = nullptr;
+};
+
+/*
+ * Time and allocation budget of a test step, checked when it goes out of scope. Allocations are counted in UObjects:
+ * they are what gameplay code creates per action, and unlike heap bytes other threads don't add to them. Time is only
+ * an error with -TestPerfBudgets, otherwise a warning.
+ */
+class FSPerfBudget
+{
+public:
+	FSPerfBudget(FAutomationTestBase& InTest, const TCHAR* InName, double InMaxMilliseconds, int32 InMaxNewObjects);
+	~FSPerfBudget();
+
+private:
+	FAutomationTestBase& Test;
+	const TCHAR* Name;
+	double MaxMilliseconds;
+	int32 MaxNewObjects;
+	double StartTime;
+	int32 StartObjects;
+};
+
+// Sets an integer console variable for the scope of a test
+class FSScopedConsoleVariable
+{
+public:
+	FSScopedConsoleVariable(const TCHAR* Name, int32 Value);
+	~FSScopedConsoleVariable();
+
+private:
+	IConsoleVariable* Variable;
+	int32 OldValue = 0;
+};